@@ -87,6 +87,20 @@ namespace golos { namespace chain {
                 return end_pos + sizeof(uint64_t);
             }
 
+            // returns the end position of the packed block, which starts at pos
+            uint64_t get_block_end_pos(uint32_t block_num, uint64_t pos) const {
+                uint64_t end_pos;
+                if (block_num < protocol::block_header::num_from_id(head_id)) {
+                    end_pos = get_block_pos(block_num + 1);
+                } else {
+                    end_pos = get_mapped_size(block_mapped_file);
+                }
+                FC_ASSERT(end_pos >= pos + sizeof(uint64_t));
+                end_pos -= sizeof(uint64_t);
+                FC_ASSERT(get_uint64(block_mapped_file, end_pos) == pos);
+                return end_pos;
+            }
+
             signed_block read_head() const {
                 auto pos = get_last_uint64(block_mapped_file);
                 signed_block block;
@@ -284,6 +298,24 @@ namespace golos { namespace chain {
         return result;
     } FC_LOG_AND_RETHROW() }
 
+    std::vector<std::vector<char>> block_log::read_serialized_blocks(
+        uint32_t first_block_num, uint32_t count
+    ) const { try {
+        detail::read_lock lock(my->mutex);
+        std::vector<std::vector<char>> result;
+        result.reserve(count);
+        for (uint32_t block_num = first_block_num; block_num - first_block_num < count; ++block_num) {
+            uint64_t pos = my->get_block_pos(block_num);
+            if (pos == npos) {
+                break;
+            }
+            uint64_t end_pos = my->get_block_end_pos(block_num, pos);
+            const auto* ptr = my->block_mapped_file.data() + pos;
+            result.emplace_back(ptr, ptr + (end_pos - pos));
+        }
+        return result;
+    } FC_LOG_AND_RETHROW() }
+
     uint64_t block_log::get_block_pos(uint32_t block_num) const {
         detail::read_lock lock(my->mutex);
         return my->get_block_pos(block_num);
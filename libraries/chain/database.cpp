@@ -73,6 +73,11 @@ namespace golos { namespace chain {
             return v;
         }
 
+        inline size_t max_block_header_size() {
+            static const size_t size = fc::raw::pack_size(signed_block_header()) + 4;
+            return size;
+        }
+
         class signal_guard {
             struct sigaction old_hup_action, old_int_action, old_term_action;
 
@@ -178,7 +183,8 @@ namespace golos { namespace chain {
         }
 
         database::database()
-                : _my(new database_impl(*this)) {
+                : _my(new database_impl(*this)),
+                  _supply_invariants(*this) {
         }
 
         database::~database() {
@@ -192,8 +198,11 @@ namespace golos { namespace chain {
 
                 init_schema();
                 chainbase::database::open(shared_mem_dir, chainbase_flags, shared_file_size);
+                _shared_mem_dir = shared_mem_dir;
+                apply_shared_memory_mapping(true);
 
                 initialize_indexes();
+                check_state_layout(chainbase_flags);
                 initialize_evaluators();
 
                 auto end = fc::time_point::now();
@@ -296,6 +305,10 @@ namespace golos { namespace chain {
                                 << "   ("  << (free_memory() / (1024 * 1024)) << "M free"
                                 << ", elapsed " << double((end - start).count()) / 1000000.0 << " sec)\n";
 
+                            if (reindex_percent / 10 != last_reindex_percent / 10) {
+                                print_index_statistics();
+                            }
+
                             last_reindex_percent = reindex_percent;
                         }
 
@@ -327,6 +340,7 @@ namespace golos { namespace chain {
                 auto end = fc::time_point::now();
                 ilog("Done reindexing, elapsed time: ${t} sec", ("t",
                         double((end - start).count()) / 1000000.0));
+                print_index_statistics();
             }
             FC_CAPTURE_AND_RETHROW((data_dir)(shared_mem_dir))
 
@@ -344,6 +358,19 @@ namespace golos { namespace chain {
             _block_num_check_free_memory = value;
         }
 
+        void database::set_shared_memory_mapping(const shared_memory_mapping_options &options) {
+            _shared_memory_mapping = options;
+        }
+
+        void database::apply_shared_memory_mapping(bool startup) {
+            auto options = _shared_memory_mapping;
+            // the warm-up is for restarts, the whole file shouldn't be read again on each resize
+            options.warm_up &= startup;
+            // the segment manager is placed at the beginning of the mapped file
+            golos::chain::apply_shared_memory_mapping(
+                get_segment_manager(), max_memory(), _shared_mem_dir.string(), options);
+        }
+
         void database::set_clear_votes(uint32_t clear_votes_block) {
             _clear_votes_block = clear_votes_block;
         }
@@ -369,6 +396,7 @@ namespace golos { namespace chain {
                 "Memory is almost full on block ${block}, increasing to ${mem}M",
                 ("block", current_block_num)("mem", new_max / (1024 * 1024)));
             resize(new_max);
+            apply_shared_memory_mapping(false);
 
             uint64_t free_mem = free_memory();
             uint64_t reserved_mem = reserved_memory();
@@ -381,6 +409,7 @@ namespace golos { namespace chain {
             uint32_t reserved_mb = uint32_t(reserved_mem / (1024 * 1024));
             wlog("Free memory is now ${free}M (${reserved}M)", ("free", free_mb)("reserved", reserved_mb));
             _last_free_gb_printed = free_mb / 1024;
+            print_index_statistics();
             return true;
         }
 
@@ -420,6 +449,37 @@ namespace golos { namespace chain {
             }
         }
 
+        void database::add_index_statistics_getter(index_statistics_getter getter) {
+            _index_statistics_getters.push_back(std::move(getter));
+        }
+
+        std::vector<index_statistics> database::get_index_statistics() const {
+            std::vector<index_statistics> result;
+            result.reserve(_index_statistics_getters.size());
+            for (const auto &getter : _index_statistics_getters) {
+                result.push_back(getter());
+            }
+
+            std::sort(result.begin(), result.end(), [](const index_statistics &a, const index_statistics &b) {
+                return a.total_size > b.total_size;
+            });
+            return result;
+        }
+
+        void database::print_index_statistics(std::size_t limit) const {
+            auto statistics = get_index_statistics();
+            if (statistics.size() > limit) {
+                statistics.resize(limit);
+            }
+
+            ilog("Largest indexes of the shared memory:");
+            for (const auto &s : statistics) {
+                ilog("   ${name}: ${count} objects, ${size}M (${dynamic}M of strings and buffers)",
+                     ("name", s.name)("count", s.object_count)
+                     ("size", s.total_size / (1024 * 1024))("dynamic", s.dynamic_size / (1024 * 1024)));
+            }
+        }
+
         void database::wipe(const fc::path &data_dir, const fc::path &shared_mem_dir, bool include_blocks) {
             close();
             chainbase::database::wipe(shared_mem_dir);
@@ -994,6 +1054,8 @@ namespace golos { namespace chain {
             // This allows us to quickly rewind to the clean state of the head block, in case a new block arrives.
             if (!_pending_tx_session.valid()) {
                 _pending_tx_session = start_undo_session();
+                _pending_block_tx_count = 0;
+                _pending_block_size = max_block_header_size();
             }
 
             // Create a temporary undo session as a child of _pending_tx_session.
@@ -1005,6 +1067,16 @@ namespace golos { namespace chain {
             _apply_transaction(trx, skip);
             _pending_tx.push_back(trx);
 
+            // Extend the candidate of the next block while transactions fit into it,
+            // the rest are postponed in order of arrival
+            if (_pending_block_tx_count + 1 == _pending_tx.size()) {
+                auto new_block_size = _pending_block_size + fc::raw::pack_size(trx);
+                if (new_block_size < get_dynamic_global_properties().maximum_block_size) {
+                    _pending_block_size = new_block_size;
+                    ++_pending_block_tx_count;
+                }
+            }
+
             notify_changed_objects();
             // The transaction applied successfully. Merge its changes into the pending block session.
             temp_session.squash();
@@ -1045,14 +1117,31 @@ namespace golos { namespace chain {
                 FC_ASSERT(witness_obj.signing_key ==
                           block_signing_private_key.get_public_key());
 
-            static const size_t max_block_header_size =
-                    fc::raw::pack_size(signed_block_header()) + 4;
             auto maximum_block_size = get_dynamic_global_properties().maximum_block_size; //STEEMIT_MAX_BLOCK_SIZE;
-            size_t total_block_size = max_block_header_size;
+            size_t total_block_size = max_block_header_size();
 
             signed_block pending_block;
 
             with_strong_write_lock([&]() {
+                // Pending transactions are applied on the state of the head block in order of arrival, the same
+                // as in the block, because time-based semantics are evaluated on the time of the head block.
+                // So, if none of the candidate transactions expires before "when", the candidate is used as is.
+                bool is_candidate_valid = _pending_tx_session.valid();
+                for (size_t i = 0; is_candidate_valid && i < _pending_block_tx_count; ++i) {
+                    is_candidate_valid = !(_pending_tx[i].expiration < when);
+                }
+
+                if (is_candidate_valid) {
+                    pending_block.transactions.assign(
+                        _pending_tx.begin(), _pending_tx.begin() + _pending_block_tx_count);
+
+                    auto postponed_tx_count = _pending_tx.size() - _pending_block_tx_count;
+                    if (postponed_tx_count > 0) {
+                        wlog("Postponed ${n} transactions due to block size limit", ("n", postponed_tx_count));
+                    }
+                    return;
+                }
+
                 //
                 // The following code throws away existing pending_tx_session and
                 // rebuilds it by re-applying pending transactions.
@@ -1228,6 +1317,10 @@ namespace golos { namespace chain {
             notify_post_apply_operation(note);
         }
 
+        void database::notify_pre_apply_block(const signed_block &block) {
+            STEEMIT_TRY_NOTIFY(pre_apply_block, block)
+        }
+
         void database::notify_applied_block(const signed_block &block) {
             STEEMIT_TRY_NOTIFY(applied_block, block)
         }
@@ -1386,6 +1479,16 @@ namespace golos { namespace chain {
             vector<account_name_type> active_witnesses;
             active_witnesses.reserve(STEEMIT_MAX_WITNESSES);
 
+            const bool skip_null_signing_keys = has_hardfork(STEEMIT_HARDFORK_0_14__278);
+
+            // Indices by votes and by virtual time are kept sorted on each change of votes,
+            // so only the head of them is walked, and only witnesses which change their kind of schedule are modified
+            auto set_schedule = [&](const witness_object &wo, witness_object::witness_schedule_type schedule) {
+                if (wo.schedule != schedule) {
+                    modify(wo, [&](witness_object &w) { w.schedule = schedule; });
+                }
+            };
+
             /// Add the highest voted witnesses
             flat_set<witness_id_type> selected_voted;
             selected_voted.reserve(STEEMIT_MAX_VOTED_WITNESSES);
@@ -1395,13 +1498,12 @@ namespace golos { namespace chain {
                  itr != widx.end() &&
                  selected_voted.size() < STEEMIT_MAX_VOTED_WITNESSES;
                  ++itr) {
-                if (has_hardfork(STEEMIT_HARDFORK_0_14__278) &&
-                    (itr->signing_key == public_key_type())) {
+                if (skip_null_signing_keys && (itr->signing_key == public_key_type())) {
                     continue;
                 }
                 selected_voted.insert(itr->id);
                 active_witnesses.push_back(itr->owner);
-                modify(*itr, [&](witness_object &wo) { wo.schedule = witness_object::top19; });
+                set_schedule(*itr, witness_object::top19);
             }
 
             auto num_elected = active_witnesses.size();
@@ -1417,12 +1519,10 @@ namespace golos { namespace chain {
                 // Only consider a miner who is not a top voted witness
                 if (selected_voted.find(mitr->id) == selected_voted.end()) {
                     // Only consider a miner who has a valid block signing key
-                    if (!(has_hardfork(STEEMIT_HARDFORK_0_14__278) &&
-                          get_witness(mitr->owner).signing_key ==
-                          public_key_type())) {
+                    if (!(skip_null_signing_keys && mitr->signing_key == public_key_type())) {
                         selected_miners.insert(mitr->id);
                         active_witnesses.push_back(mitr->owner);
-                        modify(*mitr, [&](witness_object &wo) { wo.schedule = witness_object::miner; });
+                        set_schedule(*mitr, witness_object::miner);
                     }
                 }
                 // Remove processed miner from the queue
@@ -1452,15 +1552,14 @@ namespace golos { namespace chain {
                 new_virtual_time = sitr->virtual_scheduled_time; /// everyone advances to at least this time
                 processed_witnesses.push_back(sitr);
 
-                if (has_hardfork(STEEMIT_HARDFORK_0_14__278) &&
-                    sitr->signing_key == public_key_type()) {
+                if (skip_null_signing_keys && sitr->signing_key == public_key_type()) {
                     continue;
                 } /// skip witnesses without a valid block signing key
 
                 if (selected_miners.find(sitr->id) == selected_miners.end()
                     && selected_voted.find(sitr->id) == selected_voted.end()) {
                     active_witnesses.push_back(sitr->owner);
-                    modify(*sitr, [&](witness_object &wo) { wo.schedule = witness_object::timeshare; });
+                    set_schedule(*sitr, witness_object::timeshare);
                     ++witness_count;
                 }
             }
@@ -1504,7 +1603,7 @@ namespace golos { namespace chain {
                 flat_map<std::tuple<hardfork_version, time_point_sec>, uint32_t> hardfork_version_votes;
 
                 for (uint32_t i = 0; i < wso.num_scheduled_witnesses; i++) {
-                    auto witness = get_witness(wso.current_shuffled_witnesses[i]);
+                    const auto &witness = get_witness(wso.current_shuffled_witnesses[i]);
                     if (witness_versions.find(witness.running_version) ==
                         witness_versions.end()) {
                         witness_versions[witness.running_version] = 1;
@@ -1872,6 +1971,10 @@ namespace golos { namespace chain {
 
         void database::adjust_witness_vote(const witness_object &witness, share_type delta) {
             const witness_schedule_object &wso = get_witness_schedule_object();
+            const auto &total_vesting_shares = get_dynamic_global_properties().total_vesting_shares;
+            const bool has_hardfork_0_2 = has_hardfork(STEEMIT_HARDFORK_0_2);
+            const bool has_hardfork_0_4 = has_hardfork(STEEMIT_HARDFORK_0_4);
+
             modify(witness, [&](witness_object &w) {
                 auto delta_pos = w.votes.value * (wso.current_virtual_time -
                                                   w.virtual_last_update);
@@ -1879,10 +1982,10 @@ namespace golos { namespace chain {
 
                 w.virtual_last_update = wso.current_virtual_time;
                 w.votes += delta;
-                FC_ASSERT(w.votes <=
-                          get_dynamic_global_properties().total_vesting_shares.amount, "", ("w.votes", w.votes)("props", get_dynamic_global_properties().total_vesting_shares));
+                FC_ASSERT(w.votes <= total_vesting_shares.amount, "",
+                          ("w.votes", w.votes)("props", total_vesting_shares));
 
-                if (has_hardfork(STEEMIT_HARDFORK_0_2)) {
+                if (has_hardfork_0_2) {
                     w.virtual_scheduled_time = w.virtual_last_update +
                                                (VIRTUAL_SCHEDULE_LAP_LENGTH2 -
                                                 w.virtual_position) /
@@ -1895,7 +1998,7 @@ namespace golos { namespace chain {
                 }
 
                 /** witnesses with a low number of votes could overflow the time field and end up with a scheduled time in the past */
-                if (has_hardfork(STEEMIT_HARDFORK_0_4)) {
+                if (has_hardfork_0_4) {
                     if (w.virtual_scheduled_time < wso.current_virtual_time) {
                         w.virtual_scheduled_time = fc::uint128_t::max_value();
                     }
@@ -2917,6 +3020,8 @@ namespace golos { namespace chain {
         }
 
         void database::initialize_indexes() {
+            _index_statistics_getters.clear();
+
             add_core_index<dynamic_global_property_index>(*this);
             add_core_index<account_index>(*this);
             add_core_index<account_authority_index>(*this);
@@ -3014,6 +3119,24 @@ namespace golos { namespace chain {
    return;*/
         }
 
+        void database::check_state_layout(uint32_t chainbase_flags) {
+            // The version is kept in the file as a named object of the segment, beside the indexes
+            constexpr const char *name = "golos_state_layout_version";
+            auto version = get_segment_manager()->find<uint32_t>(name).first;
+
+            if (!version && !find<dynamic_global_property_object>()) {
+                // a new file
+                if (chainbase_flags & chainbase::database::read_write) {
+                    get_segment_manager()->construct<uint32_t>(name)(state_layout_version);
+                }
+                return;
+            }
+
+            FC_ASSERT(version && *version == state_layout_version,
+                      "Shared memory file is written with another layout of objects, please replay blockchain",
+                      ("version", version ? *version : 0)("expected", state_layout_version));
+        }
+
         void database::init_genesis(uint64_t init_supply) {
             try {
                 // Create blockchain accounts
@@ -3171,6 +3294,18 @@ namespace golos { namespace chain {
         }
 
         uint32_t database::validate_transaction(const signed_transaction &trx, uint32_t skip) {
+            return _validate_transaction_impl(trx, nullptr, skip);
+        }
+
+        uint32_t database::validate_transaction(
+            const signed_transaction &trx, const flat_set<public_key_type> &signature_keys, uint32_t skip
+        ) {
+            return _validate_transaction_impl(trx, &signature_keys, skip);
+        }
+
+        uint32_t database::_validate_transaction_impl(
+            const signed_transaction &trx, const flat_set<public_key_type> *signature_keys, uint32_t skip
+        ) {
             const uint32_t validate_transaction_steps =
                 skip_authority_check |
                 skip_transaction_signatures |
@@ -3183,7 +3318,7 @@ namespace golos { namespace chain {
                 //  because such transactions only added to pending list,
                 //  and they will be rechecked on block generation
                 auto validate_action = [&]() {
-                    _validate_transaction(trx, skip);
+                    _validate_transaction(trx, skip, signature_keys);
                 };
 
                 if (!(skip & skip_database_locking)) {
@@ -3212,7 +3347,9 @@ namespace golos { namespace chain {
             return skip;
         }
 
-        void database::_validate_transaction(const signed_transaction &trx, uint32_t skip) {
+        void database::_validate_transaction(
+            const signed_transaction &trx, uint32_t skip, const flat_set<public_key_type> *signature_keys
+        ) {
             if (!(skip & skip_validate_operations)) {   /* issue #505 explains why this skip_flag is disabled */
                 trx.validate();
             }
@@ -3233,7 +3370,13 @@ namespace golos { namespace chain {
                 };
 
                 try {
-                    trx.verify_authority(chain_id, get_active, get_owner, get_posting, STEEMIT_MAX_SIG_CHECK_DEPTH);
+                    if (signature_keys) {
+                        protocol::verify_authority(
+                            trx.operations, *signature_keys, get_active, get_owner, get_posting,
+                            STEEMIT_MAX_SIG_CHECK_DEPTH);
+                    } else {
+                        trx.verify_authority(chain_id, get_active, get_owner, get_posting, STEEMIT_MAX_SIG_CHECK_DEPTH);
+                    }
                 }
                 catch (protocol::tx_missing_active_auth &e) {
                     if (get_shared_db_merkle().find(head_block_num() + 1) == get_shared_db_merkle().end()) {
@@ -3389,6 +3532,24 @@ namespace golos { namespace chain {
                 _current_trx_in_block = 0;
                 _current_virtual_op = 0;
 
+                notify_pre_apply_block(next_block);
+
+                bool check_invariants = _validate_invariants && !(skip & skip_validate_invariants);
+                _supply_invariants.reset();
+                _track_invariants = check_invariants;
+                // Changes of pending transactions and of the next block shouldn't be tracked if this one fails
+                struct track_invariants_restorer final {
+                    bool &track_invariants;
+
+                    ~track_invariants_restorer() {
+                        track_invariants = false;
+                    }
+                } track_restorer{_track_invariants};
+                if (!check_invariants) {
+                    // The state isn't checked, so the next check should be the full scan
+                    _has_validated_invariants = false;
+                }
+
                 /// modify current witness so transaction evaluators can know who included the transaction,
                 /// this is mostly for POW operations which must pay the current_witness
                 modify(gprops, [&](dynamic_global_property_object &dgp) {
@@ -3454,6 +3615,11 @@ namespace golos { namespace chain {
 
                 process_hardforks();
 
+                _track_invariants = false;
+                if (check_invariants) {
+                    validate_block_invariants(next_block_num);
+                }
+
                 // notify observers that the block has been applied
                 notify_applied_block(next_block);
 
@@ -4396,6 +4562,9 @@ namespace golos { namespace chain {
                 elog("HARDFORK ${hf} at block ${b}", ("hf", hardfork)("b", head_block_num()));
             }
 
+            // Hardforks can change rules of calculation of the totals
+            _supply_invariants.invalidate();
+
             switch (hardfork) {
                 case STEEMIT_HARDFORK_0_1:
                     perform_vesting_share_split(10000);
@@ -4588,6 +4757,39 @@ namespace golos { namespace chain {
             }
         }
 
+        void database::set_validate_invariants(bool value, uint32_t audit_blocks) {
+            _validate_invariants = value;
+            _invariants_audit_blocks = audit_blocks;
+            _has_validated_invariants = false;
+        }
+
+        void database::validate_block_invariants(uint32_t block_num) {
+            // The incremental check relies on invariants of the previous state,
+            // so they are checked by the full scan at least once
+            if (!_has_validated_invariants || !_supply_invariants.is_valid() ||
+                (_invariants_audit_blocks != 0 && block_num % _invariants_audit_blocks == 0)
+            ) {
+                validate_invariants();
+                _has_validated_invariants = true;
+                return;
+            }
+
+            try {
+                _supply_invariants.validate();
+
+                const auto &gpo = get_dynamic_global_properties();
+                FC_ASSERT(gpo.virtual_supply >= gpo.current_supply);
+                if (!get_feed_history().current_median_history.is_null()) {
+                    FC_ASSERT(gpo.current_sbd_supply * get_feed_history().current_median_history + gpo.current_supply ==
+                              gpo.virtual_supply, "",
+                              ("gpo.current_sbd_supply", gpo.current_sbd_supply)
+                              ("get_feed_history().current_median_history", get_feed_history().current_median_history)
+                              ("gpo.current_supply", gpo.current_supply)("gpo.virtual_supply", gpo.virtual_supply));
+                }
+            }
+            FC_CAPTURE_LOG_AND_RETHROW((block_num));
+        }
+
 /**
  * Verifies all supply invariantes check out
  */
@@ -63,6 +63,8 @@ namespace golos { namespace chain {
                     "Failed to apply proposed transaction on its expiration. "
                     "Deleting it.\n${author}::${title}\n${error}",
                     ("author", proposal.author)("title", proposal.title)("error", e.to_detail_string()));
+                // changes of the proposal are undone, but they are already tracked
+                _supply_invariants.invalidate();
             }
             remove(proposal);
         }
@@ -11,6 +11,7 @@
 
 #include <boost/multi_index/composite_key.hpp>
 
+#include <cstddef>
 #include <numeric>
 
 namespace golos { namespace chain {
@@ -27,33 +28,18 @@ public:
         c(*this);
     };
 
+    /**
+     *  Fields are ordered by the access frequency: the first ones are read or changed by transfers, votes,
+     *  vesting withdrawals and rewards, the rest are changed only by account updates, recovery and savings.
+     *  So the hot paths touch the first cache lines of the object, and small fields are grouped to avoid padding.
+     *  The order of fields in FC_REFLECT is kept, so the serialized form doesn't depend on this layout.
+     */
     id_type id;
 
     account_name_type name;
-    public_key_type memo_key;
     account_name_type proxy;
 
-    time_point_sec last_account_update;
-
-    time_point_sec created;
-    bool mined = true;
-    bool owner_challenged = false;
-    bool active_challenged = false;
-    time_point_sec last_owner_proved = time_point_sec::min();
-    time_point_sec last_active_proved = time_point_sec::min();
-    account_name_type recovery_account;
-    account_name_type reset_account = STEEMIT_NULL_ACCOUNT;
-    time_point_sec last_account_recovery;
-    uint32_t comment_count = 0;
-    uint32_t lifetime_vote_count = 0;
-    uint32_t post_count = 0;
-
-    bool can_vote = true;
-    uint16_t voting_power = STEEMIT_100_PERCENT;   ///< current voting power of this account, it falls after every vote
-    time_point_sec last_vote_time; ///< used to increase the voting power of this account the longer it goes without voting.
-
     asset balance = asset(0, STEEM_SYMBOL);  ///< total liquid shares held by this account
-    asset savings_balance = asset(0, STEEM_SYMBOL);  ///< total liquid shares held by this account
 
     /**
      *  SBD Deposits pay interest based upon the interest rate set by witnesses. The purpose of these
@@ -71,36 +57,60 @@ public:
     ///@{
     asset sbd_balance = asset(0, SBD_SYMBOL); /// total sbd balance
     uint128_t sbd_seconds; ///< total sbd * how long it has been hel
-    time_point_sec sbd_seconds_last_update; ///< the last time the sbd_seconds was updated
-    time_point_sec sbd_last_interest_payment; ///< used to pay interest at most once per month
-
-
-    asset savings_sbd_balance = asset(0, SBD_SYMBOL); /// total sbd balance
-    uint128_t savings_sbd_seconds; ///< total sbd * how long it has been hel
-    time_point_sec savings_sbd_seconds_last_update; ///< the last time the sbd_seconds was updated
-    time_point_sec savings_sbd_last_interest_payment; ///< used to pay interest at most once per month
-
-    uint8_t savings_withdraw_requests = 0;
     ///@}
 
-    share_type curation_rewards = 0;
-    share_type posting_rewards = 0;
-
     asset vesting_shares = asset(0, VESTS_SYMBOL); ///< total vesting shares held by this account, controls its voting power
     asset delegated_vesting_shares = asset(0, VESTS_SYMBOL); ///<
     asset received_vesting_shares = asset(0, VESTS_SYMBOL); ///<
 
+    fc::array<share_type, STEEMIT_MAX_PROXY_RECURSION_DEPTH> proxied_vsf_votes;// = std::vector<share_type>( STEEMIT_MAX_PROXY_RECURSION_DEPTH, 0 ); ///< the total VFS votes proxied to this account
+
     asset vesting_withdraw_rate = asset(0, VESTS_SYMBOL); ///< at the time this is updated it can be at most vesting_shares/104
-    time_point_sec next_vesting_withdrawal = fc::time_point_sec::maximum(); ///< after every withdrawal this is incremented by 1 week
     share_type withdrawn = 0; /// Track how many shares have been withdrawn
     share_type to_withdraw = 0; /// Might be able to look this up with operation history.
+
+    share_type curation_rewards = 0;
+    share_type posting_rewards = 0;
+
+    time_point_sec last_vote_time; ///< used to increase the voting power of this account the longer it goes without voting.
+    time_point_sec sbd_seconds_last_update; ///< the last time the sbd_seconds was updated
+    time_point_sec sbd_last_interest_payment; ///< used to pay interest at most once per month
+    time_point_sec next_vesting_withdrawal = fc::time_point_sec::maximum(); ///< after every withdrawal this is incremented by 1 week
+    time_point_sec last_post;
+
+    uint32_t lifetime_vote_count = 0;
+    uint32_t comment_count = 0;
+    uint32_t post_count = 0;
+
+    uint16_t voting_power = STEEMIT_100_PERCENT;   ///< current voting power of this account, it falls after every vote
     uint16_t withdraw_routes = 0;
 
-    fc::array<share_type, STEEMIT_MAX_PROXY_RECURSION_DEPTH> proxied_vsf_votes;// = std::vector<share_type>( STEEMIT_MAX_PROXY_RECURSION_DEPTH, 0 ); ///< the total VFS votes proxied to this account
+    bool can_vote = true;
+    bool owner_challenged = false;
+    bool active_challenged = false;
+
+    uint8_t savings_withdraw_requests = 0;
 
+    // Rarely changed fields
+
+    public_key_type memo_key;
+    bool mined = true;
     uint16_t witnesses_voted_for = 0;
 
-    time_point_sec last_post;
+    time_point_sec last_account_update;
+    time_point_sec created;
+    time_point_sec last_owner_proved = time_point_sec::min();
+    time_point_sec last_active_proved = time_point_sec::min();
+    time_point_sec last_account_recovery;
+    time_point_sec savings_sbd_seconds_last_update; ///< the last time the sbd_seconds was updated
+    time_point_sec savings_sbd_last_interest_payment; ///< used to pay interest at most once per month
+
+    account_name_type recovery_account;
+    account_name_type reset_account = STEEMIT_NULL_ACCOUNT;
+
+    asset savings_balance = asset(0, STEEM_SYMBOL);  ///< total liquid shares held by this account
+    asset savings_sbd_balance = asset(0, SBD_SYMBOL); /// total sbd balance
+    uint128_t savings_sbd_seconds; ///< total sbd * how long it has been hel
 
     /// This function should be used only when the account votes for a witness directly
     share_type witness_vote_weight() const {
@@ -127,6 +137,14 @@ public:
     }
 };
 
+// The layout of fields above is checked for 64-bit builds: hot fields end at the 4th cache line, no padding is left
+static_assert(offsetof(account_object, savings_withdraw_requests) + sizeof(uint8_t) <= 256,
+    "Fields of account_object changed on hot paths don't fit into four cache lines");
+static_assert(sizeof(void *) != 8 || offsetof(account_object, memo_key) == 256,
+    "Hot fields of account_object are padded");
+static_assert(sizeof(void *) != 8 || sizeof(account_object) == 400,
+    "Size of account_object is changed, increase state_layout_version if the layout of fields is changed");
+
 class account_authority_object
         : public object<account_authority_object_type, account_authority_object> {
 public:
@@ -183,6 +201,10 @@ public:
     shared_string json_metadata;
 };
 
+inline std::size_t dynamic_memory_usage(const account_metadata_object &o) {
+    return dynamic_memory_usage(o.json_metadata);
+}
+
 class vesting_delegation_object: public object<vesting_delegation_object_type, vesting_delegation_object> {
 public:
     template<typename Constructor, typename Allocator>
@@ -55,6 +55,12 @@ namespace golos {
 
             optional <signed_block> read_block_by_num(uint32_t block_num) const;
 
+            /**
+             * Return packed blocks starting from first_block_num as they are stored in the file, without unpacking.
+             * Reading stops after count blocks or at the head block.
+             */
+            std::vector<std::vector<char>> read_serialized_blocks(uint32_t first_block_num, uint32_t count) const;
+
             /**
              * Return offset of block in file, or block_log::npos if it does not exist.
              */
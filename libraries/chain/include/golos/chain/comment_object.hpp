@@ -60,6 +60,10 @@ namespace golos {
             shared_string json_metadata;
         };
 
+        inline std::size_t dynamic_memory_usage(const comment_content_object &o) {
+            return dynamic_memory_usage(o.title) + dynamic_memory_usage(o.body) + dynamic_memory_usage(o.json_metadata);
+        }
+
         class comment_object
                 : public object<comment_object_type, comment_object> {
         public:
@@ -128,6 +132,11 @@ namespace golos {
             bip::vector <protocol::beneficiary_route_type, allocator<protocol::beneficiary_route_type>> beneficiaries;
         };
 
+        inline std::size_t dynamic_memory_usage(const comment_object &o) {
+            return dynamic_memory_usage(o.parent_permlink) + dynamic_memory_usage(o.permlink) +
+                   dynamic_memory_usage(o.beneficiaries);
+        }
+
 
         /**
          * This index maintains the set of voter/comment pairs that have been used, voters cannot
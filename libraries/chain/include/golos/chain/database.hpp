@@ -5,12 +5,16 @@
 #include <golos/chain/fork_database.hpp>
 #include <golos/chain/block_log.hpp>
 #include <golos/chain/hardfork.hpp>
+#include <golos/chain/supply_invariants.hpp>
+#include <golos/chain/index_statistics.hpp>
+#include <golos/chain/shared_memory_mapping.hpp>
 #include <golos/protocol/protocol.hpp>
 
 #include <fc/signals.hpp>
 
 #include <fc/log/logger.hpp>
 
+#include <functional>
 #include <map>
 
 namespace golos { namespace chain {
@@ -22,6 +26,13 @@ namespace golos { namespace chain {
         using golos::protocol::asset_symbol_type;
         using golos::protocol::price;
 
+        /**
+         * Version of the memory layout of objects in the shared memory file.
+         * It should be increased on each change of fields of objects, including their order,
+         * so a file of another build is rejected and replayed instead of being read with a wrong layout.
+         */
+        constexpr uint32_t state_layout_version = 1;
+
         class database_impl;
 
         class custom_operation_interpreter;
@@ -38,7 +49,37 @@ namespace golos { namespace chain {
 
             ~database();
 
-            using chainbase::database::remove;
+            /**
+             * Objects are changed through these methods, so changes of the supply are tracked
+             * by them while a block is applied
+             */
+            template<typename ObjectType, typename Constructor>
+            const ObjectType &create(Constructor &&con) {
+                const auto &obj = chainbase::database::create<ObjectType>(std::forward<Constructor>(con));
+                if (_track_invariants) {
+                    _supply_invariants.track(obj, 1);
+                }
+                return obj;
+            }
+
+            template<typename ObjectType, typename Modifier>
+            void modify(const ObjectType &obj, Modifier &&m) {
+                if (_track_invariants) {
+                    _supply_invariants.track(obj, -1);
+                }
+                chainbase::database::modify(obj, std::forward<Modifier>(m));
+                if (_track_invariants) {
+                    _supply_invariants.track(obj, 1);
+                }
+            }
+
+            template<typename ObjectType>
+            void remove(const ObjectType &obj) {
+                if (_track_invariants) {
+                    _supply_invariants.track(obj, -1);
+                }
+                chainbase::database::remove(obj);
+            }
 
             bool is_producing() const {
                 return _is_producing;
@@ -96,6 +137,23 @@ namespace golos { namespace chain {
             void set_block_num_check_free_size(uint32_t);
             void check_free_memory(bool skip_print, uint32_t current_block_num);
 
+            // Should be set before open(), the options are applied again after each resize of the shared memory
+            void set_shared_memory_mapping(const shared_memory_mapping_options &options);
+
+            using index_statistics_getter = std::function<index_statistics()>;
+
+            // Called by add_core_index() and add_plugin_index() for each index
+            void add_index_statistics_getter(index_statistics_getter getter);
+
+            /**
+             * Returns approximate usage of the shared memory by each index, sorted by size.
+             * The cost is proportional to the number of indexes, not objects, so it can be called on each request.
+             */
+            std::vector<index_statistics> get_index_statistics() const;
+
+            // Logs the largest indexes
+            void print_index_statistics(std::size_t limit = 10) const;
+
             void set_clear_votes(uint32_t clear_votes_block);
             void set_skip_virtual_ops();
             bool clear_votes();
@@ -261,6 +319,8 @@ namespace golos { namespace chain {
             void notify_post_apply_operation(const operation_notification &note);
 
             inline const void push_virtual_operation(const operation &op, bool force = false); // vops are not needed for low mem. Force will push them on low mem.
+            void notify_pre_apply_block(const signed_block &block);
+
             void notify_applied_block(const signed_block &block);
 
             void notify_on_pending_transaction(const signed_transaction &tx);
@@ -273,6 +333,12 @@ namespace golos { namespace chain {
             fc::signal<void(operation_notification &)> pre_apply_operation;
             fc::signal<void(const operation_notification &)> post_apply_operation;
 
+            /**
+             *  This signal is emitted before operations of a block are applied. Operations notified
+             *  after it and before applied_block belong to this block, unless it fails to apply.
+             */
+            fc::signal<void(const signed_block &)> pre_apply_block;
+
             /**
              *  This signal is emitted after all operations and virtual operation for a
              *  block have been applied but before the get_applied_operations() are cleared.
@@ -464,6 +530,9 @@ namespace golos { namespace chain {
 
             void init_schema();
 
+            /// Throws if the shared memory file is written with another state_layout_version
+            void check_state_layout(uint32_t chainbase_flags);
+
             void init_genesis(uint64_t initial_supply = STEEMIT_INIT_SUPPLY);
 
             /**
@@ -473,6 +542,14 @@ namespace golos { namespace chain {
              */
             uint32_t validate_transaction(const signed_transaction &trx, uint32_t skip = skip_nothing);
 
+            /**
+             *  The same, but signatures of the transaction were already recovered by the caller
+             *  (e.g. in a thread pool before taking the database lock), so they aren't recovered again
+             */
+            uint32_t validate_transaction(
+                const signed_transaction &trx, const flat_set<public_key_type> &signature_keys,
+                uint32_t skip = skip_nothing);
+
             /** when popping a block, the transactions that were removed get cached here so they
              * can be reapplied at the proper time */
             std::deque<signed_transaction> _popped_tx;
@@ -506,6 +583,12 @@ namespace golos { namespace chain {
 
             void validate_invariants() const;
 
+            /**
+             * Checks invariants on each applied block by changes of objects in the block,
+             * the full scan of validate_invariants() runs each audit_blocks blocks (0 - only on the first block)
+             */
+            void set_validate_invariants(bool value, uint32_t audit_blocks = 0);
+
             /**
              * @}
              */
@@ -540,7 +623,11 @@ namespace golos { namespace chain {
 
             void _apply_transaction(const signed_transaction &trx, uint32_t skip);
 
-            void _validate_transaction(const signed_transaction& trx, uint32_t skip);
+            uint32_t _validate_transaction_impl(
+                const signed_transaction &trx, const flat_set<public_key_type> *signature_keys, uint32_t skip);
+
+            void _validate_transaction(
+                const signed_transaction& trx, uint32_t skip, const flat_set<public_key_type> *signature_keys = nullptr);
 
             void apply_operation(const operation &op, bool is_virtual = false);
 
@@ -570,6 +657,8 @@ namespace golos { namespace chain {
 
             void process_header_extensions(const signed_block &next_block);
 
+            void validate_block_invariants(uint32_t block_num);
+
             void reset_virtual_schedule_time();
 
             void init_hardforks();
@@ -580,11 +669,25 @@ namespace golos { namespace chain {
 
             bool _resize(uint32_t block_num);
 
+            void apply_shared_memory_mapping(bool startup);
+
             ///@}
 
             std::unique_ptr<database_impl> _my;
 
             vector<signed_transaction> _pending_tx;
+
+            supply_invariants _supply_invariants;
+            bool _validate_invariants = false;
+            bool _track_invariants = false;
+            bool _has_validated_invariants = false;
+            uint32_t _invariants_audit_blocks = 0;
+
+            // The candidate of the next block is the longest prefix of _pending_tx, which fits into the block size.
+            // Its transactions are already applied in _pending_tx_session, so the block is assembled without re-applying.
+            size_t _pending_block_tx_count = 0;
+            uint64_t _pending_block_size = 0;
+
             fork_database _fork_db;
             fc::time_point_sec _hardfork_times[STEEMIT_NUM_HARDFORKS + 1];
             protocol::hardfork_version _hardfork_versions[STEEMIT_NUM_HARDFORKS + 1];
@@ -597,6 +700,8 @@ namespace golos { namespace chain {
 
             fc::signal<void()> _plugin_index_signal;
 
+            std::vector<index_statistics_getter> _index_statistics_getters;
+
             transaction_id_type _current_trx_id;
             uint32_t _current_block_num = 0;
             uint16_t _current_trx_in_block = 0;
@@ -615,6 +720,9 @@ namespace golos { namespace chain {
 
             uint32_t _block_num_check_free_memory = 1000;
 
+            shared_memory_mapping_options _shared_memory_mapping;
+            fc::path _shared_mem_dir;
+
             uint32_t _clear_votes_block = 0;
             bool _skip_virtual_ops = false;
             bool _enable_plugins_on_push_transaction = true;
@@ -8,6 +8,9 @@ namespace golos {
         template<typename MultiIndexType>
         void _add_index_impl(database &db) {
             db.add_index<MultiIndexType>();
+            db.add_index_statistics_getter([&db]() {
+                return get_index_statistics<MultiIndexType>(db);
+            });
         }
 
         template<typename MultiIndexType>
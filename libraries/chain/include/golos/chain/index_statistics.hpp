@@ -0,0 +1,76 @@
+#pragma once
+
+#include <golos/chain/steem_object_types.hpp>
+
+#include <boost/core/demangle.hpp>
+#include <boost/mpl/size.hpp>
+
+#include <algorithm>
+#include <cstdint>
+#include <string>
+#include <typeinfo>
+
+namespace golos {
+    namespace chain {
+
+        /**
+         * Approximate usage of the shared memory by one index
+         */
+        struct index_statistics {
+            std::string name;
+            uint64_t object_count = 0;
+            uint64_t node_size = 0;    ///< objects with the nodes of all orderings of multi_index
+            uint64_t dynamic_size = 0; ///< strings and buffers of objects, estimated by a sample spread over the index
+            uint64_t total_size = 0;
+        };
+
+        // Number of objects, which are used to estimate the payload of the whole index
+        constexpr uint32_t index_statistics_sample_size = 1000;
+
+        template<typename MultiIndexType, typename Database>
+        index_statistics get_index_statistics(const Database &db) {
+            using object_type = typename MultiIndexType::value_type;
+
+            // each ordered index adds the parent with color, left and right pointers to the node
+            constexpr std::size_t index_count = boost::mpl::size<typename MultiIndexType::index_type_list>::value;
+            constexpr std::size_t node_size = sizeof(object_type) + index_count * 3 * sizeof(void *);
+
+            const auto &indices = db.template get_index<MultiIndexType>().indices();
+
+            index_statistics result;
+            result.name = boost::core::demangle(typeid(object_type).name());
+            result.object_count = indices.size();
+            result.node_size = result.object_count * node_size;
+
+            // Objects are sampled with a stride over the range of ids, so old and new objects are both counted.
+            // The first index of chainbase is ordered by id, each sampled object costs one lookup.
+            uint64_t sample_count = 0;
+            uint64_t sample_size = 0;
+            if (!indices.empty()) {
+                int64_t first_id = indices.begin()->id._id;
+                int64_t last_id = indices.rbegin()->id._id;
+                int64_t stride = std::max<int64_t>((last_id - first_id + 1) / index_statistics_sample_size, 1);
+
+                for (int64_t id = first_id; id <= last_id && sample_count < index_statistics_sample_size;) {
+                    auto itr = indices.lower_bound(typename object_type::id_type(id));
+                    if (itr == indices.end()) {
+                        break;
+                    }
+                    sample_size += dynamic_memory_usage(*itr);
+                    ++sample_count;
+                    // a gap of removed objects shouldn't make the same object sampled twice
+                    id = std::max(id + stride, itr->id._id + 1);
+                }
+            }
+            if (sample_count) {
+                result.dynamic_size = sample_size * result.object_count / sample_count;
+            }
+
+            result.total_size = result.node_size + result.dynamic_size;
+            return result;
+        }
+
+    }
+} // golos::chain
+
+FC_REFLECT((golos::chain::index_statistics), (name)(object_count)(node_size)(dynamic_size)(total_size))
@@ -82,6 +82,16 @@ namespace golos { namespace chain {
         std::vector<protocol::operation> operations() const;
     };
 
+    inline std::size_t dynamic_memory_usage(const proposal_object &o) {
+        return dynamic_memory_usage(o.title) + dynamic_memory_usage(o.memo) +
+               dynamic_memory_usage(o.proposed_operations) +
+               (o.required_active_approvals.capacity() + o.available_active_approvals.capacity() +
+                o.required_owner_approvals.capacity() + o.available_owner_approvals.capacity() +
+                o.required_posting_approvals.capacity() + o.available_posting_approvals.capacity()) *
+               sizeof(account_name_type) +
+               o.available_key_approvals.capacity() * sizeof(public_key_type);
+    }
+
     /**
      *  @brief Tracks all of the proposal objects that requrie approval of an individual account.
      *  @ingroup objects
@@ -0,0 +1,35 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace golos {
+    namespace chain {
+
+        /**
+         * Placement of the shared memory file in the physical memory.
+         *
+         * The file is mapped by chainbase, so these settings are applied to the mapping after it is opened
+         * or resized. To place the state on hugetlbfs, shared-file-dir should point to a hugetlbfs mount.
+         *
+         * The kernel applies huge pages and NUMA policies of a shared file mapping only to tmpfs and hugetlbfs,
+         * the page cache of a file on disk ignores them.
+         */
+        struct shared_memory_mapping_options {
+            bool huge_pages = false; ///< advise the kernel to back the mapping by transparent huge pages (tmpfs)
+            bool lock = false;       ///< lock the mapping in the physical memory, requires RLIMIT_MEMLOCK
+            bool warm_up = false;    ///< read each page of the mapping, so first blocks aren't applied on cold pages
+            int32_t numa_node = -1;  ///< bind pages of the mapping to the NUMA node (tmpfs, hugetlbfs), -1 - don't bind
+        };
+
+        /**
+         * Applies options to the region [address, address + size) of the file in file_dir.
+         * Failures are logged and don't stop the node, because it can work with the default placement.
+         * Options which have no effect on the filesystem of file_dir are skipped with a warning.
+         */
+        void apply_shared_memory_mapping(
+            void *address, std::size_t size, const std::string &file_dir, const shared_memory_mapping_options &options);
+
+    }
+} // golos::chain
@@ -39,6 +39,30 @@ namespace golos { namespace chain {
 
         typedef boost::interprocess::vector<char, allocator<char>> buffer_type;
 
+        /**
+         * Size of the object payload, which is allocated outside of the multi_index node.
+         * Objects with strings or buffers have overloads in their namespaces, which are found by ADL.
+         */
+        template<typename ObjectType>
+        inline std::size_t dynamic_memory_usage(const ObjectType &) {
+            return 0;
+        }
+
+        inline std::size_t dynamic_memory_usage(const shared_string &s) {
+            // short strings are stored inside of the string object
+            return s.capacity() + 1 > sizeof(shared_string) ? s.capacity() + 1 : 0;
+        }
+
+        template<typename T>
+        inline std::size_t dynamic_memory_usage(const boost::interprocess::vector<T, allocator<T>> &v) {
+            return v.capacity() * sizeof(T);
+        }
+
+        template<typename T>
+        inline std::size_t dynamic_memory_usage(const std::vector<T, allocator<T>> &v) {
+            return v.capacity() * sizeof(T);
+        }
+
         struct by_id;
 
         enum object_type {
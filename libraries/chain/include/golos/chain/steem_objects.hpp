@@ -91,6 +91,10 @@ namespace golos {
             time_point_sec complete;
         };
 
+        inline std::size_t dynamic_memory_usage(const savings_withdraw_object &o) {
+            return dynamic_memory_usage(o.memo);
+        }
+
 
         /**
          *  If last_update is greater than 1 week, then volume gets reset to 0
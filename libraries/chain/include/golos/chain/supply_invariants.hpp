@@ -0,0 +1,73 @@
+#pragma once
+
+#include <golos/protocol/asset.hpp>
+#include <golos/chain/steem_object_types.hpp>
+
+#include <fc/uint128.hpp>
+
+namespace golos {
+    namespace chain {
+
+        using golos::protocol::asset;
+
+        class database;
+
+        /**
+         * Tracks changes of the supply invariants, which are checked by database::validate_invariants(),
+         * while a block is applied.
+         *
+         * Each invariant is the sum of balances of objects minus the total in the global properties.
+         * If invariants hold before the block, they hold after it when all the changes are zero,
+         * so the block is checked in O(changed objects) instead of the full scan of the state.
+         */
+        class supply_invariants final {
+        public:
+            supply_invariants(const database &db);
+
+            // Starts tracking of a new block
+            void reset();
+
+            // Changes can't be tracked, the full scan is required to check the block
+            void invalidate();
+
+            bool is_valid() const;
+
+            // sign is 1 for the new state of the object and -1 for its old state
+            void track(const dynamic_global_property_object &o, int sign);
+            void track(const account_object &o, int sign);
+            void track(const convert_request_object &o, int sign);
+            void track(const limit_order_object &o, int sign);
+            void track(const escrow_object &o, int sign);
+            void track(const savings_withdraw_object &o, int sign);
+            void track(const comment_object &o, int sign);
+
+            template<typename ObjectType>
+            void track(const ObjectType &, int) {
+            }
+
+            // Throws if the tracked changes break any of invariants
+            void validate() const;
+
+        private:
+            void add(asset &total, const asset &value, int sign);
+
+            void add(share_type &total, const share_type &value, int sign);
+
+            void add(fc::uint128_t &total, const fc::uint128_t &value, int sign);
+
+            const database &_db;
+
+            bool _is_valid = true;
+
+            asset _steem = asset(0, STEEM_SYMBOL);
+            asset _sbd = asset(0, SBD_SYMBOL);
+            asset _vesting = asset(0, VESTS_SYMBOL);
+            share_type _vsf_votes = 0;
+
+            // Differences are accumulated modulo 2^128, so the zero check is exact
+            fc::uint128_t _reward_shares2;
+            fc::uint128_t _children_rshares2;
+        };
+
+    }
+} // golos::chain
@@ -34,6 +34,10 @@ namespace golos {
             time_point_sec expiration;
         };
 
+        inline std::size_t dynamic_memory_usage(const transaction_object &o) {
+            return dynamic_memory_usage(o.packed_trx);
+        }
+
         struct by_expiration;
         struct by_trx_id;
         typedef multi_index_container <
@@ -117,6 +117,10 @@ namespace golos { namespace chain {
         time_point_sec hardfork_time_vote = STEEMIT_GENESIS_TIME;
     };
 
+    inline std::size_t dynamic_memory_usage(const witness_object &o) {
+        return dynamic_memory_usage(o.url);
+    }
+
 
     class witness_vote_object
             : public object<witness_vote_object_type, witness_vote_object> {
@@ -0,0 +1,163 @@
+#include <golos/chain/shared_memory_mapping.hpp>
+
+#include <fc/log/logger.hpp>
+#include <fc/time.hpp>
+
+#include <cerrno>
+#include <cstring>
+
+#ifdef __linux__
+#include <linux/magic.h>
+#include <linux/mempolicy.h>
+#include <sys/mman.h>
+#include <sys/statfs.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace golos {
+    namespace chain {
+
+#ifdef __linux__
+
+        namespace {
+
+            enum class file_system {
+                disk,
+                tmpfs,
+                hugetlbfs
+            };
+
+            file_system get_file_system(const std::string &dir) {
+                struct statfs info;
+                if (statfs(dir.c_str(), &info) != 0) {
+                    wlog("Can't get the filesystem of ${dir}: ${e}", ("dir", dir)("e", std::strerror(errno)));
+                    return file_system::disk;
+                }
+                switch (info.f_type) {
+                    case TMPFS_MAGIC:
+                        return file_system::tmpfs;
+                    case HUGETLBFS_MAGIC:
+                        return file_system::hugetlbfs;
+                    default:
+                        return file_system::disk;
+                }
+            }
+
+            void advise_huge_pages(char *begin, std::size_t size, file_system fs) {
+                if (fs == file_system::hugetlbfs) {
+                    ilog("Shared memory is on hugetlbfs, it's already backed by huge pages");
+                    return;
+                }
+                if (fs == file_system::disk) {
+                    wlog("Transparent huge pages aren't used for the shared memory file on disk, "
+                         "set shared-file-dir to a tmpfs or hugetlbfs mount");
+                    return;
+                }
+#ifdef MADV_HUGEPAGE
+                if (madvise(begin, size, MADV_HUGEPAGE) != 0) {
+                    wlog("Can't advise huge pages for shared memory: ${e}", ("e", std::strerror(errno)));
+                    return;
+                }
+                ilog("Shared memory on tmpfs is advised to use transparent huge pages, "
+                     "it takes effect if /sys/kernel/mm/transparent_hugepage/shmem_enabled is 'advise'");
+#else
+                wlog("Transparent huge pages aren't supported by the system");
+#endif
+            }
+
+            void bind_numa_node(char *begin, std::size_t size, int32_t node, file_system fs) {
+                if (fs == file_system::disk) {
+                    wlog("NUMA policy isn't applied to the page cache of the shared memory file on disk, "
+                         "set shared-file-dir to a tmpfs or hugetlbfs mount");
+                    return;
+                }
+
+                constexpr std::size_t mask_bits = sizeof(unsigned long) * 8;
+                if (node < 0 || std::size_t(node) >= mask_bits) {
+                    wlog("NUMA node ${n} is out of range [0, ${max})", ("n", node)("max", mask_bits));
+                    return;
+                }
+
+                // libnuma isn't required, the syscall is enough for binding one region
+                unsigned long mask = 1ul << node;
+                if (syscall(SYS_mbind, begin, size, MPOL_BIND, &mask, mask_bits, MPOL_MF_MOVE) != 0) {
+                    wlog("Can't bind shared memory to NUMA node ${n}: ${e}", ("n", node)("e", std::strerror(errno)));
+                    return;
+                }
+                ilog("Shared memory is bound to NUMA node ${n}", ("n", node));
+            }
+
+            void lock_memory(char *begin, std::size_t size) {
+                if (mlock(begin, size) != 0) {
+                    wlog("Can't lock ${mem}M of shared memory: ${e}. Check the memlock limit",
+                         ("mem", size / (1024 * 1024))("e", std::strerror(errno)));
+                    return;
+                }
+                ilog("Shared memory is locked in RAM");
+            }
+
+            void warm_up(char *begin, std::size_t size, std::size_t page_size) {
+                auto start = fc::time_point::now();
+
+                madvise(begin, size, MADV_WILLNEED);
+
+                // Pages are only read, writing would make the whole file dirty
+                volatile char sum = 0;
+                for (std::size_t offset = 0; offset < size; offset += page_size) {
+                    sum += begin[offset];
+                }
+                (void)sum;
+
+                auto end = fc::time_point::now();
+                ilog("Shared memory warm-up of ${mem}M is done, elapsed time ${t} sec",
+                     ("mem", size / (1024 * 1024))("t", double((end - start).count()) / 1000000.0));
+            }
+
+        } // anonymous namespace
+
+        void apply_shared_memory_mapping(
+            void *address, std::size_t size, const std::string &file_dir, const shared_memory_mapping_options &options
+        ) {
+            if (!address || !size) {
+                return;
+            }
+
+            // madvise, mbind and mlock require the page aligned address
+            const std::size_t page_size = std::size_t(sysconf(_SC_PAGESIZE));
+            auto addr = reinterpret_cast<std::uintptr_t>(address);
+            auto aligned = addr - addr % page_size;
+            char *begin = reinterpret_cast<char *>(aligned);
+            size += addr - aligned;
+
+            // Policies are set before pages are touched, so the pages are allocated with them
+            if (options.huge_pages || options.numa_node >= 0) {
+                auto fs = get_file_system(file_dir);
+                if (options.huge_pages) {
+                    advise_huge_pages(begin, size, fs);
+                }
+                if (options.numa_node >= 0) {
+                    bind_numa_node(begin, size, options.numa_node, fs);
+                }
+            }
+            if (options.lock) {
+                lock_memory(begin, size);
+            } else if (options.warm_up) {
+                warm_up(begin, size, page_size);
+            }
+        }
+
+#else
+
+        void apply_shared_memory_mapping(
+            void *address, std::size_t size, const std::string &file_dir, const shared_memory_mapping_options &options
+        ) {
+            if (options.huge_pages || options.lock || options.warm_up || options.numa_node >= 0) {
+                wlog("Options of shared memory mapping are supported only on Linux");
+            }
+        }
+
+#endif
+
+    }
+} // golos::chain
@@ -0,0 +1,163 @@
+#include <golos/chain/supply_invariants.hpp>
+#include <golos/chain/database.hpp>
+#include <golos/chain/account_object.hpp>
+#include <golos/chain/comment_object.hpp>
+#include <golos/chain/steem_objects.hpp>
+#include <golos/chain/witness_objects.hpp>
+
+namespace golos {
+    namespace chain {
+
+        supply_invariants::supply_invariants(const database &db)
+                : _db(db) {
+        }
+
+        void supply_invariants::reset() {
+            _is_valid = true;
+            _steem = asset(0, STEEM_SYMBOL);
+            _sbd = asset(0, SBD_SYMBOL);
+            _vesting = asset(0, VESTS_SYMBOL);
+            _vsf_votes = 0;
+            _reward_shares2 = 0;
+            _children_rshares2 = 0;
+        }
+
+        void supply_invariants::invalidate() {
+            _is_valid = false;
+        }
+
+        bool supply_invariants::is_valid() const {
+            return _is_valid;
+        }
+
+        void supply_invariants::add(asset &total, const asset &value, int sign) {
+            if (sign > 0) {
+                total.amount += value.amount;
+            } else {
+                total.amount -= value.amount;
+            }
+        }
+
+        void supply_invariants::add(share_type &total, const share_type &value, int sign) {
+            if (sign > 0) {
+                total += value;
+            } else {
+                total -= value;
+            }
+        }
+
+        void supply_invariants::add(fc::uint128_t &total, const fc::uint128_t &value, int sign) {
+            if (sign > 0) {
+                total += value;
+            } else {
+                total -= value;
+            }
+        }
+
+        void supply_invariants::track(const dynamic_global_property_object &o, int sign) {
+            add(_steem, o.total_vesting_fund_steem, sign);
+            add(_steem, o.total_reward_fund_steem, sign);
+            add(_steem, o.current_supply, -sign);
+            add(_sbd, o.current_sbd_supply, -sign);
+            add(_vesting, o.total_vesting_shares, -sign);
+            add(_vsf_votes, o.total_vesting_shares.amount, -sign);
+            add(_reward_shares2, o.total_reward_shares2, -sign);
+        }
+
+        void supply_invariants::track(const account_object &o, int sign) {
+            add(_steem, o.balance, sign);
+            add(_steem, o.savings_balance, sign);
+            add(_sbd, o.sbd_balance, sign);
+            add(_sbd, o.savings_sbd_balance, sign);
+            add(_vesting, o.vesting_shares, sign);
+
+            if (o.proxy == STEEMIT_PROXY_TO_SELF_ACCOUNT) {
+                add(_vsf_votes, o.witness_vote_weight(), sign);
+            } else if (STEEMIT_MAX_PROXY_RECURSION_DEPTH > 0) {
+                add(_vsf_votes, o.proxied_vsf_votes[STEEMIT_MAX_PROXY_RECURSION_DEPTH - 1], sign);
+            } else {
+                add(_vsf_votes, o.vesting_shares.amount, sign);
+            }
+        }
+
+        void supply_invariants::track(const convert_request_object &o, int sign) {
+            if (o.amount.symbol == STEEM_SYMBOL) {
+                add(_steem, o.amount, sign);
+            } else if (o.amount.symbol == SBD_SYMBOL) {
+                add(_sbd, o.amount, sign);
+            } else {
+                invalidate();
+            }
+        }
+
+        void supply_invariants::track(const limit_order_object &o, int sign) {
+            if (o.sell_price.base.symbol == STEEM_SYMBOL) {
+                add(_steem, asset(o.for_sale, STEEM_SYMBOL), sign);
+            } else if (o.sell_price.base.symbol == SBD_SYMBOL) {
+                add(_sbd, asset(o.for_sale, SBD_SYMBOL), sign);
+            }
+        }
+
+        void supply_invariants::track(const escrow_object &o, int sign) {
+            add(_steem, o.steem_balance, sign);
+            add(_sbd, o.sbd_balance, sign);
+
+            if (o.pending_fee.symbol == STEEM_SYMBOL) {
+                add(_steem, o.pending_fee, sign);
+            } else if (o.pending_fee.symbol == SBD_SYMBOL) {
+                add(_sbd, o.pending_fee, sign);
+            } else {
+                invalidate();
+            }
+        }
+
+        void supply_invariants::track(const savings_withdraw_object &o, int sign) {
+            if (o.amount.symbol == STEEM_SYMBOL) {
+                add(_steem, o.amount, sign);
+            } else if (o.amount.symbol == SBD_SYMBOL) {
+                add(_sbd, o.amount, sign);
+            } else {
+                invalidate();
+            }
+        }
+
+        void supply_invariants::track(const comment_object &o, int sign) {
+            if (o.net_rshares.value > 0) {
+                auto vshares = _db.calculate_vshares(o.net_rshares.value);
+                add(_reward_shares2, vshares, sign);
+                add(_children_rshares2, vshares, sign);
+            }
+            if (o.parent_author == STEEMIT_ROOT_POST_PARENT) {
+                add(_children_rshares2, o.children_rshares2, -sign);
+            }
+        }
+
+        void supply_invariants::validate() const {
+            FC_ASSERT(_is_valid, "Changes of the supply can't be tracked");
+
+            FC_ASSERT(_steem.amount == 0, "Change of current_supply doesn't match change of balances",
+                      ("delta", _steem));
+            FC_ASSERT(_sbd.amount == 0, "Change of current_sbd_supply doesn't match change of balances",
+                      ("delta", _sbd));
+            FC_ASSERT(_vesting.amount == 0, "Change of total_vesting_shares doesn't match change of vesting shares",
+                      ("delta", _vesting));
+            FC_ASSERT(_vsf_votes == 0, "Change of total_vesting_shares doesn't match change of vsf votes",
+                      ("delta", _vsf_votes));
+            FC_ASSERT(_reward_shares2 == 0, "Change of total_reward_shares2 doesn't match change of comments",
+                      ("delta", _reward_shares2));
+            FC_ASSERT(_children_rshares2 == 0, "Change of rshares2 doesn't match change of children_rshares2",
+                      ("delta", _children_rshares2));
+
+            // total_vesting_shares can fall below votes of an unchanged witness,
+            // so the top witness is checked instead of the changed ones
+            const auto &gpo = _db.get_dynamic_global_properties();
+            const auto &widx = _db.get_index<witness_index>().indices().get<by_vote_name>();
+            auto top = widx.begin();
+            if (top != widx.end()) {
+                FC_ASSERT(top->votes < gpo.total_vesting_shares.amount, "Witness has too many votes",
+                          ("witness", top->owner)("votes", top->votes)("total_vesting_shares", gpo.total_vesting_shares));
+            }
+        }
+
+    }
+} // golos::chain
@@ -22,6 +22,7 @@
  * THE SOFTWARE.
  */
 #include <golos/network/core_messages.hpp>
+#include <golos/network/message.hpp>
 
 
 namespace golos {
@@ -46,6 +47,18 @@ namespace golos {
         const core_message_type_enum check_firewall_reply_message::type = core_message_type_enum::check_firewall_reply_message_type;
         const core_message_type_enum get_current_connections_request_message::type = core_message_type_enum::get_current_connections_request_message_type;
         const core_message_type_enum get_current_connections_reply_message::type = core_message_type_enum::get_current_connections_reply_message_type;
+        const core_message_type_enum compact_block_message::type = core_message_type_enum::compact_block_message_type;
+        const core_message_type_enum get_compact_block_transactions_message::type = core_message_type_enum::get_compact_block_transactions_message_type;
+        const core_message_type_enum compact_block_transactions_message::type = core_message_type_enum::compact_block_transactions_message_type;
+        const core_message_type_enum fetch_block_range_message::type = core_message_type_enum::fetch_block_range_message_type;
+
+        compact_block_message::compact_block_message(const block_message &blk, const fc::uint160_t &block_message_hash)
+                : block_message_hash(block_message_hash), header(blk.block), block_id(blk.block_id) {
+            transaction_message_hashes.reserve(blk.block.transactions.size());
+            for (const auto &trx : blk.block.transactions) {
+                transaction_message_hashes.push_back(message(trx_message(trx)).id());
+            }
+        }
 
     }
 } // golos::network
@@ -39,6 +39,12 @@
 #define MAX_MESSAGE_SIZE                                     1024*1024*2
 #define GRAPHENE_NET_DEFAULT_PEER_CONNECTION_RETRY_TIME      30 // seconds
 
+/**
+ * Size of the per-connection buffer for received data, must be a multiple of 16 (AES block size).
+ * Messages larger than this are read into a temporarily grown buffer
+ */
+#define GRAPHENE_NET_READ_BUFFER_SIZE                        (64 * 1024)
+
 /**
  * AFter trying all peers, how long to wait before we check to
  * see if there are peers we can try again.
@@ -79,7 +85,39 @@
 
 #define GRAPHENE_NET_MAX_INVENTORY_SIZE_IN_MINUTES           2
 
-#define GRAPHENE_NET_MAX_BLOCKS_PER_PEER_DURING_SYNCING      200
+/**
+ * During sync, blocks are requested from each peer in batches, which size is adapted
+ * to the measured throughput of the peer: the batch should take about
+ * GRAPHENE_NET_SYNC_BATCH_DURATION_MS to deliver, but not less than 10 round trips,
+ * so the delay between batches is small compared to the batch itself.
+ */
+#define GRAPHENE_NET_MIN_BLOCKS_PER_PEER_DURING_SYNCING      10
+#define GRAPHENE_NET_INITIAL_BLOCKS_PER_PEER_DURING_SYNCING  100
+#define GRAPHENE_NET_MAX_BLOCKS_PER_PEER_DURING_SYNCING      1000
+#define GRAPHENE_NET_SYNC_BATCH_DURATION_MS                  2000
+
+/**
+ * Maximum number of compact blocks from one peer, which wait for their missing transactions.
+ * Each of them is requested from the peer, so it's not less than the number of sync requests.
+ */
+#define GRAPHENE_NET_MAX_PARTIAL_BLOCKS_PER_PEER             GRAPHENE_NET_MAX_BLOCKS_PER_PEER_DURING_SYNCING
+
+/**
+ * Maximum number of blocks in one fetch_block_range_message, it's a part of the protocol and doesn't depend
+ * on the configured sync window. Larger ranges are requested with several messages,
+ * only the beginning of a larger range is sent.
+ */
+#define GRAPHENE_NET_MAX_BLOCK_RANGE_SIZE                    1000
+
+/**
+ * Blocks requested with fetch_block_range_message are read and sent in batches of this size
+ */
+#define GRAPHENE_NET_BLOCK_RANGE_BATCH_SIZE                  50
+
+/**
+ * A sync block, which wasn't delivered during this time, is requested again from an idle peer
+ */
+#define GRAPHENE_NET_STALLED_SYNC_REQUEST_TIMEOUT_MS         5000
 
 /**
  * During normal operation, how many items will be fetched from each
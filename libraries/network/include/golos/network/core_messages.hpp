@@ -89,6 +89,10 @@ namespace golos {
             check_firewall_reply_message_type = 5015,
             get_current_connections_request_message_type = 5016,
             get_current_connections_reply_message_type = 5017,
+            compact_block_message_type = 5018,
+            get_compact_block_transactions_message_type = 5019,
+            compact_block_transactions_message_type = 5020,
+            fetch_block_range_message_type = 5021,
             core_message_type_last = 5099
         };
 
@@ -122,6 +126,50 @@ namespace golos {
 
         };
 
+        /**
+         * A block sent without its transactions, which the receiver most likely already has in its message cache.
+         * Transactions are identified by hashes of their trx_message, so the receiver can find them in the cache
+         * and ask only for the missing ones with get_compact_block_transactions_message.
+         *
+         * Sent only to peers which declared "compact_blocks" in the hello message.
+         */
+        struct compact_block_message {
+            static const core_message_type_enum type;
+
+            compact_block_message() {
+            }
+
+            compact_block_message(const block_message &blk, const fc::uint160_t &block_message_hash);
+
+            fc::uint160_t block_message_hash; /// hash of the full block_message, it was requested with
+            golos::protocol::signed_block_header header;
+            block_id_type block_id;
+            std::vector<fc::uint160_t> transaction_message_hashes;
+        };
+
+        struct get_compact_block_transactions_message {
+            static const core_message_type_enum type;
+
+            block_id_type block_id;
+            std::vector<uint32_t> indexes;
+
+            get_compact_block_transactions_message() {
+            }
+
+            get_compact_block_transactions_message(const block_id_type &block_id, std::vector<uint32_t> indexes)
+                    :
+                    block_id(block_id),
+                    indexes(std::move(indexes)) {
+            }
+        };
+
+        struct compact_block_transactions_message {
+            static const core_message_type_enum type;
+
+            block_id_type block_id;
+            std::vector<signed_transaction> transactions;
+        };
+
         struct item_ids_inventory_message {
             static const core_message_type_enum type;
 
@@ -189,6 +237,28 @@ namespace golos {
             }
         };
 
+        /**
+         * Requests all blocks of the chain from first_block_id to last_block_id in a single message.
+         * The peer answers with block_messages in order, it reads them in batches directly from its block log.
+         *
+         * Sent only to peers which declared "block_ranges" in the hello message.
+         */
+        struct fetch_block_range_message {
+            static const core_message_type_enum type;
+
+            block_id_type first_block_id;
+            block_id_type last_block_id;
+
+            fetch_block_range_message() {
+            }
+
+            fetch_block_range_message(const block_id_type &first_block_id, const block_id_type &last_block_id)
+                    :
+                    first_block_id(first_block_id),
+                    last_block_id(last_block_id) {
+            }
+        };
+
         struct item_not_available_message {
             static const core_message_type_enum type;
 
@@ -444,10 +514,17 @@ FC_REFLECT_ENUM(golos::network::core_message_type_enum,
                 (check_firewall_reply_message_type)
                 (get_current_connections_request_message_type)
                 (get_current_connections_reply_message_type)
+                (compact_block_message_type)
+                (get_compact_block_transactions_message_type)
+                (compact_block_transactions_message_type)
+                (fetch_block_range_message_type)
                 (core_message_type_last))
 
 FC_REFLECT((golos::network::trx_message), (trx))
 FC_REFLECT((golos::network::block_message), (block)(block_id))
+FC_REFLECT((golos::network::compact_block_message), (block_message_hash)(header)(block_id)(transaction_message_hashes))
+FC_REFLECT((golos::network::get_compact_block_transactions_message), (block_id)(indexes))
+FC_REFLECT((golos::network::compact_block_transactions_message), (block_id)(transactions))
 
 FC_REFLECT((golos::network::item_id), (item_type)
         (item_hash))
@@ -460,6 +537,8 @@ FC_REFLECT((golos::network::fetch_blockchain_item_ids_message), (item_type)
         (blockchain_synopsis))
 FC_REFLECT((golos::network::fetch_items_message), (item_type)
         (items_to_fetch))
+FC_REFLECT((golos::network::fetch_block_range_message), (first_block_id)
+        (last_block_id))
 FC_REFLECT((golos::network::item_not_available_message), (requested_item))
 FC_REFLECT((golos::network::hello_message), (user_agent)
         (core_protocol_version)
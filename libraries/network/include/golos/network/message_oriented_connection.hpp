@@ -31,6 +31,16 @@ namespace golos {
 
         namespace detail { class message_oriented_connection_impl; }
 
+        /**
+         *  A message with its header, padded to the AES block size and ready to be encrypted.
+         *  It is immutable, so one copy can be queued to any number of connections.
+         */
+        typedef std::shared_ptr<const std::vector<char>> padded_message_ptr;
+
+        padded_message_ptr pad_message(const message &message_to_pad);
+
+        const message_header &get_padded_message_header(const padded_message_ptr &padded_message);
+
         class message_oriented_connection;
 
         /** receives incoming messages from a message_oriented_connection object */
@@ -58,6 +68,8 @@ namespace golos {
 
             void send_message(const message &message_to_send);
 
+            void send_padded_message(const padded_message_ptr &padded_message);
+
             void close_connection();
 
             void destroy_connection();
@@ -74,6 +86,8 @@ namespace golos {
 
             fc::sha512 get_shared_secret() const;
 
+            fc::microseconds get_crypto_time() const;
+
         private:
             std::unique_ptr<detail::message_oriented_connection_impl> my;
         };
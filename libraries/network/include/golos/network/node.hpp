@@ -53,6 +53,60 @@ namespace golos {
             node_id_t originating_peer;
         };
 
+        /**
+         *  Traffic of one type of messages, times are in microseconds
+         */
+        struct message_type_statistics {
+            std::string message_type;
+            uint64_t messages_received = 0;
+            uint64_t bytes_received = 0;
+            uint64_t handling_time = 0; /// time spent in handlers of received messages, including calls to the delegate
+            uint64_t messages_sent = 0;
+            uint64_t bytes_sent = 0;
+            uint64_t queue_time = 0; /// time sent messages were waiting in the send queue
+        };
+
+        struct peer_statistics {
+            fc::ip::endpoint host;
+            fc::time_point connection_time;
+            uint64_t bytes_received = 0;
+            uint64_t bytes_sent = 0;
+            uint64_t crypto_time = 0; /// microseconds spent in encryption and decryption of the traffic
+            uint32_t send_queue_messages = 0;
+            uint64_t send_queue_bytes = 0;
+            std::vector<message_type_statistics> messages;
+        };
+
+        /**
+         *  Delay between the timestamp of a block and the moment we received it, in milliseconds.
+         *  Only blocks received during normal operation are counted.
+         */
+        struct block_propagation_statistics {
+            uint64_t blocks = 0;
+            int64_t last_delay = 0;
+            int64_t average_delay = 0; /// moving average
+            int64_t max_delay = 0;
+        };
+
+        struct network_statistics {
+            uint32_t connections = 0;
+            uint64_t crypto_time = 0;
+            std::vector<message_type_statistics> messages; /// totals for all connections, including closed ones
+            std::vector<peer_statistics> peers;
+            block_propagation_statistics block_propagation;
+        };
+
+        /**
+         * Source of network statistics, which can be used without a dependency on the P2P plugin
+         */
+        class network_statistics_provider {
+        public:
+            virtual ~network_statistics_provider() {
+            }
+
+            virtual network_statistics get_network_statistics() const = 0;
+        };
+
         /**
          *  @class node_delegate
          *  @brief used by node reports status to client or fetch data from client
@@ -113,6 +167,14 @@ namespace golos {
              */
             virtual message get_item(const item_id &id) = 0;
 
+            /**
+             *  Returns block messages for up to count blocks starting from first_block_num
+             *  of the chain which ends with last_block_id, stops at our head block.
+             *  Throws if last_block_id isn't in our main chain.
+             */
+            virtual std::vector<message> get_block_range(const item_hash_t &last_block_id,
+                    uint32_t first_block_num, uint32_t count) = 0;
+
             /**
              * Returns a synopsis of the blockchain used for syncing.
              * This consists of a list of selected item hashes from our current preferred
@@ -299,6 +361,8 @@ namespace golos {
 
             fc::variant_object get_call_statistics() const;
 
+            network_statistics get_network_statistics() const;
+
         private:
             std::unique_ptr<detail::node_impl, detail::node_impl_deleter> my;
         };
@@ -352,3 +416,9 @@ namespace golos {
 
 FC_REFLECT((golos::network::message_propagation_data), (received_time)(validated_time)(originating_peer));
 FC_REFLECT((golos::network::peer_status), (version)(host)(info));
+FC_REFLECT((golos::network::message_type_statistics),
+        (message_type)(messages_received)(bytes_received)(handling_time)(messages_sent)(bytes_sent)(queue_time));
+FC_REFLECT((golos::network::peer_statistics),
+        (host)(connection_time)(bytes_received)(bytes_sent)(crypto_time)(send_queue_messages)(send_queue_bytes)(messages));
+FC_REFLECT((golos::network::block_propagation_statistics), (blocks)(last_delay)(average_delay)(max_delay));
+FC_REFLECT((golos::network::network_statistics), (connections)(crypto_time)(messages)(peers)(block_propagation));
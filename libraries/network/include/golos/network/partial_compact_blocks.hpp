@@ -0,0 +1,67 @@
+#pragma once
+
+#include <golos/network/core_messages.hpp>
+#include <golos/network/config.hpp>
+
+#include <fc/optional.hpp>
+
+#include <functional>
+#include <unordered_map>
+
+namespace golos {
+    namespace network {
+
+        /**
+         * Compact block waiting for the transactions, which are missing in the message cache
+         */
+        struct partial_compact_block {
+            signed_block block;
+            message_hash_type message_hash; /// hash of the block_message we've requested
+            std::vector<uint32_t> missing_transactions;
+
+            // Puts the received transactions to their places, returns false if their number is wrong
+            bool complete(const std::vector<signed_transaction> &transactions);
+        };
+
+        using find_transaction_type = std::function<fc::optional<signed_transaction> (const message_hash_type &)>;
+
+        /**
+         * Rebuilds the block from the compact block message with the already known transactions,
+         *   indexes of the missing ones are stored in the result.
+         */
+        partial_compact_block rebuild_compact_block(const compact_block_message &, const find_transaction_type &);
+
+        /**
+         * Compact blocks of a peer waiting for the missing transactions.
+         *
+         * Each block should be requested from the peer before, so the number of blocks is limited
+         * by the number of requests. The limit is checked again here, so a peer can't fill the memory
+         * with blocks, even if the requests are tracked wrong.
+         */
+        class partial_compact_blocks final {
+        public:
+            explicit partial_compact_blocks(std::size_t max_size = GRAPHENE_NET_MAX_PARTIAL_BLOCKS_PER_PEER);
+
+            // Returns false if the block is already waiting for transactions or the limit is reached
+            bool insert(const block_id_type &block_id, partial_compact_block block);
+
+            // Removes the block and returns it
+            fc::optional<partial_compact_block> take(const block_id_type &block_id);
+
+            bool contains(const block_id_type &block_id) const;
+
+            void set_max_size(std::size_t max_size);
+
+            std::size_t size() const;
+
+            bool empty() const;
+
+            void clear();
+
+        private:
+            std::size_t _max_size;
+            std::unordered_map<block_id_type, partial_compact_block> _blocks;
+        };
+
+    }
+} // golos::network
@@ -28,6 +28,7 @@
 #include <golos/network/message_oriented_connection.hpp>
 #include <golos/network/stcp_socket.hpp>
 #include <golos/network/config.hpp>
+#include <golos/network/partial_compact_blocks.hpp>
 
 #include <boost/tuple/tuple.hpp>
 
@@ -40,6 +41,7 @@
 #include <boost/multi_index/sequenced_index.hpp>
 #include <boost/multi_index/hashed_index.hpp>
 
+#include <map>
 #include <queue>
 #include <boost/container/deque.hpp>
 #include <fc/thread/future.hpp>
@@ -70,6 +72,10 @@ namespace golos {
             virtual void on_connection_closed(peer_connection *originating_peer) = 0;
 
             virtual message get_message_for_item(const item_id &item) = 0;
+
+            // returns consecutive blocks of the chain ending with last_block_id, padded and concatenated into one buffer
+            virtual padded_message_ptr get_messages_for_block_range(const item_hash_t &last_block_id,
+                    uint32_t first_block_num, uint32_t count) = 0;
         };
 
         class peer_connection;
@@ -122,7 +128,7 @@ namespace golos {
                         enqueue_time(enqueue_time) {
                 }
 
-                virtual message get_message(peer_connection_delegate *node) = 0;
+                virtual padded_message_ptr get_message(peer_connection_delegate *node) = 0;
 
                 /** returns roughly the number of bytes of memory the message is consuming while
                  * it is sitting on the queue
@@ -146,7 +152,22 @@ namespace golos {
                         message_send_time_field_offset(message_send_time_field_offset) {
                 }
 
-                message get_message(peer_connection_delegate *node) override;
+                padded_message_ptr get_message(peer_connection_delegate *node) override;
+
+                size_t get_size_in_queue() override;
+            };
+
+            /* a 'shared_queued_message' is already padded for sending and can be queued to many peers at once,
+             * e.g. a broadcast item from the message cache
+             */
+            struct shared_queued_message : queued_message {
+                padded_message_ptr message_to_send;
+
+                shared_queued_message(padded_message_ptr message_to_send) :
+                        message_to_send(std::move(message_to_send)) {
+                }
+
+                padded_message_ptr get_message(peer_connection_delegate *node) override;
 
                 size_t get_size_in_queue() override;
             };
@@ -162,12 +183,31 @@ namespace golos {
                         item_to_send(std::move(item_to_send)) {
                 }
 
-                message get_message(peer_connection_delegate *node) override;
+                padded_message_ptr get_message(peer_connection_delegate *node) override;
 
                 size_t get_size_in_queue() override;
             };
 
 
+            /* a 'block_range_queued_message' is a batch of blocks requested with fetch_block_range_message,
+             * the blocks are read from the node in one call when it reaches the top of the queue.
+             */
+            struct block_range_queued_message : queued_message {
+                item_hash_t last_block_id;
+                uint32_t first_block_num;
+                uint32_t count;
+
+                block_range_queued_message(const item_hash_t &last_block_id, uint32_t first_block_num, uint32_t count) :
+                        last_block_id(last_block_id),
+                        first_block_num(first_block_num),
+                        count(count) {
+                }
+
+                padded_message_ptr get_message(peer_connection_delegate *node) override;
+
+                size_t get_size_in_queue() override;
+            };
+
             size_t _total_queued_messages_size;
             std::queue<std::unique_ptr<queued_message>, std::list<std::unique_ptr<queued_message>>> _queued_messages;
             fc::future<void> _send_queued_messages_done;
@@ -239,6 +279,12 @@ namespace golos {
             item_hash_t last_block_delegate_has_seen; /// the hash of the last block  this peer has told us about that the peer knows
             fc::time_point_sec last_block_time_delegate_has_seen;
             bool inhibit_fetching_sync_blocks;
+            uint32_t sync_window; /// number of blocks to request from this peer at once, adapted to its throughput
+            fc::time_point sync_batch_request_time; /// when the current batch of sync blocks was requested
+            uint32_t sync_batch_size; /// number of blocks in the current batch
+            uint64_t sync_batch_bytes; /// bytes of the current batch received so far
+            uint64_t sync_blocks_per_second; /// moving average of the sync throughput
+            uint64_t sync_bytes_per_second;
             /// @}
 
             /// non-synchronization state data
@@ -265,8 +311,14 @@ namespace golos {
             timestamped_items_set_type inventory_advertised_to_peer;
 
             item_to_time_map_type items_requested_from_peer;  /// items we've requested from this peer during normal operation.  fetch from another peer if this peer disconnects
+
+            bool supports_compact_blocks; /// peer understands compact_block_message
+            bool supports_block_ranges; /// peer understands fetch_block_range_message
+            partial_compact_blocks partial_blocks_from_peer; /// compact blocks waiting for the missing transactions
             /// @}
 
+            std::map<uint32_t, message_type_statistics> message_statistics; /// traffic of this connection by message type
+
             // if they're flooding us with transactions, we set this to avoid fetching for a few seconds to let the
             // blockchain catch up
             fc::time_point transaction_fetching_inhibited_until;
@@ -304,8 +356,12 @@ namespace golos {
 
             void send_message(const message &message_to_send, size_t message_send_time_field_offset = (size_t)-1);
 
+            void send_padded_message(const padded_message_ptr &message_to_send);
+
             void send_item(const item_id &item_to_send);
 
+            void send_block_range(const item_hash_t &last_block_id, uint32_t first_block_num, uint32_t count);
+
             void close_connection();
 
             void destroy_connection();
@@ -332,6 +388,14 @@ namespace golos {
 
             fc::sha512 get_shared_secret() const;
 
+            fc::microseconds get_crypto_time() const;
+
+            size_t get_send_queue_length() const;
+
+            size_t get_send_queue_size() const;
+
+            message_type_statistics &get_message_statistics(uint32_t msg_type);
+
             void clear_old_inventory();
 
             bool is_inventory_advertised_to_us_list_full_for_transactions() const;
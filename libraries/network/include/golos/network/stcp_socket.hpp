@@ -74,6 +74,11 @@ namespace golos {
                 return _shared_secret;
             }
 
+            /** total time spent in encryption and decryption */
+            fc::microseconds get_crypto_time() const {
+                return _crypto_time;
+            }
+
         private:
             void do_key_exchange();
 
@@ -86,6 +91,7 @@ namespace golos {
             fc::aes_decoder _recv_aes;
             std::shared_ptr<char> _read_buffer;
             std::shared_ptr<char> _write_buffer;
+            fc::microseconds _crypto_time;
 #ifndef NDEBUG
             bool _read_buffer_in_use;
             bool _write_buffer_in_use;
@@ -65,6 +65,9 @@ namespace golos {
 
                 void read_loop();
 
+                // Reads data into the buffer until it contains required_size bytes, unprocessed data is kept
+                void read_into_buffer(std::vector<char> &buffer, size_t &begin, size_t &end, size_t required_size);
+
                 void start_read_loop();
 
             public:
@@ -81,7 +84,7 @@ namespace golos {
 
                 ~message_oriented_connection_impl();
 
-                void send_message(const message &message_to_send);
+                void send_padded_message(const padded_message_ptr &padded_message);
 
                 void close_connection();
 
@@ -100,6 +103,8 @@ namespace golos {
                 }
 
                 fc::sha512 get_shared_secret() const;
+
+                fc::microseconds get_crypto_time() const;
             };
 
             message_oriented_connection_impl::message_oriented_connection_impl(message_oriented_connection *self,
@@ -147,10 +152,8 @@ namespace golos {
 
             void message_oriented_connection_impl::read_loop() {
                 VERIFY_CORRECT_THREAD();
-                const int BUFFER_SIZE = 16;
-                const int LEFTOVER = BUFFER_SIZE - sizeof(message_header);
-                static_assert(BUFFER_SIZE >=
-                              sizeof(message_header), "insufficient buffer");
+                static_assert(GRAPHENE_NET_READ_BUFFER_SIZE % 16 == 0, "buffer should contain whole AES blocks");
+                static_assert(GRAPHENE_NET_READ_BUFFER_SIZE >= 16, "insufficient buffer");
 
                 _connected_time = fc::time_point::now();
 
@@ -158,28 +161,34 @@ namespace golos {
                 bool call_on_connection_closed = false;
 
                 try {
-                    message m;
+                    // Decrypted data is read in large chunks, all whole messages from the chunk are handled
+                    // before the next read. Messages are padded to 16 bytes, so [begin, end) always
+                    // contains whole AES blocks
+                    std::vector<char> buffer(GRAPHENE_NET_READ_BUFFER_SIZE);
+                    size_t begin = 0;
+                    size_t end = 0;
+
                     while (true) {
-                        char buffer[BUFFER_SIZE];
-                        _sock.read(buffer, BUFFER_SIZE);
-                        _bytes_received += BUFFER_SIZE;
-                        memcpy((char *)&m, buffer, sizeof(message_header));
+                        if (end - begin < sizeof(message_header)) {
+                            read_into_buffer(buffer, begin, end, 16);
+                            continue;
+                        }
+
+                        message m;
+                        memcpy((char *)&m, buffer.data() + begin, sizeof(message_header));
 
                         FC_ASSERT(m.size <=
                                   MAX_MESSAGE_SIZE, "", ("m.size", m.size)("MAX_MESSAGE_SIZE", MAX_MESSAGE_SIZE));
 
-                        size_t remaining_bytes_with_padding =
-                                16 * ((m.size - LEFTOVER + 15) / 16);
-                        m.data.resize(LEFTOVER +
-                                      remaining_bytes_with_padding); //give extra 16 bytes to allow for padding added in send call
-                        std::copy(
-                                buffer + sizeof(message_header),
-                                buffer + sizeof(buffer), m.data.begin());
-                        if (remaining_bytes_with_padding) {
-                            _sock.read(&m.data[LEFTOVER], remaining_bytes_with_padding);
-                            _bytes_received += remaining_bytes_with_padding;
+                        size_t size_with_padding = 16 * ((sizeof(message_header) + m.size + 15) / 16);
+                        if (end - begin < size_with_padding) {
+                            read_into_buffer(buffer, begin, end, size_with_padding);
+                            continue;
                         }
-                        m.data.resize(m.size); // truncate off the padding bytes
+
+                        auto data = buffer.data() + begin + sizeof(message_header);
+                        m.data.assign(data, data + m.size);
+                        begin += size_with_padding;
 
                         _last_message_received_time = fc::time_point::now();
 
@@ -234,7 +243,33 @@ namespace golos {
                 }
             }
 
-            void message_oriented_connection_impl::send_message(const message &message_to_send) {
+            void message_oriented_connection_impl::read_into_buffer(std::vector<char> &buffer, size_t &begin, size_t &end, size_t required_size) {
+                // move the incomplete message to the front of the buffer
+                if (begin == end) {
+                    begin = end = 0;
+                    if (buffer.size() > GRAPHENE_NET_READ_BUFFER_SIZE) {
+                        // release memory after a large message
+                        std::vector<char>(GRAPHENE_NET_READ_BUFFER_SIZE).swap(buffer);
+                    }
+                } else if (begin != 0) {
+                    memmove(buffer.data(), buffer.data() + begin, end - begin);
+                    end -= begin;
+                    begin = 0;
+                }
+
+                if (buffer.size() < required_size) {
+                    buffer.resize(required_size);
+                }
+
+                // required_size and end are multiples of 16, so the free space consists of whole AES blocks
+                while (end < required_size) {
+                    size_t bytes_read = _sock.readsome(buffer.data() + end, buffer.size() - end);
+                    _bytes_received += bytes_read;
+                    end += bytes_read;
+                }
+            }
+
+            void message_oriented_connection_impl::send_padded_message(const padded_message_ptr &padded_message) {
                 VERIFY_CORRECT_THREAD();
 #if 0 // this gets too verbose
 #ifndef NDEBUG
@@ -264,20 +299,10 @@ namespace golos {
                 } _verify_no_send_in_progress(_send_message_in_progress);
 
                 try {
-                    size_t size_of_message_and_header =
-                            sizeof(message_header) + message_to_send.size;
-                    if (message_to_send.size > MAX_MESSAGE_SIZE)
-                        elog("Trying to send a message larger than MAX_MESSAGE_SIZE. This probably won't work...");
-                    //pad the message we send to a multiple of 16 bytes
-                    size_t size_with_padding =
-                            16 * ((size_of_message_and_header + 15) / 16);
-                    std::unique_ptr<char[]> padded_message(new char[size_with_padding]);
-                    memcpy(padded_message.get(), (char *)&message_to_send, sizeof(message_header));
-                    memcpy(padded_message.get() +
-                           sizeof(message_header), message_to_send.data.data(), message_to_send.size);
-                    _sock.write(padded_message.get(), size_with_padding);
+                    // the buffer can be shared with other connections, only the encryption is done per connection
+                    _sock.write(padded_message->data(), padded_message->size());
                     _sock.flush();
-                    _bytes_sent += size_with_padding;
+                    _bytes_sent += padded_message->size();
                     _last_message_sent_time = fc::time_point::now();
                 } FC_RETHROW_EXCEPTIONS(warn, "unable to send message");
             }
@@ -337,8 +362,29 @@ namespace golos {
                 return _sock.get_shared_secret();
             }
 
+            fc::microseconds message_oriented_connection_impl::get_crypto_time() const {
+                VERIFY_CORRECT_THREAD();
+                return _sock.get_crypto_time();
+            }
+
         } // end namespace golos::network::detail
 
+        padded_message_ptr pad_message(const message &message_to_pad) {
+            size_t size_of_message_and_header = sizeof(message_header) + message_to_pad.size;
+            if (message_to_pad.size > MAX_MESSAGE_SIZE)
+                elog("Trying to send a message larger than MAX_MESSAGE_SIZE. This probably won't work...");
+            //pad the message we send to a multiple of 16 bytes
+            size_t size_with_padding = 16 * ((size_of_message_and_header + 15) / 16);
+            auto padded_message = std::make_shared<std::vector<char>>(size_with_padding);
+            memcpy(padded_message->data(), (const char *)&message_to_pad, sizeof(message_header));
+            memcpy(padded_message->data() + sizeof(message_header), message_to_pad.data.data(), message_to_pad.size);
+            return padded_message;
+        }
+
+        const message_header &get_padded_message_header(const padded_message_ptr &padded_message) {
+            return *reinterpret_cast<const message_header *>(padded_message->data());
+        }
+
 
         message_oriented_connection::message_oriented_connection(message_oriented_connection_delegate *delegate)
                 :
@@ -365,7 +411,11 @@ namespace golos {
         }
 
         void message_oriented_connection::send_message(const message &message_to_send) {
-            my->send_message(message_to_send);
+            my->send_padded_message(pad_message(message_to_send));
+        }
+
+        void message_oriented_connection::send_padded_message(const padded_message_ptr &padded_message) {
+            my->send_padded_message(padded_message);
         }
 
         void message_oriented_connection::close_connection() {
@@ -400,5 +450,9 @@ namespace golos {
             return my->get_shared_secret();
         }
 
+        fc::microseconds message_oriented_connection::get_crypto_time() const {
+            return my->get_crypto_time();
+        }
+
     }
 } // end namespace golos::network
@@ -129,6 +129,10 @@ namespace golos {
                     message_propagation_data propagation_data;
                     fc::uint160_t message_contents_hash; // hash of whatever the message contains (if it's a transaction, this is the transaction id, if it's a block, it's the block_id)
 
+                    // serialized on the first request and shared by all peers
+                    mutable padded_message_ptr padded_message_body;
+                    mutable padded_message_ptr padded_compact_block;
+
                     message_info(const message_hash_type &message_hash,
                             const message &message_body,
                             uint32_t block_clock_when_received,
@@ -168,6 +172,11 @@ namespace golos {
 
                 message get_message(const message_hash_type &hash_of_message_to_lookup);
 
+                // Returns the message ready for sending, blocks can be requested in the compact form
+                padded_message_ptr get_padded_message(const message_hash_type &hash_of_message_to_lookup, bool compact_block = false);
+
+                fc::uint160_t get_message_contents_hash(const message_hash_type &hash_of_message_to_lookup) const;
+
                 message_propagation_data get_message_propagation_data(const fc::uint160_t &hash_of_message_contents_to_lookup) const;
 
                 size_t size() const {
@@ -204,6 +213,36 @@ namespace golos {
                 FC_THROW_EXCEPTION(fc::key_not_found_exception, "Requested message not in cache");
             }
 
+            padded_message_ptr blockchain_tied_message_cache::get_padded_message(
+                    const message_hash_type &hash_of_message_to_lookup, bool compact_block) {
+                auto iter = _message_cache.get<message_hash_index>().find(hash_of_message_to_lookup);
+                if (iter == _message_cache.get<message_hash_index>().end()) {
+                    FC_THROW_EXCEPTION(fc::key_not_found_exception, "Requested message not in cache");
+                }
+
+                if (compact_block) {
+                    if (!iter->padded_compact_block) {
+                        iter->padded_compact_block = pad_message(compact_block_message(
+                                iter->message_body.as<block_message>(), hash_of_message_to_lookup));
+                    }
+                    return iter->padded_compact_block;
+                }
+
+                if (!iter->padded_message_body) {
+                    iter->padded_message_body = pad_message(iter->message_body);
+                }
+                return iter->padded_message_body;
+            }
+
+            fc::uint160_t blockchain_tied_message_cache::get_message_contents_hash(
+                    const message_hash_type &hash_of_message_to_lookup) const {
+                auto iter = _message_cache.get<message_hash_index>().find(hash_of_message_to_lookup);
+                if (iter == _message_cache.get<message_hash_index>().end()) {
+                    FC_THROW_EXCEPTION(fc::key_not_found_exception, "Requested message not in cache");
+                }
+                return iter->message_contents_hash;
+            }
+
             message_propagation_data blockchain_tied_message_cache::get_message_propagation_data(const fc::uint160_t &hash_of_message_contents_to_lookup) const {
                 if (hash_of_message_contents_to_lookup != fc::uint160_t()) {
                     message_cache_container::index<message_contents_hash_index>::type::const_iterator iter =
@@ -274,6 +313,18 @@ namespace golos {
                 }
             };
 
+            void accumulate_message_statistics(std::map<uint32_t, message_type_statistics> &totals,
+                    const message_type_statistics &statistics, uint32_t msg_type) {
+                auto &total = totals[msg_type];
+                total.message_type = statistics.message_type;
+                total.messages_received += statistics.messages_received;
+                total.bytes_received += statistics.bytes_received;
+                total.handling_time += statistics.handling_time;
+                total.messages_sent += statistics.messages_sent;
+                total.bytes_sent += statistics.bytes_sent;
+                total.queue_time += statistics.queue_time;
+            }
+
 /////////////////////////////////////////////////////////////////////////////////////////////////////////
             class statistics_gathering_node_delegate_wrapper
                     : public node_delegate {
@@ -292,6 +343,7 @@ namespace golos {
                                    (handle_transaction) \
                                    (get_block_ids) \
                                    (get_item) \
+                                   (get_block_range) \
                                    (get_blockchain_synopsis) \
                                    (sync_status) \
                                    (connection_count_changed) \
@@ -399,6 +451,9 @@ namespace golos {
 
                 message get_item(const item_id &id) override;
 
+                std::vector<message> get_block_range(const item_hash_t &last_block_id,
+                        uint32_t first_block_num, uint32_t count) override;
+
                 std::vector<item_hash_t> get_blockchain_synopsis(const item_hash_t &reference_point,
                         uint32_t number_of_blocks_after_reference_point) override;
 
@@ -463,8 +518,25 @@ namespace golos {
                 typedef std::unordered_map<golos::network::block_id_type, fc::time_point> active_sync_requests_map;
 
                 active_sync_requests_map _active_sync_requests; /// list of sync blocks we've asked for from peers but have not yet received
-                std::list<golos::network::block_message> _new_received_sync_items; /// list of sync blocks we've just received but haven't yet tried to process
-                std::list<golos::network::block_message> _received_sync_items; /// list of sync blocks we've received, but can't yet process because we are still missing blocks that come earlier in the chain
+
+                struct sync_item_id_index {
+                };
+                struct sync_item_num_index {
+                };
+                struct sync_item_block_num {
+                    typedef uint32_t result_type;
+
+                    result_type operator()(const golos::network::block_message &item) const {
+                        return item.block.block_num();
+                    }
+                };
+                typedef boost::multi_index_container<golos::network::block_message,
+                        bmi::indexed_by<bmi::hashed_unique<bmi::tag<sync_item_id_index>,
+                                bmi::member<golos::network::block_message, block_id_type, &golos::network::block_message::block_id>,
+                                std::hash<block_id_type>>,
+                                bmi::ordered_non_unique<bmi::tag<sync_item_num_index>, sync_item_block_num>>
+                > received_sync_items_set_type;
+                received_sync_items_set_type _received_sync_items; /// sync blocks we've received, but can't yet process because we are still missing blocks that come earlier in the chain
                 // @}
 
                 fc::future<void> _process_backlog_of_sync_blocks_done;
@@ -567,6 +639,11 @@ namespace golos {
 
                 fc::future<void> _dump_node_status_task_done;
 
+                // traffic of closed connections, the traffic of active ones is kept in peer_connection
+                std::map<uint32_t, message_type_statistics> _closed_connections_message_statistics;
+                fc::microseconds _closed_connections_crypto_time;
+                block_propagation_statistics _block_propagation_statistics;
+
                 /* We have two alternate paths through the schedule_peer_for_deletion code -- one that
        * uses a mutex to prevent one fiber from adding items to the queue while another is deleting
        * items from it, and one that doesn't.  The one that doesn't is simpler and more efficient
@@ -607,12 +684,19 @@ namespace golos {
 
                 bool have_already_received_sync_item(const item_hash_t &item_hash);
 
+                // the block is in the backlog, is being pushed or is already in the blockchain
+                bool is_sync_item_received(const item_hash_t &item_hash);
+
                 void request_sync_item_from_peer(const peer_connection_ptr &peer, const item_hash_t &item_to_request);
 
                 void request_sync_items_from_peer(const peer_connection_ptr &peer, const std::vector<item_hash_t> &items_to_request);
 
                 void fetch_sync_items_loop();
 
+                void update_sync_window(peer_connection *peer);
+
+                void update_block_propagation_statistics(const fc::microseconds &delay);
+
                 void trigger_fetch_sync_items_loop();
 
                 bool is_item_in_any_peers_inventory(const item_id &item) const;
@@ -686,6 +770,9 @@ namespace golos {
                 void on_fetch_items_message(peer_connection *originating_peer,
                         const fetch_items_message &fetch_items_message_received);
 
+                void on_fetch_block_range_message(peer_connection *originating_peer,
+                        const fetch_block_range_message &fetch_block_range_message_received);
+
                 void on_item_not_available_message(peer_connection *originating_peer,
                         const item_not_available_message &item_not_available_message_received);
 
@@ -695,6 +782,20 @@ namespace golos {
                 void on_closing_connection_message(peer_connection *originating_peer,
                         const closing_connection_message &closing_connection_message_received);
 
+                void on_compact_block_message(peer_connection *originating_peer,
+                        const compact_block_message &compact_block_message_received);
+
+                void on_get_compact_block_transactions_message(peer_connection *originating_peer,
+                        const get_compact_block_transactions_message &get_compact_block_transactions_message_received);
+
+                void on_compact_block_transactions_message(peer_connection *originating_peer,
+                        const compact_block_transactions_message &compact_block_transactions_message_received);
+
+                void process_compact_block(peer_connection *originating_peer, const signed_block &block, const message_hash_type &message_hash);
+
+                // Drops compact blocks, which wait for transactions, when the block is accepted from elsewhere
+                void forget_partial_blocks(const block_id_type &block_id);
+
                 void on_current_time_request_message(peer_connection *originating_peer,
                         const current_time_request_message &current_time_request_message_received);
 
@@ -827,10 +928,15 @@ namespace golos {
 
                 message get_message_for_item(const item_id &item) override;
 
+                padded_message_ptr get_messages_for_block_range(const item_hash_t &last_block_id,
+                        uint32_t first_block_num, uint32_t count) override;
+
                 fc::variant_object network_get_info() const;
 
                 fc::variant_object network_get_usage_stats() const;
 
+                network_statistics get_network_statistics() const;
+
                 bool is_hard_fork_block(uint32_t block_number) const;
 
                 uint32_t get_next_known_hard_fork_block_number(uint32_t block_number) const;
@@ -1056,14 +1162,21 @@ namespace golos {
 
             bool node_impl::have_already_received_sync_item(const item_hash_t &item_hash) {
                 VERIFY_CORRECT_THREAD();
-                return std::find_if(_received_sync_items.begin(), _received_sync_items.end(),
-                        [&item_hash](const golos::network::block_message &message) {
-                            return message.block_id == item_hash;
-                        }) != _received_sync_items.end() ||
-                       std::find_if(_new_received_sync_items.begin(), _new_received_sync_items.end(),
-                               [&item_hash](const golos::network::block_message &message) {
-                                   return message.block_id == item_hash;
-                               }) != _new_received_sync_items.end();;
+                const auto &received_by_id = _received_sync_items.get<sync_item_id_index>();
+                return received_by_id.find(item_hash) != received_by_id.end();
+            }
+
+            bool node_impl::is_sync_item_received(const item_hash_t &item_hash) {
+                VERIFY_CORRECT_THREAD();
+                if (have_already_received_sync_item(item_hash)) {
+                    return true;
+                }
+                for (const peer_connection_ptr &peer : _active_connections) {
+                    if (peer->ids_of_items_being_processed.find(item_hash) != peer->ids_of_items_being_processed.end()) {
+                        return true;
+                    }
+                }
+                return _delegate->has_item(item_id(golos::network::block_message_type, item_hash));
             }
 
             void node_impl::request_sync_item_from_peer(const peer_connection_ptr &peer, const item_hash_t &item_to_request) {
@@ -1082,12 +1195,32 @@ namespace golos {
                 VERIFY_CORRECT_THREAD();
                 dlog("requesting ${item_count} item(s) ${items_to_request} from peer ${endpoint}",
                         ("item_count", items_to_request.size())("items_to_request", items_to_request)("endpoint", peer->get_remote_endpoint()));
+                fc::time_point now = fc::time_point::now();
                 for (const item_hash_t &item_to_request : items_to_request) {
-                    _active_sync_requests.insert(active_sync_requests_map::value_type(item_to_request, fc::time_point::now()));
-                    peer->last_sync_item_received_time = fc::time_point::now();
+                    // the item can be requested again from another peer, if the first one stalls
+                    _active_sync_requests[item_to_request] = now;
+                    peer->last_sync_item_received_time = now;
                     peer->sync_items_requested_from_peer.insert(item_to_request);
                 }
-                peer->send_message(fetch_items_message(golos::network::block_message_type, items_to_request));
+                peer->sync_batch_request_time = now;
+                peer->sync_batch_size = items_to_request.size();
+                peer->sync_batch_bytes = 0;
+
+                // blocks of the batch usually go one after another, so the peer can read them from its block log at once
+                bool is_block_range = peer->supports_block_ranges && items_to_request.size() > 1;
+                for (size_t i = 1; is_block_range && i < items_to_request.size(); ++i) {
+                    is_block_range = _delegate->get_block_number(items_to_request[i]) ==
+                                     _delegate->get_block_number(items_to_request[i - 1]) + 1;
+                }
+                if (is_block_range) {
+                    // the sync window is configurable, but the size of a range is limited by the protocol
+                    for (size_t first = 0; first < items_to_request.size(); first += GRAPHENE_NET_MAX_BLOCK_RANGE_SIZE) {
+                        size_t last = std::min<size_t>(first + GRAPHENE_NET_MAX_BLOCK_RANGE_SIZE, items_to_request.size()) - 1;
+                        peer->send_message(fetch_block_range_message(items_to_request[first], items_to_request[last]));
+                    }
+                } else {
+                    peer->send_message(fetch_items_message(golos::network::block_message_type, items_to_request));
+                }
             }
 
             void node_impl::fetch_sync_items_loop() {
@@ -1102,6 +1235,8 @@ namespace golos {
                         {
                             ASSERT_TASK_NOT_PREEMPTED();
                             std::set<item_hash_t> sync_items_to_request;
+                            fc::time_point stalled_request_threshold = fc::time_point::now() -
+                                    fc::milliseconds(GRAPHENE_NET_STALLED_SYNC_REQUEST_TIMEOUT_MS);
 
                             // for each idle peer that we're syncing with
                             for (const peer_connection_ptr &peer : _active_connections) {
@@ -1115,20 +1250,27 @@ namespace golos {
                                         for (unsigned i = 0; i <
                                                              peer->ids_of_items_to_get.size(); ++i) {
                                             item_hash_t item_to_potentially_request = peer->ids_of_items_to_get[i];
+                                            auto active_request_iter = _active_sync_requests.find(item_to_potentially_request);
                                             // if we don't already have this item in our temporary storage and we haven't requested from another syncing peer
                                             if (!have_already_received_sync_item(item_to_potentially_request) &&
                                                 // already got it, but for some reson it's still in our list of items to fetch
                                                 sync_items_to_request.find(item_to_potentially_request) ==
                                                 sync_items_to_request.end() &&
                                                 // we have already decided to request it from another peer during this iteration
-                                                _active_sync_requests.find(item_to_potentially_request) ==
-                                                _active_sync_requests.end()) // we've requested it in a previous iteration and we're still waiting for it to arrive
+                                                (active_request_iter == _active_sync_requests.end() ||
+                                                 // we've requested it in a previous iteration and we're still waiting for it to arrive,
+                                                 // but the peer stalls, so this peer (which is idle, so it is faster) can deliver it earlier
+                                                 active_request_iter->second < stalled_request_threshold))
                                             {
+                                                if (active_request_iter != _active_sync_requests.end()) {
+                                                    dlog("requesting stalled sync item ${item} again from peer ${endpoint}",
+                                                            ("item", item_to_potentially_request)("endpoint", peer->get_remote_endpoint()));
+                                                }
                                                 // then schedule a request from this peer
                                                 sync_item_requests_to_send[peer].push_back(item_to_potentially_request);
                                                 sync_items_to_request.insert(item_to_potentially_request);
                                                 if (sync_item_requests_to_send[peer].size() >=
-                                                    _maximum_blocks_per_peer_during_syncing) {
+                                                    peer->sync_window) {
                                                         break;
                                                 }
                                             }
@@ -1149,12 +1291,65 @@ namespace golos {
                     if (!_sync_items_to_fetch_updated) {
                         dlog("no sync items to fetch right now, going to sleep");
                         _retrigger_fetch_sync_items_loop_promise = fc::promise<void>::ptr(new fc::promise<void>("golos::network::retrigger_fetch_sync_items_loop"));
-                        _retrigger_fetch_sync_items_loop_promise->wait();
+                        try {
+                            if (_active_sync_requests.empty()) {
+                                _retrigger_fetch_sync_items_loop_promise->wait();
+                            } else {
+                                // wake up to look for stalled requests
+                                _retrigger_fetch_sync_items_loop_promise->wait(
+                                        fc::milliseconds(GRAPHENE_NET_STALLED_SYNC_REQUEST_TIMEOUT_MS));
+                            }
+                        }
+                        catch (const fc::timeout_exception &) {
+                            dlog("Resuming fetch_sync_items_loop due to timeout -- checking for stalled requests");
+                        }
                         _retrigger_fetch_sync_items_loop_promise.reset();
                     }
                 } // while( !canceled )
             }
 
+            void node_impl::update_sync_window(peer_connection *peer) {
+                VERIFY_CORRECT_THREAD();
+                int64_t elapsed_us = std::max<int64_t>((fc::time_point::now() - peer->sync_batch_request_time).count(), 1000);
+                uint64_t blocks_per_second = uint64_t(peer->sync_batch_size) * 1000000 / elapsed_us;
+                uint64_t bytes_per_second = peer->sync_batch_bytes * 1000000 / elapsed_us;
+
+                if (peer->sync_blocks_per_second == 0) {
+                    peer->sync_blocks_per_second = blocks_per_second;
+                    peer->sync_bytes_per_second = bytes_per_second;
+                } else {
+                    peer->sync_blocks_per_second = (peer->sync_blocks_per_second * 3 + blocks_per_second) / 4;
+                    peer->sync_bytes_per_second = (peer->sync_bytes_per_second * 3 + bytes_per_second) / 4;
+                }
+
+                int64_t batch_duration_us = std::max<int64_t>(
+                        fc::milliseconds(GRAPHENE_NET_SYNC_BATCH_DURATION_MS).count(),
+                        peer->round_trip_delay.count() * 10);
+                uint64_t window = peer->sync_blocks_per_second * batch_duration_us / 1000000;
+                peer->sync_window = (uint32_t)std::min<uint64_t>(
+                        std::max<uint64_t>(window, GRAPHENE_NET_MIN_BLOCKS_PER_PEER_DURING_SYNCING),
+                        _maximum_blocks_per_peer_during_syncing);
+
+                dlog("peer ${endpoint} delivered ${count} sync blocks (${bytes} bytes) in ${ms} ms, next window is ${window} blocks",
+                        ("endpoint", peer->get_remote_endpoint())("count", peer->sync_batch_size)
+                                ("bytes", peer->sync_batch_bytes)("ms", elapsed_us / 1000)("window", peer->sync_window));
+            }
+
+            void node_impl::update_block_propagation_statistics(const fc::microseconds &delay) {
+                VERIFY_CORRECT_THREAD();
+                auto &statistics = _block_propagation_statistics;
+                int64_t delay_ms = delay.count() / 1000;
+
+                statistics.last_delay = delay_ms;
+                statistics.max_delay = std::max(statistics.max_delay, delay_ms);
+                if (statistics.blocks == 0) {
+                    statistics.average_delay = delay_ms;
+                } else {
+                    statistics.average_delay = (statistics.average_delay * 3 + delay_ms) / 4;
+                }
+                ++statistics.blocks;
+            }
+
             void node_impl::trigger_fetch_sync_items_loop() {
                 VERIFY_CORRECT_THREAD();
                 dlog("Triggering fetch sync items loop now");
@@ -1888,6 +2083,15 @@ namespace golos {
                         ("type", golos::network::core_message_type_enum(received_message.msg_type))("hash", message_hash)
                                 ("size", received_message.size)
                                 ("endpoint", originating_peer->get_remote_endpoint()));
+
+                // handlers can yield and the connection can be closed meanwhile, which moves its statistics
+                //   to the node totals, so the statistics of the message are accumulated after handling
+                peer_connection_ptr originating_peer_ptr = originating_peer->shared_from_this();
+                fc::time_point handling_start_time = fc::time_point::now();
+                message_type_statistics statistics;
+                statistics.messages_received = 1;
+                statistics.bytes_received = sizeof(message_header) + received_message.size;
+
                 switch (received_message.msg_type) {
                     case core_message_type_enum::hello_message_type:
                         on_hello_message(originating_peer, received_message.as<hello_message>());
@@ -1913,6 +2117,9 @@ namespace golos {
                     case core_message_type_enum::fetch_items_message_type:
                         on_fetch_items_message(originating_peer, received_message.as<fetch_items_message>());
                         break;
+                    case core_message_type_enum::fetch_block_range_message_type:
+                        on_fetch_block_range_message(originating_peer, received_message.as<fetch_block_range_message>());
+                        break;
                     case core_message_type_enum::item_not_available_message_type:
                         on_item_not_available_message(originating_peer, received_message.as<item_not_available_message>());
                         break;
@@ -1943,6 +2150,15 @@ namespace golos {
                     case core_message_type_enum::get_current_connections_reply_message_type:
                         on_get_current_connections_reply_message(originating_peer, received_message.as<get_current_connections_reply_message>());
                         break;
+                    case core_message_type_enum::compact_block_message_type:
+                        on_compact_block_message(originating_peer, received_message.as<compact_block_message>());
+                        break;
+                    case core_message_type_enum::get_compact_block_transactions_message_type:
+                        on_get_compact_block_transactions_message(originating_peer, received_message.as<get_compact_block_transactions_message>());
+                        break;
+                    case core_message_type_enum::compact_block_transactions_message_type:
+                        on_compact_block_transactions_message(originating_peer, received_message.as<compact_block_transactions_message>());
+                        break;
 
                     default:
                         // ignore any message in between core_message_type_first and _last that we don't handle above
@@ -1955,6 +2171,17 @@ namespace golos {
                         }
                         break;
                 }
+
+                statistics.handling_time = (fc::time_point::now() - handling_start_time).count();
+                if (originating_peer->negotiation_status == peer_connection::connection_negotiation_status::closed) {
+                    statistics.message_type = fc::variant(core_message_type_enum(received_message.msg_type)).as_string();
+                    accumulate_message_statistics(_closed_connections_message_statistics, statistics, received_message.msg_type);
+                } else {
+                    auto &peer_statistics = originating_peer->get_message_statistics(received_message.msg_type);
+                    peer_statistics.messages_received += statistics.messages_received;
+                    peer_statistics.bytes_received += statistics.bytes_received;
+                    peer_statistics.handling_time += statistics.handling_time;
+                }
             }
 
 
@@ -1990,6 +2217,8 @@ namespace golos {
                 }
 
                 user_data["chain_id"] = STEEMIT_CHAIN_ID;
+                user_data["compact_blocks"] = true;
+                user_data["block_ranges"] = true;
 
                 return user_data;
             }
@@ -2024,6 +2253,12 @@ namespace golos {
                 if (user_data.contains("chain_id")) {
                     originating_peer->chain_id = user_data["chain_id"].as<golos::protocol::chain_id_type>();
                 }
+                if (user_data.contains("compact_blocks")) {
+                    originating_peer->supports_compact_blocks = user_data["compact_blocks"].as_bool();
+                }
+                if (user_data.contains("block_ranges")) {
+                    originating_peer->supports_block_ranges = user_data["block_ranges"].as_bool();
+                }
             }
 
             void node_impl::on_hello_message(peer_connection *originating_peer, const hello_message &hello_message_received) {
@@ -2827,6 +3062,68 @@ namespace golos {
                 return item_not_available_message(item);
             }
 
+            padded_message_ptr node_impl::get_messages_for_block_range(const item_hash_t &last_block_id, uint32_t first_block_num, uint32_t count) {
+                std::vector<message> blocks;
+                try {
+                    blocks = _delegate->get_block_range(last_block_id, first_block_num, count);
+                }
+                catch (const fc::exception &e) {
+                    wlog("Unable to read blocks ${first}..${last} of ${id}: ${e}",
+                            ("first", first_block_num)("last", first_block_num + count - 1)("id", last_block_id)("e", e));
+                }
+                if (blocks.empty()) {
+                    return pad_message(item_not_available_message(item_id(block_message_type, last_block_id)));
+                }
+
+                size_t total_size = 0;
+                for (const message &block : blocks) {
+                    total_size += 16 * ((sizeof(message_header) + block.size + 15) / 16);
+                }
+                auto padded_messages = std::make_shared<std::vector<char>>(total_size);
+                char *ptr = padded_messages->data();
+                for (const message &block : blocks) {
+                    padded_message_ptr padded_block = pad_message(block);
+                    memcpy(ptr, padded_block->data(), padded_block->size());
+                    ptr += padded_block->size();
+                }
+                return padded_messages;
+            }
+
+            void node_impl::on_fetch_block_range_message(peer_connection *originating_peer, const fetch_block_range_message &fetch_block_range_message_received) {
+                VERIFY_CORRECT_THREAD();
+                const block_id_type &first_block_id = fetch_block_range_message_received.first_block_id;
+                const block_id_type &last_block_id = fetch_block_range_message_received.last_block_id;
+                uint32_t first_block_num = _delegate->get_block_number(first_block_id);
+                uint32_t last_block_num = _delegate->get_block_number(last_block_id);
+                dlog("received request for blocks ${first}..${last} from peer ${endpoint}",
+                        ("first", first_block_num)("last", last_block_num)("endpoint", originating_peer->get_remote_endpoint()));
+
+                if (first_block_num == 0 || last_block_num < first_block_num) {
+                    wlog("Peer ${endpoint} requested invalid range of blocks ${first}..${last}",
+                            ("endpoint", originating_peer->get_remote_endpoint())("first", first_block_num)("last", last_block_num));
+                    disconnect_from_peer(originating_peer, "You requested an invalid range of blocks");
+                    return;
+                }
+
+                // the rest of a too large range isn't sent, the peer requests it again after the timeout
+                if (last_block_num - first_block_num >= GRAPHENE_NET_MAX_BLOCK_RANGE_SIZE) {
+                    wlog("Peer ${endpoint} requested too large range of blocks ${first}..${last}, only ${count} blocks are sent",
+                            ("endpoint", originating_peer->get_remote_endpoint())("first", first_block_num)("last", last_block_num)
+                                    ("count", GRAPHENE_NET_MAX_BLOCK_RANGE_SIZE));
+                    last_block_num = first_block_num + GRAPHENE_NET_MAX_BLOCK_RANGE_SIZE - 1;
+                }
+
+                originating_peer->last_block_delegate_has_seen = last_block_id;
+                originating_peer->last_block_time_delegate_has_seen = _delegate->get_block_time(last_block_id);
+
+                // blocks are read in batches when they reach the front of the send queue,
+                // so the whole range doesn't stay in memory
+                for (uint32_t block_num = first_block_num; block_num <= last_block_num; block_num += GRAPHENE_NET_BLOCK_RANGE_BATCH_SIZE) {
+                    uint32_t count = std::min<uint32_t>(GRAPHENE_NET_BLOCK_RANGE_BATCH_SIZE, last_block_num - block_num + 1);
+                    originating_peer->send_block_range(last_block_id, block_num, count);
+                }
+            }
+
             void node_impl::on_fetch_items_message(peer_connection *originating_peer, const fetch_items_message &fetch_items_message_received) {
                 VERIFY_CORRECT_THREAD();
                 dlog("received items request for ids ${ids} of type ${type} from peer ${endpoint}",
@@ -2834,20 +3131,29 @@ namespace golos {
                                 ("type", fetch_items_message_received.item_type)
                                 ("endpoint", originating_peer->get_remote_endpoint()));
 
-                fc::optional<message> last_block_message_sent;
+                fc::optional<block_id_type> last_block_id_sent;
+
+                // cached items are serialized once and shared by all peers which request them,
+                // blocks from the delegate are fetched again when they reach the front of the send queue
+                struct reply_message {
+                    padded_message_ptr padded_message;
+                    fc::optional<item_id> block_to_send;
+                };
 
-                std::list<message> reply_messages;
+                std::list<reply_message> reply_messages;
                 for (const item_hash_t &item_hash : fetch_items_message_received.items_to_fetch) {
                     try {
-                        message requested_message = _message_cache.get_message(item_hash);
+                        bool is_block = fetch_items_message_received.item_type == block_message_type;
+                        // the block is new, so the peer most likely has already received its transactions
+                        bool send_compact_block = is_block && originating_peer->supports_compact_blocks;
+                        padded_message_ptr requested_message = _message_cache.get_padded_message(item_hash, send_compact_block);
                         dlog("received item request for item ${id} from peer ${endpoint}, returning the item from my message cache",
                                 ("endpoint", originating_peer->get_remote_endpoint())
-                                        ("id", requested_message.id()));
-                        reply_messages.push_back(requested_message);
-                        if (fetch_items_message_received.item_type ==
-                            block_message_type) {
-                                last_block_message_sent = requested_message;
+                                        ("id", item_hash));
+                        if (is_block) {
+                            last_block_id_sent = block_id_type(_message_cache.get_message_contents_hash(item_hash));
                         }
+                        reply_messages.push_back(reply_message{requested_message, fc::optional<item_id>()});
                         continue;
                     }
                     catch (fc::key_not_found_exception &) {
@@ -2861,32 +3167,32 @@ namespace golos {
                                 ("id", requested_message.id())
                                         ("size", requested_message.size)
                                         ("endpoint", originating_peer->get_remote_endpoint()));
-                        reply_messages.push_back(requested_message);
-                        if (fetch_items_message_received.item_type ==
-                            block_message_type) {
-                                last_block_message_sent = requested_message;
+                        if (requested_message.msg_type == block_message_type) {
+                            last_block_id_sent = requested_message.as<golos::network::block_message>().block_id;
+                            reply_messages.push_back(reply_message{padded_message_ptr(), item_id(block_message_type, *last_block_id_sent)});
+                        } else {
+                            reply_messages.push_back(reply_message{pad_message(requested_message), fc::optional<item_id>()});
                         }
                         continue;
                     }
                     catch (fc::key_not_found_exception &) {
-                        reply_messages.push_back(item_not_available_message(item_to_fetch));
+                        reply_messages.push_back(reply_message{pad_message(item_not_available_message(item_to_fetch)), fc::optional<item_id>()});
                         dlog("received item request from peer ${endpoint} but we don't have it",
                                 ("endpoint", originating_peer->get_remote_endpoint()));
                     }
                 }
 
                 // if we sent them a block, update our record of the last block they've seen accordingly
-                if (last_block_message_sent) {
-                    golos::network::block_message block = last_block_message_sent->as<golos::network::block_message>();
-                    originating_peer->last_block_delegate_has_seen = block.block_id;
-                    originating_peer->last_block_time_delegate_has_seen = _delegate->get_block_time(block.block_id);
+                if (last_block_id_sent) {
+                    originating_peer->last_block_delegate_has_seen = *last_block_id_sent;
+                    originating_peer->last_block_time_delegate_has_seen = _delegate->get_block_time(*last_block_id_sent);
                 }
 
-                for (const message &reply : reply_messages) {
-                    if (reply.msg_type == block_message_type) {
-                        originating_peer->send_item(item_id(block_message_type, reply.as<golos::network::block_message>().block_id));
+                for (const reply_message &reply : reply_messages) {
+                    if (reply.block_to_send) {
+                        originating_peer->send_item(*reply.block_to_send);
                     } else {
-                        originating_peer->send_message(reply);
+                        originating_peer->send_padded_message(reply.padded_message);
                     }
                 }
             }
@@ -2894,6 +3200,28 @@ namespace golos {
             void node_impl::on_item_not_available_message(peer_connection *originating_peer, const item_not_available_message &item_not_available_message_received) {
                 VERIFY_CORRECT_THREAD();
                 const item_id &requested_item = item_not_available_message_received.requested_item;
+
+                // The answer to get_compact_block_transactions, it's checked first, because a sync block has the same id
+                if (requested_item.item_type == block_message_type) {
+                    auto partial_block = originating_peer->partial_blocks_from_peer.take(requested_item.item_hash);
+                    if (partial_block.valid()) {
+                        wlog("Peer doesn't have transactions of the compact block it sent us.");
+                        if (originating_peer->sync_items_requested_from_peer.erase(requested_item.item_hash)) {
+                            // the sync loop requests the block again, blocks out of the message cache are sent in full
+                            _active_sync_requests.erase(requested_item.item_hash);
+                            if (originating_peer->sync_items_requested_from_peer.empty()) {
+                                update_sync_window(originating_peer);
+                            }
+                            trigger_fetch_sync_items_loop();
+                        } else {
+                            // the peer can't send us transactions of the compact block, fetch the whole block again
+                            item_id block_item(block_message_type, partial_block->message_hash);
+                            on_item_not_available_message(originating_peer, item_not_available_message(block_item));
+                        }
+                        return;
+                    }
+                }
+
                 auto regular_item_iter = originating_peer->items_requested_from_peer.find(requested_item);
                 if (regular_item_iter !=
                     originating_peer->items_requested_from_peer.end()) {
@@ -3050,6 +3378,12 @@ namespace golos {
                     }
                 }
 
+                for (const auto &statistics : originating_peer->message_statistics) {
+                    accumulate_message_statistics(_closed_connections_message_statistics, statistics.second, statistics.first);
+                }
+                originating_peer->message_statistics.clear();
+                _closed_connections_crypto_time += originating_peer->get_crypto_time();
+
                 _closing_connections.erase(originating_peer_ptr);
                 _handshaking_connections.erase(originating_peer_ptr);
                 _terminating_connections.erase(originating_peer_ptr);
@@ -3132,6 +3466,7 @@ namespace golos {
                             ("num", block_message_to_send.block.block_num())
                                     ("id", block_message_to_send.block_id));
                     _most_recent_blocks_accepted.push_back(block_message_to_send.block_id);
+                    forget_partial_blocks(block_message_to_send.block_id);
 
                     client_accepted_block = true;
                 }
@@ -3330,55 +3665,69 @@ namespace golos {
                 std::set<peer_connection_ptr> peers_we_need_to_sync_to;
                 std::map<peer_connection_ptr, fc::oexception> peers_with_rejected_block;
 
+                auto &received_by_id = _received_sync_items.get<sync_item_id_index>();
+
                 do {
-                    std::copy(std::make_move_iterator(_new_received_sync_items.begin()),
-                            std::make_move_iterator(_new_received_sync_items.end()),
-                            std::front_inserter(_received_sync_items));
-                    _new_received_sync_items.clear();
-                    dlog("currently ${count} sync items to consider", ("count", _received_sync_items.size()));
+                    if (!_received_sync_items.empty()) {
+                        const auto &received_by_num = _received_sync_items.get<sync_item_num_index>();
+                        dlog("currently ${count} sync items to consider, blocks from ${first} to ${last}",
+                                ("count", _received_sync_items.size())
+                                        ("first", received_by_num.begin()->block.block_num())
+                                        ("last", received_by_num.rbegin()->block.block_num()));
+                    }
 
                     block_processed_this_iteration = false;
-                    for (auto received_block_iter = _received_sync_items.begin();
-                         received_block_iter != _received_sync_items.end();
-                         ++received_block_iter) {
 
-                        // find out if this block is the next block on the active chain or one of the forks
-                        bool potential_first_block = false;
-                        for (const peer_connection_ptr &peer : _active_connections) {
-                            ASSERT_TASK_NOT_PREEMPTED(); // don't yield while iterating over _active_connections
-                            if (!peer->ids_of_items_to_get.empty() &&
-                                peer->ids_of_items_to_get.front() ==
-                                received_block_iter->block_id) {
-                                potential_first_block = true;
-                                peer->ids_of_items_to_get.pop_front();
-                                peer->ids_of_items_being_processed.insert(received_block_iter->block_id);
+                    // a block can be pushed only if it is the next block some peer told us about, so instead of
+                    // scanning the whole backlog, look up the head of each peer's list of items to get.
+                    // If several peers are on different forks, push the lowest block first
+                    auto next_block_iter = received_by_id.end();
+                    for (const peer_connection_ptr &peer : _active_connections) {
+                        ASSERT_TASK_NOT_PREEMPTED(); // don't yield while iterating over _active_connections
+                        if (!peer->ids_of_items_to_get.empty()) {
+                            auto received_block_iter = received_by_id.find(peer->ids_of_items_to_get.front());
+                            if (received_block_iter != received_by_id.end() &&
+                                (next_block_iter == received_by_id.end() ||
+                                 received_block_iter->block.block_num() < next_block_iter->block.block_num())) {
+                                next_block_iter = received_block_iter;
                             }
                         }
+                    }
 
-                        // if it is, process it, remove it from all sync peers lists
-                        if (potential_first_block) {
-                            // we can get into an interesting situation near the end of synchronization.  We can be in
-                            // sync with one peer who is sending us the last block on the chain via a regular inventory
-                            // message, while at the same time still be synchronizing with a peer who is sending us the
-                            // block through the sync mechanism.  Further, we must request both blocks because
-                            // we don't know they're the same (for the peer in normal operation, it has only told us the
-                            // message id, for the peer in the sync case we only known the block_id).
-                            if (std::find(_most_recent_blocks_accepted.begin(), _most_recent_blocks_accepted.end(),
-                                    received_block_iter->block_id) ==
-                                _most_recent_blocks_accepted.end()) {
-                                golos::network::block_message block_message_to_process = *received_block_iter;
-                                _received_sync_items.erase(received_block_iter);
-                                _handle_message_calls_in_progress.emplace_back(fc::async([this, block_message_to_process]() {
-                                    send_sync_block_to_node_delegate(block_message_to_process);
-                                }, "send_sync_block_to_node_delegate"));
-                                ++blocks_processed;
-                                block_processed_this_iteration = true;
-                            } else
-                                dlog("Already received and accepted this block (presumably through normal inventory mechanism), treating it as accepted");
-
-                            break; // start iterating _received_sync_items from the beginning
-                        } // end if potential_first_block
-                    } // end for each block in _received_sync_items
+                    if (next_block_iter == received_by_id.end()) {
+                        break;
+                    }
+
+                    // it is the next block on the active chain or one of the forks, remove it from all sync peers lists
+                    for (const peer_connection_ptr &peer : _active_connections) {
+                        ASSERT_TASK_NOT_PREEMPTED(); // don't yield while iterating over _active_connections
+                        if (!peer->ids_of_items_to_get.empty() &&
+                            peer->ids_of_items_to_get.front() == next_block_iter->block_id) {
+                            peer->ids_of_items_to_get.pop_front();
+                            peer->ids_of_items_being_processed.insert(next_block_iter->block_id);
+                        }
+                    }
+
+                    // we can get into an interesting situation near the end of synchronization.  We can be in
+                    // sync with one peer who is sending us the last block on the chain via a regular inventory
+                    // message, while at the same time still be synchronizing with a peer who is sending us the
+                    // block through the sync mechanism.  Further, we must request both blocks because
+                    // we don't know they're the same (for the peer in normal operation, it has only told us the
+                    // message id, for the peer in the sync case we only known the block_id).
+                    golos::network::block_message block_message_to_process = *next_block_iter;
+                    received_by_id.erase(next_block_iter);
+                    block_processed_this_iteration = true;
+
+                    if (std::find(_most_recent_blocks_accepted.begin(), _most_recent_blocks_accepted.end(),
+                            block_message_to_process.block_id) ==
+                        _most_recent_blocks_accepted.end()) {
+                        _handle_message_calls_in_progress.emplace_back(fc::async([this, block_message_to_process]() {
+                            send_sync_block_to_node_delegate(block_message_to_process);
+                        }, "send_sync_block_to_node_delegate"));
+                        ++blocks_processed;
+                    } else {
+                        dlog("Already received and accepted this block (presumably through normal inventory mechanism), treating it as accepted");
+                    }
 
                     if (_handle_message_calls_in_progress.size() >=
                         _maximum_number_of_blocks_to_handle_at_one_time) {
@@ -3414,9 +3763,9 @@ namespace golos {
                 VERIFY_CORRECT_THREAD();
                 dlog("received a sync block from peer ${endpoint}", ("endpoint", originating_peer->get_remote_endpoint()));
 
-                // add it to the front of _received_sync_items, then process _received_sync_items to try to
+                // add it to _received_sync_items, then process _received_sync_items to try to
                 // pass as many messages as possible to the client.
-                _new_received_sync_items.push_front(block_message_to_process);
+                _received_sync_items.insert(block_message_to_process);
                 trigger_process_backlog_of_sync_blocks();
             }
 
@@ -3455,6 +3804,8 @@ namespace golos {
                                 ("num", block_message_to_process.block.block_num())
                                         ("id", block_message_to_process.block_id));
                         _most_recent_blocks_accepted.push_back(block_message_to_process.block_id);
+                        forget_partial_blocks(block_message_to_process.block_id);
+                        update_block_propagation_statistics(message_receive_time - block_message_to_process.block.timestamp);
 
                         bool new_transaction_discovered = false;
                         for (const item_hash_t &transaction_message_hash : contained_transaction_message_ids) {
@@ -3600,8 +3951,20 @@ namespace golos {
                         originating_peer->sync_items_requested_from_peer.end()) {
                         originating_peer->sync_items_requested_from_peer.erase(sync_item_iter);
                         originating_peer->last_sync_item_received_time = fc::time_point::now();
-                        _active_sync_requests.erase(block_message_to_process.block_id);
-                        process_block_during_sync(originating_peer, block_message_to_process, message_hash);
+                        originating_peer->sync_batch_bytes += message_to_process.size;
+                        if (originating_peer->sync_items_requested_from_peer.empty()) {
+                            update_sync_window(originating_peer);
+                        }
+
+                        // a stalled request can be sent to several peers, so only the first copy is processed
+                        if (_active_sync_requests.erase(block_message_to_process.block_id) == 0 &&
+                            is_sync_item_received(block_message_to_process.block_id)) {
+                            dlog("sync block ${block_id} from peer ${endpoint} was already received from another peer",
+                                    ("block_id", block_message_to_process.block_id)
+                                            ("endpoint", originating_peer->get_remote_endpoint()));
+                        } else {
+                            process_block_during_sync(originating_peer, block_message_to_process, message_hash);
+                        }
                         if (originating_peer->idle()) {
                             // we have finished fetching a batch of items, so we either need to grab another batch of items
                             // or we need to get another list of item ids.
@@ -3631,6 +3994,156 @@ namespace golos {
                 disconnect_from_peer(originating_peer, "You sent me a block that I didn't ask for", true, detailed_error);
             }
 
+            void node_impl::on_compact_block_message(peer_connection *originating_peer,
+                    const compact_block_message &compact_block_message_received) {
+                VERIFY_CORRECT_THREAD();
+                const auto &block_id = compact_block_message_received.block_id;
+
+                // the compact block is sent instead of the requested block, either during normal operation or sync
+                bool is_requested =
+                    originating_peer->items_requested_from_peer.find(
+                        item_id(block_message_type, compact_block_message_received.block_message_hash)) !=
+                    originating_peer->items_requested_from_peer.end() ||
+                    originating_peer->sync_items_requested_from_peer.find(block_id) !=
+                    originating_peer->sync_items_requested_from_peer.end();
+                if (!is_requested) {
+                    wlog("received a compact block ${block_id} I didn't ask for from peer ${endpoint}, disconnecting from peer",
+                            ("block_id", block_id)("endpoint", originating_peer->get_remote_endpoint()));
+                    disconnect_from_peer(originating_peer, "You sent me a block that I didn't ask for");
+                    return;
+                }
+
+                if (originating_peer->partial_blocks_from_peer.contains(block_id)) {
+                    dlog("received compact block ${block_id} from peer ${endpoint} again, still waiting for its transactions",
+                            ("block_id", block_id)("endpoint", originating_peer->get_remote_endpoint()));
+                    return;
+                }
+
+                // transactions are usually received before the block, so look for them in the message cache
+                auto partial_block = rebuild_compact_block(compact_block_message_received,
+                        [&](const message_hash_type &hash) -> fc::optional<signed_transaction> {
+                    try {
+                        message transaction_message = _message_cache.get_message(hash);
+                        if (transaction_message.msg_type == trx_message_type) {
+                            return transaction_message.as<trx_message>().trx;
+                        }
+                    }
+                    catch (fc::key_not_found_exception &) {
+                    }
+                    return fc::optional<signed_transaction>();
+                });
+
+                dlog("received compact block ${block_id} with ${count} transactions from peer ${endpoint}, ${missing} are missing",
+                        ("block_id", block_id)
+                                ("count", partial_block.block.transactions.size())
+                                ("missing", partial_block.missing_transactions.size())
+                                ("endpoint", originating_peer->get_remote_endpoint()));
+
+                if (partial_block.missing_transactions.empty()) {
+                    process_compact_block(originating_peer, partial_block.block, partial_block.message_hash);
+                    return;
+                }
+
+                get_compact_block_transactions_message request(block_id, partial_block.missing_transactions);
+                // the sync window is configurable and can be larger than the default limit
+                originating_peer->partial_blocks_from_peer.set_max_size(std::max<std::size_t>(
+                        GRAPHENE_NET_MAX_PARTIAL_BLOCKS_PER_PEER, _maximum_blocks_per_peer_during_syncing));
+                if (!originating_peer->partial_blocks_from_peer.insert(block_id, std::move(partial_block))) {
+                    disconnect_from_peer(originating_peer, "You sent me too many compact blocks without their transactions");
+                    return;
+                }
+                originating_peer->send_message(request);
+            }
+
+            void node_impl::forget_partial_blocks(const block_id_type &block_id) {
+                VERIFY_CORRECT_THREAD();
+                bool is_request_completed = false;
+                for (const peer_connection_ptr &peer : _active_connections) {
+                    auto partial_block = peer->partial_blocks_from_peer.take(block_id);
+                    if (!partial_block.valid()) {
+                        continue;
+                    }
+
+                    // the peer can still send the transactions, they will be ignored
+                    dlog("forget compact block ${block_id} from peer ${endpoint}, it was accepted from elsewhere",
+                            ("block_id", block_id)("endpoint", peer->get_remote_endpoint()));
+                    peer->items_requested_from_peer.erase(item_id(block_message_type, partial_block->message_hash));
+                    if (peer->sync_items_requested_from_peer.erase(block_id) &&
+                        peer->sync_items_requested_from_peer.empty()) {
+                        update_sync_window(peer.get());
+                    }
+                    is_request_completed = true;
+                }
+
+                if (is_request_completed) {
+                    trigger_fetch_items_loop();
+                    trigger_fetch_sync_items_loop();
+                }
+            }
+
+            void node_impl::on_get_compact_block_transactions_message(peer_connection *originating_peer,
+                    const get_compact_block_transactions_message &get_compact_block_transactions_message_received) {
+                VERIFY_CORRECT_THREAD();
+                item_id block_item(block_message_type, get_compact_block_transactions_message_received.block_id);
+
+                golos::network::block_message block;
+                try {
+                    block = _delegate->get_item(block_item).as<golos::network::block_message>();
+                }
+                catch (fc::key_not_found_exception &) {
+                    dlog("received request for transactions of compact block ${block_id} from peer ${endpoint} but we don't have it",
+                            ("block_id", block_item.item_hash)("endpoint", originating_peer->get_remote_endpoint()));
+                    originating_peer->send_message(item_not_available_message(block_item));
+                    return;
+                }
+
+                compact_block_transactions_message reply;
+                reply.block_id = get_compact_block_transactions_message_received.block_id;
+                reply.transactions.reserve(get_compact_block_transactions_message_received.indexes.size());
+                for (uint32_t index : get_compact_block_transactions_message_received.indexes) {
+                    if (index >= block.block.transactions.size()) {
+                        disconnect_from_peer(originating_peer, "You requested a transaction which isn't in the block");
+                        return;
+                    }
+                    reply.transactions.push_back(block.block.transactions[index]);
+                }
+                originating_peer->send_message(reply);
+            }
+
+            void node_impl::on_compact_block_transactions_message(peer_connection *originating_peer,
+                    const compact_block_transactions_message &compact_block_transactions_message_received) {
+                VERIFY_CORRECT_THREAD();
+                auto partial_block = originating_peer->partial_blocks_from_peer.take(compact_block_transactions_message_received.block_id);
+                if (!partial_block.valid()) {
+                    dlog("received transactions of compact block ${block_id} I'm not waiting for from peer ${endpoint}",
+                            ("block_id", compact_block_transactions_message_received.block_id)
+                                    ("endpoint", originating_peer->get_remote_endpoint()));
+                    return;
+                }
+
+                if (!partial_block->complete(compact_block_transactions_message_received.transactions)) {
+                    disconnect_from_peer(originating_peer, "You sent me wrong number of transactions for the compact block");
+                    return;
+                }
+
+                process_compact_block(originating_peer, partial_block->block, partial_block->message_hash);
+            }
+
+            void node_impl::process_compact_block(peer_connection *originating_peer,
+                    const signed_block &block, const message_hash_type &message_hash) {
+                VERIFY_CORRECT_THREAD();
+                message block_message_to_process(golos::network::block_message{block});
+                if (block_message_to_process.id() != message_hash) {
+                    // the hash of the block message covers all transactions, so it can't match if the block
+                    // was rebuilt from wrong transactions
+                    wlog("compact block ${block_id} from peer ${endpoint} doesn't match the requested block",
+                            ("block_id", block.id())("endpoint", originating_peer->get_remote_endpoint()));
+                    disconnect_from_peer(originating_peer, "You sent me a compact block which doesn't match the requested block");
+                    return;
+                }
+                process_block_message(originating_peer, block_message_to_process, message_hash);
+            }
+
             void node_impl::on_current_time_request_message(peer_connection *originating_peer,
                     const current_time_request_message &current_time_request_message_received) {
                 VERIFY_CORRECT_THREAD();
@@ -4734,7 +5247,6 @@ namespace golos {
                 ilog("--------- MEMORY USAGE ------------");
                 ilog("node._active_sync_requests size: ${size}", ("size", _active_sync_requests.size()));
                 ilog("node._received_sync_items size: ${size}", ("size", _received_sync_items.size()));
-                ilog("node._new_received_sync_items size: ${size}", ("size", _new_received_sync_items.size()));
                 ilog("node._items_to_fetch size: ${size}", ("size", _items_to_fetch.size()));
                 ilog("node._new_inventory size: ${size}", ("size", _new_inventory.size()));
                 ilog("node._message_cache size: ${size}", ("size", _message_cache.size()));
@@ -4854,6 +5366,9 @@ namespace golos {
                     peer_details["startingheight"] = "";
                     peer_details["banscore"] = "";
                     peer_details["syncnode"] = "";
+                    peer_details["sync_window"] = peer->sync_window;
+                    peer_details["sync_blocks_per_second"] = peer->sync_blocks_per_second;
+                    peer_details["sync_bytes_per_second"] = peer->sync_bytes_per_second;
 
                     if (peer->fc_git_revision_sha) {
                         std::string revision_string = *peer->fc_git_revision_sha;
@@ -4911,6 +5426,7 @@ namespace golos {
                     golos::network::block_message block_message_to_broadcast = item_to_broadcast.as<golos::network::block_message>();
                     hash_of_message_contents = block_message_to_broadcast.block_id; // for debugging
                     _most_recent_blocks_accepted.push_back(block_message_to_broadcast.block_id);
+                    forget_partial_blocks(block_message_to_broadcast.block_id);
                 } else if (item_to_broadcast.msg_type ==
                            golos::network::trx_message_type) {
                     golos::network::trx_message transaction_message_to_broadcast = item_to_broadcast.as<golos::network::trx_message>();
@@ -5097,6 +5613,47 @@ namespace golos {
                 return result;
             }
 
+            network_statistics node_impl::get_network_statistics() const {
+                VERIFY_CORRECT_THREAD();
+                network_statistics result;
+                std::map<uint32_t, message_type_statistics> totals = _closed_connections_message_statistics;
+                fc::microseconds crypto_time = _closed_connections_crypto_time;
+
+                for (const peer_connection_ptr &peer : _active_connections) {
+                    ASSERT_TASK_NOT_PREEMPTED(); // don't yield while iterating over _active_connections
+
+                    peer_statistics peer_result;
+                    fc::optional<fc::ip::endpoint> endpoint = peer->get_remote_endpoint();
+                    if (endpoint) {
+                        peer_result.host = *endpoint;
+                    }
+                    peer_result.connection_time = peer->get_connection_time();
+                    peer_result.bytes_received = peer->get_total_bytes_received();
+                    peer_result.bytes_sent = peer->get_total_bytes_sent();
+                    peer_result.crypto_time = peer->get_crypto_time().count();
+                    peer_result.send_queue_messages = peer->get_send_queue_length();
+                    peer_result.send_queue_bytes = peer->get_send_queue_size();
+
+                    peer_result.messages.reserve(peer->message_statistics.size());
+                    for (const auto &statistics : peer->message_statistics) {
+                        peer_result.messages.push_back(statistics.second);
+                        accumulate_message_statistics(totals, statistics.second, statistics.first);
+                    }
+                    crypto_time += peer->get_crypto_time();
+
+                    result.peers.push_back(std::move(peer_result));
+                }
+
+                result.connections = _active_connections.size();
+                result.crypto_time = crypto_time.count();
+                result.messages.reserve(totals.size());
+                for (auto &statistics : totals) {
+                    result.messages.push_back(std::move(statistics.second));
+                }
+                result.block_propagation = _block_propagation_statistics;
+                return result;
+            }
+
             bool node_impl::is_hard_fork_block(uint32_t block_number) const {
                 return std::binary_search(_hard_fork_block_numbers.begin(), _hard_fork_block_numbers.end(), block_number);
             }
@@ -5231,6 +5788,10 @@ namespace golos {
             INVOKE_IN_IMPL(disable_peer_advertising);
         }
 
+        network_statistics node::get_network_statistics() const {
+            INVOKE_IN_IMPL(get_network_statistics);
+        }
+
         fc::variant_object node::get_call_statistics() const {
             INVOKE_IN_IMPL(get_call_statistics);
         }
@@ -5426,6 +5987,10 @@ namespace golos {
                 INVOKE_AND_COLLECT_STATISTICS(get_item, id);
             }
 
+            std::vector<message> statistics_gathering_node_delegate_wrapper::get_block_range(const item_hash_t &last_block_id, uint32_t first_block_num, uint32_t count) {
+                INVOKE_AND_COLLECT_STATISTICS(get_block_range, last_block_id, first_block_num, count);
+            }
+
             std::vector<item_hash_t> statistics_gathering_node_delegate_wrapper::get_blockchain_synopsis(const item_hash_t &reference_point, uint32_t number_of_blocks_after_reference_point) {
                 INVOKE_AND_COLLECT_STATISTICS(get_blockchain_synopsis, reference_point, number_of_blocks_after_reference_point);
             }
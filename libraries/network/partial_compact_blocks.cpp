@@ -0,0 +1,80 @@
+#include <golos/network/partial_compact_blocks.hpp>
+
+namespace golos {
+    namespace network {
+
+        bool partial_compact_block::complete(const std::vector<signed_transaction> &transactions) {
+            if (transactions.size() != missing_transactions.size()) {
+                return false;
+            }
+
+            for (std::size_t i = 0; i < transactions.size(); ++i) {
+                block.transactions[missing_transactions[i]] = transactions[i];
+            }
+            missing_transactions.clear();
+            return true;
+        }
+
+        partial_compact_block rebuild_compact_block(
+            const compact_block_message &compact_block, const find_transaction_type &find_transaction
+        ) {
+            partial_compact_block result;
+            static_cast<golos::protocol::signed_block_header &>(result.block) = compact_block.header;
+            result.message_hash = compact_block.block_message_hash;
+
+            const auto &hashes = compact_block.transaction_message_hashes;
+            result.block.transactions.resize(hashes.size());
+            for (uint32_t i = 0; i < hashes.size(); ++i) {
+                auto transaction = find_transaction(hashes[i]);
+                if (transaction.valid()) {
+                    result.block.transactions[i] = std::move(*transaction);
+                } else {
+                    result.missing_transactions.push_back(i);
+                }
+            }
+            return result;
+        }
+
+        partial_compact_blocks::partial_compact_blocks(std::size_t max_size)
+                : _max_size(max_size) {
+        }
+
+        bool partial_compact_blocks::insert(const block_id_type &block_id, partial_compact_block block) {
+            if (_blocks.size() >= _max_size) {
+                return false;
+            }
+            return _blocks.emplace(block_id, std::move(block)).second;
+        }
+
+        fc::optional<partial_compact_block> partial_compact_blocks::take(const block_id_type &block_id) {
+            fc::optional<partial_compact_block> result;
+            auto itr = _blocks.find(block_id);
+            if (itr != _blocks.end()) {
+                result = std::move(itr->second);
+                _blocks.erase(itr);
+            }
+            return result;
+        }
+
+        bool partial_compact_blocks::contains(const block_id_type &block_id) const {
+            return _blocks.find(block_id) != _blocks.end();
+        }
+
+        void partial_compact_blocks::set_max_size(std::size_t max_size) {
+            _max_size = max_size;
+        }
+
+        std::size_t partial_compact_blocks::size() const {
+            return _blocks.size();
+        }
+
+        bool partial_compact_blocks::empty() const {
+            return _blocks.empty();
+        }
+
+        void partial_compact_blocks::clear() {
+            _blocks.clear();
+        }
+
+    }
+} // golos::network
@@ -38,7 +38,7 @@
 
 namespace golos {
     namespace network {
-        message peer_connection::real_queued_message::get_message(peer_connection_delegate *) {
+        padded_message_ptr peer_connection::real_queued_message::get_message(peer_connection_delegate *) {
             if (message_send_time_field_offset != (size_t)-1) {
                 // patch the current time into the message.  Since this operates on the packed version of the structure,
                 // it won't work for anything after a variable-length field
@@ -50,21 +50,38 @@ namespace golos {
                        message_send_time_field_offset,
                         packed_current_time.data(), packed_current_time.size());
             }
-            return message_to_send;
+            return pad_message(message_to_send);
         }
 
         size_t peer_connection::real_queued_message::get_size_in_queue() {
             return message_to_send.data.size();
         }
 
-        message peer_connection::virtual_queued_message::get_message(peer_connection_delegate *node) {
-            return node->get_message_for_item(item_to_send);
+        padded_message_ptr peer_connection::shared_queued_message::get_message(peer_connection_delegate *) {
+            return message_to_send;
+        }
+
+        size_t peer_connection::shared_queued_message::get_size_in_queue() {
+            // the buffer is shared, but a slow peer still should be disconnected when it doesn't read its queue
+            return message_to_send->size();
+        }
+
+        padded_message_ptr peer_connection::virtual_queued_message::get_message(peer_connection_delegate *node) {
+            return pad_message(node->get_message_for_item(item_to_send));
         }
 
         size_t peer_connection::virtual_queued_message::get_size_in_queue() {
             return sizeof(item_id);
         }
 
+        padded_message_ptr peer_connection::block_range_queued_message::get_message(peer_connection_delegate *node) {
+            return node->get_messages_for_block_range(last_block_id, first_block_num, count);
+        }
+
+        size_t peer_connection::block_range_queued_message::get_size_in_queue() {
+            return sizeof(item_hash_t) + 2 * sizeof(uint32_t);
+        }
+
         peer_connection::peer_connection(peer_connection_delegate *delegate) :
                 _node(delegate),
                 _message_connection(this),
@@ -80,6 +97,13 @@ namespace golos {
                 peer_needs_sync_items_from_us(true),
                 we_need_sync_items_from_peer(true),
                 inhibit_fetching_sync_blocks(false),
+                sync_window(GRAPHENE_NET_INITIAL_BLOCKS_PER_PEER_DURING_SYNCING),
+                sync_batch_size(0),
+                sync_batch_bytes(0),
+                sync_blocks_per_second(0),
+                sync_bytes_per_second(0),
+                supports_compact_blocks(false),
+                supports_block_ranges(false),
                 transaction_fetching_inhibited_until(fc::time_point::min()),
                 last_known_fork_block_number(0),
                 firewall_check_state(nullptr)
@@ -271,12 +295,12 @@ namespace golos {
 #endif
             while (!_queued_messages.empty()) {
                 _queued_messages.front()->transmission_start_time = fc::time_point::now();
-                message message_to_send = _queued_messages.front()->get_message(_node);
+                padded_message_ptr message_to_send = _queued_messages.front()->get_message(_node);
                 try {
                     //dlog("peer_connection::send_queued_messages_task() calling message_oriented_connection::send_message() "
                     //     "to send message of type ${type} for peer ${endpoint}",
                     //     ("type", message_to_send.msg_type)("endpoint", get_remote_endpoint()));
-                    _message_connection.send_message(message_to_send);
+                    _message_connection.send_padded_message(message_to_send);
                     //dlog("peer_connection::send_queued_messages_task()'s call to message_oriented_connection::send_message() completed normally for peer ${endpoint}",
                     //     ("endpoint", get_remote_endpoint()));
                 }
@@ -301,6 +325,24 @@ namespace golos {
                     elog("message_oriented_exception::send_message() threw an unhandled exception");
                 }
                 _queued_messages.front()->transmission_finish_time = fc::time_point::now();
+
+                // sending yields, if the connection was closed meanwhile, its statistics are already moved to the node
+                if (negotiation_status != connection_negotiation_status::closed) {
+                    const message_header &header_sent = get_padded_message_header(message_to_send);
+                    get_message_statistics(header_sent.msg_type).queue_time +=
+                            (_queued_messages.front()->transmission_start_time -
+                             _queued_messages.front()->enqueue_time).count();
+
+                    // a batch of blocks is sent as several messages in one buffer
+                    for (size_t pos = 0; pos < message_to_send->size();) {
+                        const message_header &header = *reinterpret_cast<const message_header *>(message_to_send->data() + pos);
+                        auto &statistics = get_message_statistics(header.msg_type);
+                        ++statistics.messages_sent;
+                        statistics.bytes_sent += sizeof(message_header) + header.size;
+                        pos += 16 * ((sizeof(message_header) + header.size + 15) / 16);
+                    }
+                }
+
                 _total_queued_messages_size -= _queued_messages.front()->get_size_in_queue();
                 _queued_messages.pop();
             }
@@ -345,6 +387,18 @@ namespace golos {
             send_queueable_message(std::move(message_to_enqueue));
         }
 
+        void peer_connection::send_padded_message(const padded_message_ptr &message_to_send) {
+            VERIFY_CORRECT_THREAD();
+            std::unique_ptr<queued_message> message_to_enqueue(new shared_queued_message(message_to_send));
+            send_queueable_message(std::move(message_to_enqueue));
+        }
+
+        void peer_connection::send_block_range(const item_hash_t &last_block_id, uint32_t first_block_num, uint32_t count) {
+            VERIFY_CORRECT_THREAD();
+            std::unique_ptr<queued_message> message_to_enqueue(new block_range_queued_message(last_block_id, first_block_num, count));
+            send_queueable_message(std::move(message_to_enqueue));
+        }
+
         void peer_connection::send_item(const item_id &item_to_send) {
             VERIFY_CORRECT_THREAD();
             //dlog("peer_connection::send_item() enqueueing message of type ${type} for peer ${endpoint}",
@@ -425,6 +479,31 @@ namespace golos {
             return _message_connection.get_shared_secret();
         }
 
+        fc::microseconds peer_connection::get_crypto_time() const {
+            VERIFY_CORRECT_THREAD();
+            return _message_connection.get_crypto_time();
+        }
+
+        size_t peer_connection::get_send_queue_length() const {
+            VERIFY_CORRECT_THREAD();
+            return _queued_messages.size();
+        }
+
+        size_t peer_connection::get_send_queue_size() const {
+            VERIFY_CORRECT_THREAD();
+            return _total_queued_messages_size;
+        }
+
+        message_type_statistics &peer_connection::get_message_statistics(uint32_t msg_type) {
+            VERIFY_CORRECT_THREAD();
+            auto itr = message_statistics.find(msg_type);
+            if (itr == message_statistics.end()) {
+                itr = message_statistics.emplace(msg_type, message_type_statistics()).first;
+                itr->second.message_type = fc::variant(core_message_type_enum(msg_type)).as_string();
+            }
+            return itr->second;
+        }
+
         void peer_connection::clear_old_inventory() {
             VERIFY_CORRECT_THREAD();
             fc::time_point_sec oldest_inventory_to_keep(fc::time_point::now() -
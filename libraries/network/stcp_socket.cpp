@@ -30,6 +30,7 @@
 #include <fc/network/ip.hpp>
 
 #include <golos/network/stcp_socket.hpp>
+#include <golos/network/config.hpp>
 
 namespace golos {
     namespace network {
@@ -104,7 +105,7 @@ namespace golos {
                 } buffer_in_use_checker(_read_buffer_in_use);
 #endif
 
-                const size_t read_buffer_length = 4096;
+                const size_t read_buffer_length = GRAPHENE_NET_READ_BUFFER_SIZE;
                 if (!_read_buffer) {
                     _read_buffer.reset(new char[read_buffer_length], [](char *p) { delete[] p; });
                 }
@@ -116,7 +117,9 @@ namespace golos {
                     _sock.read(_read_buffer, 16 - (s % 16), s);
                     s += 16 - (s % 16);
                 }
+                auto decode_start_time = fc::time_point::now();
                 _recv_aes.decode(_read_buffer.get(), s, buffer);
+                _crypto_time += fc::time_point::now() - decode_start_time;
                 return s;
             } FC_RETHROW_EXCEPTIONS(warn, "", ("len", len))
         }
@@ -165,7 +168,9 @@ namespace golos {
                  * for now because we are going to upgrade to something
                  * better.
                  */
+                auto encode_start_time = fc::time_point::now();
                 uint32_t ciphertext_len = _send_aes.encode(buffer, len, _write_buffer.get());
+                _crypto_time += fc::time_point::now() - encode_start_time;
                 assert(ciphertext_len == len);
                 _sock.write(_write_buffer, ciphertext_len);
                 return ciphertext_len;
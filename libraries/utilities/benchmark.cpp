@@ -0,0 +1,56 @@
+#include <graphene/utilities/benchmark.hpp>
+#include <graphene/utilities/tempdir.hpp>
+
+#include <fc/exception/exception.hpp>
+#include <fc/io/json.hpp>
+
+#include <iostream>
+
+namespace golos {
+    namespace utilities {
+
+        namespace bpo = boost::program_options;
+
+        int benchmark_main(
+            int argc, char **argv,
+            bpo::options_description &options,
+            const benchmark_runner &runner
+        ) {
+            try {
+                std::string data_dir;
+
+                options.add_options()
+                    ("data-dir", bpo::value<std::string>(&data_dir),
+                        "Directory for the data of the benchmark (a temporary directory by default)")
+                    ("help,h", "Print this help message and exit.");
+
+                bpo::variables_map vm;
+                bpo::store(bpo::parse_command_line(argc, argv, options), vm);
+                bpo::notify(vm);
+
+                if (vm.count("help")) {
+                    std::cout << options << std::endl;
+                    return 0;
+                }
+
+                fc::variant result;
+                bool succeeded;
+                if (data_dir.empty()) {
+                    fc::temp_directory temp_dir(temp_directory_path());
+                    succeeded = runner(temp_dir.path(), result);
+                } else {
+                    succeeded = runner(fc::path(data_dir), result);
+                }
+
+                std::cout << fc::json::to_pretty_string(result) << std::endl;
+                return succeeded ? 0 : 1;
+            } catch (const fc::exception &e) {
+                std::cerr << e.to_detail_string() << std::endl;
+            } catch (const std::exception &e) {
+                std::cerr << e.what() << std::endl;
+            }
+            return 2;
+        }
+
+    }
+} // golos::utilities
@@ -0,0 +1,70 @@
+#pragma once
+
+#include <fc/filesystem.hpp>
+#include <fc/reflect/reflect.hpp>
+#include <fc/time.hpp>
+#include <fc/variant.hpp>
+
+#include <boost/program_options.hpp>
+
+#include <algorithm>
+#include <functional>
+
+namespace golos {
+    namespace utilities {
+
+        struct timing_result {
+            uint32_t count = 0;
+            int64_t average_us = 0;
+            int64_t max_us = 0;
+        };
+
+        /**
+         * Collects the number, the average and the maximum duration of measured calls
+         */
+        class timer final {
+        public:
+            template<typename Lambda>
+            void measure(Lambda &&callback) {
+                auto start = fc::time_point::now();
+                callback();
+                auto duration = (fc::time_point::now() - start).count();
+                _total += duration;
+                _max = std::max(_max, duration);
+                ++_count;
+            }
+
+            timing_result get_result() const {
+                timing_result result;
+                result.count = _count;
+                result.average_us = _count ? _total / _count : 0;
+                result.max_us = _max;
+                return result;
+            }
+
+        private:
+            uint32_t _count = 0;
+            int64_t _total = 0;
+            int64_t _max = 0;
+        };
+
+        /**
+         * Fills the result of the benchmark, the data directory is removed after the run unless it's set by the user
+         * @return false if the benchmark has failed, its result is printed anyway
+         */
+        using benchmark_runner = std::function<bool(const fc::path &data_dir, fc::variant &result)>;
+
+        /**
+         * Parses the command line of the benchmark program with the help and the data directory options added
+         * to the options of the benchmark, runs the benchmark and prints its result as JSON.
+         * @return the exit code of the program: 0 on success, 1 if the benchmark has failed and 2 on errors
+         */
+        int benchmark_main(
+            int argc, char **argv,
+            boost::program_options::options_description &options,
+            const benchmark_runner &runner);
+
+    }
+} // golos::utilities
+
+FC_REFLECT((golos::utilities::timing_result), (count)(average_us)(max_us))
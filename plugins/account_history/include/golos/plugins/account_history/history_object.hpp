@@ -32,7 +32,8 @@
 namespace golos { namespace plugins { namespace account_history {
 
     enum account_object_types {
-        account_history_object_type = (ACCOUNT_HISTORY_SPACE_ID << 8)
+        account_history_object_type = (ACCOUNT_HISTORY_SPACE_ID << 8),
+        account_history_progress_object_type = (ACCOUNT_HISTORY_SPACE_ID << 8) + 1
     };
 
     using namespace golos::chain;
@@ -70,9 +71,40 @@ namespace golos { namespace plugins { namespace account_history {
                 composite_key_compare<std::less<account_name_type>, std::greater<uint32_t>>>>,
         allocator<account_history_object>>;
 
+    /**
+     * High-water mark of the plugin in the operations stored by operation_history,
+     * it allows to catch up the history from them after the plugin is enabled on an existing node
+     */
+    class account_history_progress_object final
+            : public object<account_history_progress_object_type, account_history_progress_object> {
+    public:
+        template <typename Constructor, typename Allocator>
+        account_history_progress_object(Constructor &&c, allocator <Allocator> a) {
+            c(*this);
+        }
+
+        id_type id;
+
+        operation_id_type next_operation; ///< the first stored operation which isn't indexed yet
+    };
+
+    using account_history_progress_id_type = object_id<account_history_progress_object>;
+
+    using account_history_progress_index = multi_index_container<
+        account_history_progress_object,
+        indexed_by<
+            ordered_unique<
+                tag<by_id>,
+                member<account_history_progress_object, account_history_progress_id_type, &account_history_progress_object::id>>>,
+        allocator<account_history_progress_object>>;
+
 } } } // golos::plugins::account_history
 
 CHAINBASE_SET_INDEX_TYPE(
     golos::plugins::account_history::account_history_object,
     golos::plugins::account_history::account_history_index)
 
+CHAINBASE_SET_INDEX_TYPE(
+    golos::plugins::account_history::account_history_progress_object,
+    golos::plugins::account_history::account_history_progress_index)
+
@@ -35,17 +35,17 @@ if( options.count(name) ) { \
     struct operation_visitor final {
         operation_visitor(
             golos::chain::database& db,
-            const golos::chain::operation_notification& op_note,
+            operation_id_type op_id,
             std::string op_account)
             : database(db),
-              note(op_note),
+              op_id(op_id),
               account(op_account){
         }
 
         using result_type = void;
 
         golos::chain::database& database;
-        const golos::chain::operation_notification& note;
+        operation_id_type op_id;
         std::string account;
 
         template<typename Op>
@@ -61,7 +61,7 @@ if( options.count(name) ) { \
             database.create<account_history_object>([&](account_history_object& history) {
                 history.account = account;
                 history.sequence = sequence;
-                history.op = operation_history::operation_id_type(note.db_id);
+                history.op = op_id;
             });
         }
     };
@@ -79,17 +79,103 @@ if( options.count(name) ) { \
                 return;
             }
 
+            operation_id_type op_id(note.db_id);
+            if (!first_live_operation.valid()) {
+                first_live_operation = op_id;
+            }
+            index_operation(note.op, op_id);
+        }
+
+        void index_operation(const operation& op, operation_id_type op_id) {
             fc::flat_set<golos::chain::account_name_type> impacted;
-            operation_get_impacted_accounts(note.op, impacted);
+            operation_get_impacted_accounts(op, impacted);
 
             for (const auto& item : impacted) {
                 auto itr = tracked_accounts.lower_bound(item);
                 if (!tracked_accounts.size() ||
                     (itr != tracked_accounts.end() && itr->first <= item && item <= itr->second)
                 ) {
-                    note.op.visit(operation_visitor(database, note, item));
+                    op.visit(operation_visitor(database, op_id, item));
+                }
+            }
+        }
+
+        operation_id_type get_next_stored_operation() const {
+            const auto& idx = database.get_index<operation_history::operation_index>().indices();
+            if (idx.empty()) {
+                return operation_id_type();
+            }
+            return operation_id_type(idx.rbegin()->id._id + 1);
+        }
+
+        void on_applied_block(const signed_block&) {
+            // the progress is created by catch_up() on startup, blocks of the replay are applied before it
+            const auto* progress = database.find<account_history_progress_object>();
+            if (progress == nullptr) {
+                return;
+            }
+
+            auto next_operation = get_next_stored_operation();
+            if (progress->next_operation != next_operation) {
+                database.modify(*progress, [&](account_history_progress_object& p) {
+                    p.next_operation = next_operation;
+                });
+            }
+        }
+
+        /**
+         * Indexes operations, which were stored by operation_history while the plugin was disabled,
+         * without the replay of the blockchain. Only operations are read, so the consensus state isn't touched.
+         */
+        void catch_up() {
+            const auto& ops_idx = database.get_index<operation_history::operation_index>().indices();
+            const auto* progress = database.find<account_history_progress_object>();
+            auto end_operation = get_next_stored_operation();
+
+            operation_id_type from_operation;
+            if (progress != nullptr) {
+                from_operation = progress->next_operation;
+            } else if (!database.get_index<account_history_index>().indices().empty()) {
+                // the history was built before its progress was tracked
+                from_operation = end_operation;
+            }
+
+            // operations of blocks applied after the open of the database are already indexed
+            auto to_operation = first_live_operation.valid() ? *first_live_operation : end_operation;
+
+            if (catch_up_enabled && from_operation < to_operation) {
+                ilog("account_history: catching up operations from ${from} to ${to}",
+                     ("from", from_operation._id)("to", to_operation._id));
+
+                auto itr = ops_idx.lower_bound(from_operation);
+                if (itr != ops_idx.end() && itr->id < to_operation && itr->id != from_operation) {
+                    wlog("account_history: stored operations from ${from} to ${first} are missing, catch up is incomplete",
+                         ("from", from_operation._id)("first", itr->id._id));
+                }
+
+                uint64_t count = 0;
+                for (; itr != ops_idx.end() && itr->id < to_operation; ++itr) {
+                    index_operation(fc::raw::unpack<operation>(itr->serialized_op), itr->id);
+                    if (++count % 100000 == 0) {
+                        ilog("account_history: ${count} operations are indexed", ("count", count));
+                    }
                 }
+
+                ilog("account_history: catch up is finished, ${count} operations are indexed", ("count", count));
             }
+
+            if (progress == nullptr) {
+                database.create<account_history_progress_object>([&](account_history_progress_object& p) {
+                    p.next_operation = end_operation;
+                });
+            } else {
+                database.modify(*progress, [&](account_history_progress_object& p) {
+                    p.next_operation = end_operation;
+                });
+            }
+
+            // the progress covers operations up to the end now, the next catch up starts from it
+            first_live_operation.reset();
         }
 
         std::map<uint32_t, applied_operation> get_account_history(
@@ -114,6 +200,8 @@ if( options.count(name) ) { \
         }
 
         fc::flat_map<std::string, std::string> tracked_accounts;
+        bool catch_up_enabled = true;
+        fc::optional<operation_id_type> first_live_operation;
         golos::chain::database& database;
     };
 
@@ -368,6 +456,10 @@ if( options.count(name) ) { \
             boost::program_options::value<std::vector<std::string>>()->composing()->multitoken(),
             "Defines a range of accounts to track as a json pair [\"from\",\"to\"] [from,to]. "
             "Can be specified multiple times"
+        )(
+            "account-history-catch-up",
+            boost::program_options::value<bool>()->default_value(true),
+            "On startup index operations, which were stored by operation_history while the plugin was disabled"
         );
         cfg.add(cli);
     }
@@ -380,7 +472,14 @@ if( options.count(name) ) { \
             pimpl->on_operation(note);
         });
 
+        pimpl->database.applied_block.connect([&](const signed_block& block){
+            pimpl->on_applied_block(block);
+        });
+
         golos::chain::add_plugin_index<account_history_index>(pimpl->database);
+        golos::chain::add_plugin_index<account_history_progress_index>(pimpl->database);
+
+        pimpl->catch_up_enabled = options.at("account-history-catch-up").as<bool>();
 
         using pairstring = std::pair<std::string, std::string>;
         LOAD_VALUE_SET(options, "track-account-range", pimpl->tracked_accounts, pairstring);
@@ -402,6 +501,9 @@ if( options.count(name) ) { \
 
     void plugin::plugin_startup() {
         ilog("account_history plugin: plugin_startup() begin");
+        pimpl->database.with_strong_write_lock([&]() {
+            pimpl->catch_up();
+        });
         ilog("account_history plugin: plugin_startup() end");
     }
 
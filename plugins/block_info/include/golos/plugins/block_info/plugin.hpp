@@ -14,6 +14,10 @@ namespace golos {
 namespace protocol {
 
 struct signed_block;
+struct signed_transaction;
+
+JSON_RPC_STREAMABLE(signed_block)
+JSON_RPC_STREAMABLE(signed_transaction)
 
 } }
 
@@ -24,6 +28,9 @@ namespace block_info {
 
 using golos::plugins::json_rpc::msg_pack;
 
+JSON_RPC_STREAMABLE(block_info)
+JSON_RPC_STREAMABLE(block_with_info)
+
 DEFINE_API_ARGS ( get_block_info,           msg_pack,       std::vector<block_info>)
 DEFINE_API_ARGS ( get_blocks_with_info,     msg_pack,       std::vector<block_with_info>)
 
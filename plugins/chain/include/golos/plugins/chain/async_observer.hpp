@@ -0,0 +1,221 @@
+#pragma once
+
+#include <golos/chain/database.hpp>
+#include <golos/chain/operation_notification.hpp>
+#include <golos/protocol/block.hpp>
+
+#include <fc/exception/exception.hpp>
+#include <fc/log/logger.hpp>
+
+#include <boost/signals2.hpp>
+
+#include <algorithm>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace golos {
+    namespace plugins {
+        namespace chain {
+
+            /**
+             * Runs a non-consensus observer of the chain (statistics, indexing to external storages) on its own thread.
+             *
+             * On the write thread the observer only captures a snapshot of each operation: a structure defined
+             * by the plugin, which holds the operation and the state of objects it has touched. Snapshots are grouped
+             * by blocks and delivered to the observer thread in the order of blocks, so the cost of the observer
+             * doesn't add to the block apply time.
+             *
+             * A block is delivered only when it becomes irreversible. Snapshots of reversible blocks are kept
+             * on the write thread and are replaced when the block is popped on a fork switch,
+             * so the observer never sees blocks of abandoned forks.
+             *
+             * Snapshots are collected from pre_apply_block to applied_block only. Operations of pending transactions
+             * are skipped, and snapshots of a block which fails to apply are dropped by the start of the next one.
+             */
+            template<typename Snapshot>
+            class async_observer final {
+            public:
+                struct block_notification {
+                    protocol::signed_block block;
+                    std::vector<Snapshot> snapshots;
+                };
+
+                // Called on the write thread, fills the snapshot from the state before and after the operation
+                using snapshot_handler = std::function<void(const golos::chain::operation_notification &, Snapshot &)>;
+
+                // Called on the observer thread for each irreversible block
+                using block_handler = std::function<void(const block_notification &)>;
+
+                async_observer(
+                    golos::chain::database &db, const std::string &name,
+                    snapshot_handler pre_operation, snapshot_handler post_operation, block_handler on_block,
+                    uint32_t max_queue_blocks = 1000)
+                        : _db(db),
+                          _name(name),
+                          _pre_operation(std::move(pre_operation)),
+                          _post_operation(std::move(post_operation)),
+                          _on_block(std::move(on_block)),
+                          _max_queue_blocks(std::max<uint32_t>(max_queue_blocks, 1)) {
+                    _pre_block_conn = _db.pre_apply_block.connect(
+                        [this](const protocol::signed_block &block) { pre_apply_block(block); });
+                    _pre_operation_conn = _db.pre_apply_operation.connect(
+                        [this](golos::chain::operation_notification &note) { pre_operation(note); });
+                    _post_operation_conn = _db.post_apply_operation.connect(
+                        [this](const golos::chain::operation_notification &note) { post_operation(note); });
+                    _applied_block_conn = _db.applied_block.connect(
+                        [this](const protocol::signed_block &block) { applied_block(block); });
+
+                    _thread = std::thread([this]() { observe_loop(); });
+                }
+
+                ~async_observer() {
+                    stop();
+                }
+
+                // Delivers all queued blocks and stops the observer thread, reversible blocks are dropped
+                void stop() {
+                    _pre_block_conn.disconnect();
+                    _pre_operation_conn.disconnect();
+                    _post_operation_conn.disconnect();
+                    _applied_block_conn.disconnect();
+
+                    {
+                        std::lock_guard<std::mutex> lock(_queue_mutex);
+                        _stopping = true;
+                    }
+                    _queue_cond.notify_all();
+
+                    if (_thread.joinable()) {
+                        _thread.join();
+                    }
+                }
+
+            private:
+                void pre_apply_block(const protocol::signed_block &block) {
+                    // leftovers of a block which failed to apply
+                    _current_block_num = block.block_num();
+                    _operations.clear();
+                    _stack.clear();
+                }
+
+                void pre_operation(const golos::chain::operation_notification &note) {
+                    // pending transactions are applied again in the block
+                    if (note.block != _current_block_num) {
+                        return;
+                    }
+
+                    // virtual operations are nested into the operations which produce them
+                    _stack.emplace_back();
+                    if (_pre_operation) {
+                        _pre_operation(note, _stack.back());
+                    }
+                }
+
+                void post_operation(const golos::chain::operation_notification &note) {
+                    if (_stack.empty() || note.block != _current_block_num) {
+                        return;
+                    }
+
+                    Snapshot snapshot = std::move(_stack.back());
+                    _stack.pop_back();
+                    if (_post_operation) {
+                        _post_operation(note, snapshot);
+                    }
+                    _operations.push_back(std::move(snapshot));
+                }
+
+                void applied_block(const protocol::signed_block &block) {
+                    auto block_num = block.block_num();
+
+                    // the popped blocks are replaced by the applied one
+                    _blocks.erase(_blocks.lower_bound(block_num), _blocks.end());
+
+                    auto &notification = _blocks[block_num];
+                    notification.block = block;
+                    notification.snapshots = std::move(_operations);
+                    _operations.clear();
+                    _stack.clear();
+                    _current_block_num = 0;
+
+                    auto last_irreversible_block_num = _db.last_non_undoable_block_num();
+                    while (!_blocks.empty() && _blocks.begin()->first <= last_irreversible_block_num) {
+                        enqueue(std::move(_blocks.begin()->second));
+                        _blocks.erase(_blocks.begin());
+                    }
+                }
+
+                void enqueue(block_notification &&notification) {
+                    std::unique_lock<std::mutex> lock(_queue_mutex);
+
+                    // Backpressure: block application waits for the observer instead of dropping blocks
+                    if (_queue.size() >= _max_queue_blocks && !_stopping) {
+                        wlog("Queue of ${name} observer is full (${n} blocks), waiting for it",
+                             ("name", _name)("n", _queue.size()));
+                        _queue_cond.wait(lock, [&]() { return _queue.size() < _max_queue_blocks || _stopping; });
+                    }
+
+                    _queue.push_back(std::move(notification));
+                    _queue_cond.notify_all();
+                }
+
+                void observe_loop() {
+                    while (true) {
+                        block_notification notification;
+                        {
+                            std::unique_lock<std::mutex> lock(_queue_mutex);
+                            _queue_cond.wait(lock, [&]() { return !_queue.empty() || _stopping; });
+                            if (_queue.empty()) {
+                                return; // stopping and all blocks are delivered
+                            }
+                            notification = std::move(_queue.front());
+                            _queue.pop_front();
+                        }
+                        _queue_cond.notify_all();
+
+                        try {
+                            _on_block(notification);
+                        } catch (const fc::exception &e) {
+                            elog("${name} observer failed on block ${n}: ${e}",
+                                 ("name", _name)("n", notification.block.block_num())("e", e.to_detail_string()));
+                        } catch (const std::exception &e) {
+                            elog("${name} observer failed on block ${n}: ${e}",
+                                 ("name", _name)("n", notification.block.block_num())("e", e.what()));
+                        }
+                    }
+                }
+
+                golos::chain::database &_db;
+                std::string _name;
+
+                snapshot_handler _pre_operation;
+                snapshot_handler _post_operation;
+                block_handler _on_block;
+
+                // Accessed only on the write thread
+                uint32_t _current_block_num = 0;
+                std::vector<Snapshot> _stack;
+                std::vector<Snapshot> _operations;
+                std::map<uint32_t, block_notification> _blocks;
+
+                boost::signals2::scoped_connection _pre_block_conn;
+                boost::signals2::scoped_connection _pre_operation_conn;
+                boost::signals2::scoped_connection _post_operation_conn;
+                boost::signals2::scoped_connection _applied_block_conn;
+
+                std::deque<block_notification> _queue;
+                std::mutex _queue_mutex;
+                std::condition_variable _queue_cond;
+                uint32_t _max_queue_blocks;
+                bool _stopping = false;
+                std::thread _thread;
+            };
+
+        }
+    }
+} // golos::plugins::chain
@@ -45,6 +45,13 @@ namespace golos {
 
                 void accept_transaction(const protocol::signed_transaction &trx);
 
+                /**
+                 * Accepts a transaction, which was already validated by trx.validate(),
+                 * and which signatures were recovered by the caller
+                 */
+                void accept_transaction(
+                    const protocol::signed_transaction &trx, const fc::flat_set<protocol::public_key_type> &signature_keys);
+
                 bool block_is_on_preferred_chain(const protocol::block_id_type &block_id);
 
                 void check_time_in_block(const protocol::signed_block &block);
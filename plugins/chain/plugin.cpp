@@ -30,6 +30,7 @@ namespace chain {
         bool readonly = false;
         bool check_locks = false;
         bool validate_invariants = false;
+        uint32_t invariants_audit_blocks = 0;
         uint32_t flush_interval = 0;
         flat_map<uint32_t, protocol::block_id_type> loaded_checkpoints;
 
@@ -49,6 +50,8 @@ namespace chain {
 
         uint32_t block_num_check_free_size = 0;
 
+        golos::chain::shared_memory_mapping_options shared_memory_mapping;
+
         bool skip_virtual_ops = false;
 
         golos::chain::database db;
@@ -82,6 +85,8 @@ namespace chain {
         void check_time_in_block(const protocol::signed_block &block);
         bool accept_block(const protocol::signed_block &block, bool currently_syncing, uint32_t skip);
         void accept_transaction(const protocol::signed_transaction &trx);
+        void accept_transaction(const protocol::signed_transaction &trx, const fc::flat_set<protocol::public_key_type> &signature_keys);
+        void push_transaction(const protocol::signed_transaction &trx, uint32_t skip);
         void wipe_db(const bfs::path &data_dir, bool wipe_block_log);
         void replay_db(const bfs::path &data_dir, bool force_replay);
     };
@@ -147,8 +152,17 @@ namespace chain {
     };
 
     void plugin::plugin_impl::accept_transaction(const protocol::signed_transaction &trx) {
-        uint32_t skip = db.validate_transaction(trx, db.skip_apply_transaction);
+        push_transaction(trx, db.validate_transaction(trx, db.skip_apply_transaction));
+    }
+
+    void plugin::plugin_impl::accept_transaction(
+        const protocol::signed_transaction &trx, const fc::flat_set<protocol::public_key_type> &signature_keys
+    ) {
+        push_transaction(trx, db.validate_transaction(
+            trx, signature_keys, db.skip_apply_transaction | db.skip_validate_operations));
+    }
 
+    void plugin::plugin_impl::push_transaction(const protocol::signed_transaction &trx, uint32_t skip) {
         if (single_write_thread) {
             std::promise<bool> promise;
             auto wait = promise.get_future();
@@ -199,6 +213,20 @@ namespace chain {
             ) (
                 "block-num-check-free-size", boost::program_options::value<uint32_t>()->default_value(1000),
                 "Check free space in shared memory each N blocks. Default: 1000 (each 3000 seconds)."
+            ) (
+                "shared-file-huge-pages", boost::program_options::value<bool>()->default_value(false),
+                "Advise the kernel to use transparent huge pages for the shared memory file. "
+                "It takes effect only if shared-file-dir is on tmpfs, a hugetlbfs mount is already backed by huge pages"
+            ) (
+                "shared-file-lock", boost::program_options::value<bool>()->default_value(false),
+                "Lock the shared memory file in RAM, requires the memlock limit not less than the file size"
+            ) (
+                "shared-file-warm-up", boost::program_options::value<bool>()->default_value(false),
+                "Read the whole shared memory file on startup, so the first blocks aren't applied on cold pages"
+            ) (
+                "shared-file-numa-node", boost::program_options::value<int32_t>()->default_value(-1),
+                "Bind the shared memory file to the NUMA node, only if shared-file-dir is on tmpfs or hugetlbfs. "
+                "Default: -1 (don't bind)"
             ) (
                 "checkpoint", boost::program_options::value<std::vector<std::string>>()->composing(),
                 "Pairs of [BLOCK_NUM,BLOCK_ID] that should be enforced as checkpoints."
@@ -248,7 +276,10 @@ namespace chain {
                 "Check correctness of chainbase locking"
             ) (
                 "validate-database-invariants", boost::program_options::bool_switch()->default_value(false),
-                "Validate all supply invariants check out"
+                "Validate all supply invariants check out on each block by changes of objects in the block"
+            ) (
+                "validate-database-invariants-audit-blocks", boost::program_options::value<uint32_t>()->default_value(0),
+                "Validate supply invariants by the full scan of the state each N blocks (0 - only on the first block)"
             );
     }
 
@@ -293,12 +324,18 @@ namespace chain {
             my->block_num_check_free_size = options.at("block-num-check-free-size").as<uint32_t>();
         }
 
+        my->shared_memory_mapping.huge_pages = options.at("shared-file-huge-pages").as<bool>();
+        my->shared_memory_mapping.lock = options.at("shared-file-lock").as<bool>();
+        my->shared_memory_mapping.warm_up = options.at("shared-file-warm-up").as<bool>();
+        my->shared_memory_mapping.numa_node = options.at("shared-file-numa-node").as<int32_t>();
+
         my->replay = options.at("replay-blockchain").as<bool>();
         my->replay_if_corrupted = options.at("replay-if-corrupted").as<bool>();
         my->force_replay = options.at("force-replay-blockchain").as<bool>();
         my->resync = options.at("resync-blockchain").as<bool>();
         my->check_locks = options.at("check-locks").as<bool>();
         my->validate_invariants = options.at("validate-database-invariants").as<bool>();
+        my->invariants_audit_blocks = options.at("validate-database-invariants-audit-blocks").as<uint32_t>();
         if (options.count("flush-state-interval")) {
             my->flush_interval = options.at("flush-state-interval").as<uint32_t>();
         } else {
@@ -336,6 +373,7 @@ namespace chain {
 
         my->db.set_inc_shared_memory_size(my->inc_shared_memory_size);
         my->db.set_min_free_shared_memory_size(my->min_free_shared_memory_size);
+        my->db.set_shared_memory_mapping(my->shared_memory_mapping);
 
         my->db.set_clear_votes(my->clear_votes_before_block);
 
@@ -348,6 +386,7 @@ namespace chain {
         }
 
         my->db.enable_plugins_on_push_transaction(my->enable_plugins_on_push_transaction);
+        my->db.set_validate_invariants(my->validate_invariants, my->invariants_audit_blocks);
 
         try {
             ilog("Opening shared memory from ${path}", ("path", my->shared_memory_dir.generic_string()));
@@ -390,6 +429,13 @@ namespace chain {
         }
 
         ilog("Started on blockchain with ${n} blocks", ("n", my->db.head_block_num()));
+
+        auto &json_rpc = appbase::app().get_plugin<json_rpc::plugin>();
+        json_rpc.set_cache_head(my->db.head_block_id(), my->db.last_non_undoable_block_num());
+        my->db.applied_block.connect([this, &json_rpc](const protocol::signed_block &) {
+            json_rpc.set_cache_head(my->db.head_block_id(), my->db.last_non_undoable_block_num());
+        });
+
         on_sync();
     }
 
@@ -407,6 +453,12 @@ namespace chain {
         my->accept_transaction(trx);
     }
 
+    void plugin::accept_transaction(
+        const protocol::signed_transaction &trx, const fc::flat_set<protocol::public_key_type> &signature_keys
+    ) {
+        my->accept_transaction(trx, signature_keys);
+    }
+
     bool plugin::block_is_on_preferred_chain(const protocol::block_id_type &block_id) {
         // If it's not known, it's not preferred.
         if (!db().is_known_block(block_id)) {
@@ -772,8 +772,6 @@ DEFINE_API(plugin, get_expiring_vesting_delegations) {
 DEFINE_API(plugin, get_database_info) {
     CHECK_ARG_SIZE(0);
 
-    // read lock doesn't seem needed...
-
     database_info info;
     auto& db = my->database();
 
@@ -782,10 +780,14 @@ DEFINE_API(plugin, get_database_info) {
     info.reserved_size = db.reserved_memory();
     info.used_size = info.total_size - info.free_size - info.reserved_size;
 
-    info.index_list.reserve(db.index_list_size());
+    // sizes of strings are estimated by reading a sample of objects
+    auto statistics = db.with_weak_read_lock([&]() {
+        return db.get_index_statistics();
+    });
 
-    for (auto it = db.index_list_begin(), et = db.index_list_end(); et != it; ++it) {
-        info.index_list.push_back({(*it)->name(), (*it)->size()});
+    info.index_list.reserve(statistics.size());
+    for (const auto& s : statistics) {
+        info.index_list.push_back({s.name, s.object_count, s.total_size, s.dynamic_size});
     }
 
     return info;
@@ -846,7 +848,15 @@ DEFINE_API(plugin, get_proposed_transactions) {
 void plugin::plugin_initialize(const boost::program_options::variables_map &options) {
     ilog("database_api plugin: plugin_initialize() begin");
     my = std::make_unique<api_impl>();
-    JSON_RPC_REGISTER_API(plugin_name)
+    JSON_RPC_REGISTER_API(plugin_name, {
+        {"get_block_header",              json_rpc::api_cache_scope::irreversible_block},
+        {"get_block",                     json_rpc::api_cache_scope::irreversible_block},
+        {"get_config",                    json_rpc::api_cache_scope::head_block},
+        {"get_dynamic_global_properties", json_rpc::api_cache_scope::head_block},
+        {"get_chain_properties",          json_rpc::api_cache_scope::head_block},
+        {"get_hardfork_version",          json_rpc::api_cache_scope::head_block},
+        {"get_next_scheduled_hardfork",   json_rpc::api_cache_scope::head_block}
+    })
     my->database().applied_block.connect([this](const protocol::signed_block &) {
         this->clear_block_applied_callback();
     });
@@ -20,6 +20,15 @@
 
 #include "forward.hpp"
 
+namespace golos { namespace protocol {
+    JSON_RPC_STREAMABLE(signed_block)
+    JSON_RPC_STREAMABLE(signed_transaction)
+} } // golos::protocol
+
+namespace golos { namespace api {
+    JSON_RPC_STREAMABLE(account_api_object)
+} } // golos::api
+
 namespace golos { namespace plugins { namespace database_api {
 
 using namespace golos::chain;
@@ -34,6 +43,8 @@ using plugins::json_rpc::msg_pack_transfer;
 struct database_index_info {
     std::string name;
     std::size_t record_count;
+    std::size_t total_size;   ///< approximate size in the shared memory
+    std::size_t dynamic_size; ///< part of total_size, which is used by strings and buffers
 };
 
 struct database_info {
@@ -367,5 +378,5 @@ FC_REFLECT((golos::plugins::database_api::get_tags_used_by_author), (tags))
 
 FC_REFLECT((golos::plugins::database_api::signed_block_api_object), (block_id)(signing_key)(transaction_ids))
 
-FC_REFLECT((golos::plugins::database_api::database_index_info), (name)(record_count))
+FC_REFLECT((golos::plugins::database_api::database_index_info), (name)(record_count)(total_size)(dynamic_size))
 FC_REFLECT((golos::plugins::database_api::database_info), (total_size)(free_size)(reserved_size)(used_size)(index_list))
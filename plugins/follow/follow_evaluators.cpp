@@ -145,6 +145,10 @@ namespace golos {
                         });
                     }
 
+                    if (_plugin->feed_mode() == feed_mode_type::fan_out_on_read) {
+                        return;
+                    }
+
                     const auto &feed_idx = db().get_index<feed_index>().indices().get<by_feed>();
                     const auto &comment_idx = db().get_index<feed_index>().indices().get<by_comment>();
                     const auto &idx = db().get_index<follow_index>().indices().get<by_following_follower>();
@@ -71,6 +71,10 @@ namespace golos {
                 uint32_t account_feed_id = 0;
             };
 
+            inline std::size_t dynamic_memory_usage(const feed_object &o) {
+                return golos::chain::dynamic_memory_usage(o.reblogged_by);
+            }
+
             typedef object_id<feed_object> feed_id_type;
 
 
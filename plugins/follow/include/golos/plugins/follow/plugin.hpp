@@ -14,6 +14,33 @@ namespace golos { namespace plugins { namespace follow {
         fc::optional<share_type>& reputation
     );
 
+    enum class feed_mode_type {
+        // Feed entries of all followers are created on each post and reblog
+        fan_out_on_write,
+
+        // Only blogs are stored, feeds are merged from blogs of followed authors on each request
+        fan_out_on_read
+    };
+
+    struct account_feed_item {
+        comment_object::id_type comment;
+        std::vector<account_name_type> reblogged_by;
+        time_point_sec reblogged_on;
+        uint32_t entry_id = 0;
+    };
+
+    /**
+     * Merges blogs of authors followed by the account, newest entries go first.
+     * A post appears once, at its latest occurrence in the merged blogs.
+     * Entry ids are ids of blog objects, so they can be passed as start_entry_id to get the next page.
+     */
+    std::vector<account_feed_item> collect_account_feed(
+        const golos::chain::database& db,
+        const account_name_type& account,
+        uint32_t start_entry_id,
+        uint32_t limit
+    );
+
     ///               API,                          args,       return
     DEFINE_API_ARGS(get_followers,           msg_pack, std::vector<follow_api_object>)
     DEFINE_API_ARGS(get_following,           msg_pack, std::vector<follow_api_object>)
@@ -66,6 +93,8 @@ namespace golos { namespace plugins { namespace follow {
 
         uint32_t max_feed_size();
 
+        feed_mode_type feed_mode() const;
+
         void plugin_startup() override;
 
         void plugin_shutdown() override {}
@@ -8,6 +8,7 @@
 #include <golos/chain/account_object.hpp>
 #include <golos/chain/comment_object.hpp>
 #include <memory>
+#include <queue>
 #include <golos/plugins/json_rpc/plugin.hpp>
 #include <golos/chain/index.hpp>
 
@@ -43,6 +44,91 @@ namespace golos {
                 }
             }
 
+            std::vector<account_feed_item> collect_account_feed(
+                const golos::chain::database& db,
+                const account_name_type& account,
+                uint32_t start_entry_id,
+                uint32_t limit
+            ) {
+                std::vector<account_feed_item> result;
+
+                if (start_entry_id == 0) {
+                    start_entry_id = ~0;
+                }
+
+                const auto &follow_idx = db.get_index<follow_index>().indices().get<by_follower_following>();
+                const auto &blog_idx = db.get_index<blog_index>().indices().get<by_blog>();
+                const auto &comment_blog_idx = db.get_index<blog_index>().indices().get<by_comment>();
+
+                using blog_iterator = decltype(blog_idx.begin());
+
+                // Blog of each account is ordered from newest, so it has descending ids too
+                auto newer = [](const blog_iterator &a, const blog_iterator &b) {
+                    return a->id < b->id;
+                };
+                std::priority_queue<blog_iterator, std::vector<blog_iterator>, decltype(newer)> heads(newer);
+
+                flat_set<account_name_type> followed;
+                for (auto itr = follow_idx.lower_bound(account); itr != follow_idx.end() && itr->follower == account; ++itr) {
+                    if (!(itr->what & (1 << blog))) {
+                        continue;
+                    }
+                    followed.insert(itr->following);
+
+                    auto blog_itr = blog_idx.lower_bound(itr->following);
+                    while (blog_itr != blog_idx.end() && blog_itr->account == itr->following &&
+                           blog_itr->id._id > static_cast<int64_t>(start_entry_id)
+                    ) {
+                        ++blog_itr;
+                    }
+                    if (blog_itr != blog_idx.end() && blog_itr->account == itr->following) {
+                        heads.push(blog_itr);
+                    }
+                }
+
+                result.reserve(limit);
+                while (!heads.empty() && result.size() < limit) {
+                    auto blog_itr = heads.top();
+                    heads.pop();
+
+                    auto next_itr = std::next(blog_itr);
+                    if (next_itr != blog_idx.end() && next_itr->account == blog_itr->account) {
+                        heads.push(next_itr);
+                    }
+
+                    const auto &comment = db.get(blog_itr->comment);
+                    account_feed_item item;
+                    bool is_latest = true;
+
+                    auto itr = comment_blog_idx.lower_bound(blog_itr->comment);
+                    for (; itr != comment_blog_idx.end() && itr->comment == blog_itr->comment; ++itr) {
+                        if (!followed.count(itr->account)) {
+                            continue;
+                        }
+                        if (itr->id > blog_itr->id) {
+                            is_latest = false;
+                            break;
+                        }
+                        if (itr->account != comment.author) {
+                            if (item.reblogged_by.empty() || itr->reblogged_on < item.reblogged_on) {
+                                item.reblogged_on = itr->reblogged_on;
+                            }
+                            item.reblogged_by.push_back(itr->account);
+                        }
+                    }
+
+                    if (!is_latest) {
+                        continue;
+                    }
+
+                    item.comment = blog_itr->comment;
+                    item.entry_id = static_cast<uint32_t>(blog_itr->id._id);
+                    result.push_back(std::move(item));
+                }
+
+                return result;
+            }
+
             struct pre_operation_visitor {
                 plugin &_plugin;
                 golos::chain::database &db;
@@ -167,6 +253,11 @@ namespace golos {
                         const auto &comment_idx = db.get_index<feed_index>().indices().get<by_comment>();
                         auto itr = idx.find(op.author);
 
+                        // In the fan_out_on_read mode feeds are merged from blogs on request
+                        if (_plugin.feed_mode() == feed_mode_type::fan_out_on_read) {
+                            itr = idx.end();
+                        }
+
                         const auto &feed_idx = db.get_index<feed_index>().indices().get<by_feed>();
 
                         while (itr != idx.end() && itr->following == op.author) {
@@ -376,6 +467,8 @@ namespace golos {
 
                 uint32_t max_feed_size_ = 500;
 
+                feed_mode_type feed_mode_ = feed_mode_type::fan_out_on_write;
+
                 std::shared_ptr<generic_custom_operation_interpreter<
                         follow::follow_plugin_operation>> _custom_operation_interpreter;
             };
@@ -388,7 +481,10 @@ namespace golos {
                                                     boost::program_options::options_description &cfg) {
                 cli.add_options()
                     ("follow-max-feed-size", boost::program_options::value<uint32_t>()->default_value(500),
-                        "Set the maximum size of cached feed for an account");
+                        "Set the maximum size of cached feed for an account")
+                    ("follow-feed-mode", boost::program_options::value<std::string>()->default_value("write"),
+                        "How feeds are built: 'write' - feed entries of all followers are stored on each post, "
+                        "'read' - only blogs are stored and feeds are merged from blogs of followed authors on request");
                 cfg.add(cli);
             }
 
@@ -417,6 +513,18 @@ namespace golos {
                         pimpl->max_feed_size_ = feed_size;
                     }
 
+                    if (options.count("follow-feed-mode")) {
+                        auto feed_mode = options["follow-feed-mode"].as<std::string>();
+                        if (feed_mode == "write") {
+                            pimpl->feed_mode_ = feed_mode_type::fan_out_on_write;
+                        } else if (feed_mode == "read") {
+                            pimpl->feed_mode_ = feed_mode_type::fan_out_on_read;
+                        } else {
+                            FC_THROW_EXCEPTION(fc::invalid_arg_exception,
+                                "Unknown follow-feed-mode ${m}, expected 'write' or 'read'", ("m", feed_mode));
+                        }
+                    }
+
                     JSON_RPC_REGISTER_API ( name() ) ;
                 } FC_CAPTURE_AND_RETHROW()
             }
@@ -428,6 +536,10 @@ namespace golos {
                 return pimpl->max_feed_size_;
             }
 
+            feed_mode_type plugin::feed_mode() const {
+                return pimpl->feed_mode_;
+            }
+
             plugin::~plugin() {
 
             }
@@ -511,6 +623,21 @@ namespace golos {
                 result.reserve(limit);
 
                 const auto &db = database();
+
+                if (feed_mode_ == feed_mode_type::fan_out_on_read) {
+                    for (auto &item : collect_account_feed(db, account, entry_id, limit)) {
+                        const auto &comment = db.get(item.comment);
+                        feed_entry entry;
+                        entry.author = comment.author;
+                        entry.permlink = to_string(comment.permlink);
+                        entry.entry_id = item.entry_id;
+                        entry.reblog_by.assign(item.reblogged_by.begin(), item.reblogged_by.end());
+                        entry.reblog_on = item.reblogged_on;
+                        result.push_back(std::move(entry));
+                    }
+                    return result;
+                }
+
                 const auto &feed_idx = db.get_index<feed_index>().indices().get<by_feed>();
                 auto itr = feed_idx.lower_bound(boost::make_tuple(account, entry_id));
 
@@ -550,6 +677,19 @@ namespace golos {
                 result.reserve(limit);
 
                 const auto &db = database();
+
+                if (feed_mode_ == feed_mode_type::fan_out_on_read) {
+                    for (auto &item : collect_account_feed(db, account, entry_id, limit)) {
+                        comment_feed_entry entry;
+                        entry.comment = comment_api_object(db.get(item.comment), db);
+                        entry.entry_id = item.entry_id;
+                        entry.reblog_by.assign(item.reblogged_by.begin(), item.reblogged_by.end());
+                        entry.reblog_on = item.reblogged_on;
+                        result.push_back(std::move(entry));
+                    }
+                    return result;
+                }
+
                 const auto &feed_idx = db.get_index<feed_index>().indices().get<by_feed>();
                 auto itr = feed_idx.lower_bound(boost::make_tuple(account, entry_id));
 
@@ -0,0 +1,140 @@
+#include <golos/plugins/json_rpc/api_cache.hpp>
+
+#include <fc/io/json.hpp>
+#include <fc/variant_object.hpp>
+
+namespace golos {
+    namespace plugins {
+        namespace json_rpc {
+
+            namespace {
+                // Objects with the same members in a different order should give the same key
+                fc::variant canonicalize(const fc::variant &value) {
+                    if (value.is_object()) {
+                        std::map<std::string, fc::variant> sorted;
+                        for (const auto &member: value.get_object()) {
+                            sorted.emplace(member.key(), canonicalize(member.value()));
+                        }
+
+                        fc::mutable_variant_object result;
+                        for (auto &member: sorted) {
+                            result(member.first, std::move(member.second));
+                        }
+                        return fc::variant(std::move(result));
+                    } else if (value.is_array()) {
+                        const auto &array = value.get_array();
+                        fc::variants result;
+                        result.reserve(array.size());
+                        for (const auto &item: array) {
+                            result.push_back(canonicalize(item));
+                        }
+                        return fc::variant(std::move(result));
+                    }
+                    return value;
+                }
+            }
+
+            void api_cache::configure(std::size_t max_entries, std::size_t max_size) {
+                std::lock_guard<std::mutex> lock(mutex_);
+                max_entries_ = max_entries;
+                max_size_ = max_size;
+            }
+
+            bool api_cache::enabled() const {
+                return max_entries_ != 0 && max_size_ != 0;
+            }
+
+            void api_cache::set_head(const fc::ripemd160 &head_block_id, uint32_t last_irreversible_block_num) {
+                std::lock_guard<std::mutex> lock(mutex_);
+
+                if (head_block_id_ == head_block_id) {
+                    return;
+                }
+
+                head_block_id_ = head_block_id;
+                last_irreversible_block_num_ = last_irreversible_block_num;
+
+                for (auto itr = entries_.begin(); entries_.end() != itr;) {
+                    auto cur = itr++;
+                    if (!cur->permanent) {
+                        erase(cur);
+                    }
+                }
+            }
+
+            api_cache::ticket api_cache::make_ticket(const msg_pack &msg, api_cache_scope scope) const {
+                ticket result;
+
+                result.key.reserve(msg.plugin.size() + msg.method.size() + 2);
+                result.key.append(msg.plugin).append(1, '.').append(msg.method).append(1, ':');
+                if (msg.args.valid()) {
+                    result.key.append(fc::json::to_string(canonicalize(fc::variant(*msg.args))));
+                }
+
+                std::lock_guard<std::mutex> lock(mutex_);
+                result.head_block_id = head_block_id_;
+
+                if (api_cache_scope::irreversible_block == scope &&
+                    msg.args.valid() && !msg.args->empty() && msg.args->front().is_numeric()
+                ) {
+                    auto block_num = msg.args->front().as_uint64();
+                    result.permanent = block_num > 0 && block_num <= last_irreversible_block_num_;
+                }
+
+                return result;
+            }
+
+            fc::optional<std::string> api_cache::find(const ticket &t) {
+                std::lock_guard<std::mutex> lock(mutex_);
+
+                auto itr = index_.find(t.key);
+                if (index_.end() == itr) {
+                    ++stats_.misses;
+                    return fc::optional<std::string>();
+                }
+
+                ++stats_.hits;
+                entries_.splice(entries_.begin(), entries_, itr->second);
+                return itr->second->result;
+            }
+
+            void api_cache::store(const ticket &t, const std::string &result) {
+                auto size = t.key.size() + result.size() + sizeof(entry);
+
+                std::lock_guard<std::mutex> lock(mutex_);
+
+                // The head block was changed during the call, so the result can be already outdated
+                if (!t.permanent && t.head_block_id != head_block_id_) {
+                    return;
+                }
+
+                if (size > max_size_ || index_.count(t.key)) {
+                    return;
+                }
+
+                while (!entries_.empty() && (entries_.size() >= max_entries_ || stats_.size + size > max_size_)) {
+                    erase(std::prev(entries_.end()));
+                    ++stats_.evictions;
+                }
+
+                entries_.push_front(entry{t.key, result, t.permanent, size});
+                index_.emplace(t.key, entries_.begin());
+                stats_.size += size;
+                stats_.entries = entries_.size();
+            }
+
+            api_cache_statistics api_cache::statistics() const {
+                std::lock_guard<std::mutex> lock(mutex_);
+                return stats_;
+            }
+
+            void api_cache::erase(entry_list::iterator itr) {
+                stats_.size -= itr->size;
+                index_.erase(itr->key);
+                entries_.erase(itr);
+                stats_.entries = entries_.size();
+            }
+
+        }
+    }
+} // golos::plugins::json_rpc
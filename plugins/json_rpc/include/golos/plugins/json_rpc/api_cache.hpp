@@ -0,0 +1,114 @@
+#pragma once
+
+#include <golos/plugins/json_rpc/utility.hpp>
+
+#include <fc/variant.hpp>
+#include <fc/optional.hpp>
+#include <fc/crypto/ripemd160.hpp>
+#include <fc/reflect/reflect.hpp>
+
+#include <list>
+#include <map>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+namespace golos {
+    namespace plugins {
+        namespace json_rpc {
+
+            /**
+             * @brief Describes how long a response of an API method can be reused
+             */
+            enum class api_cache_scope {
+                // The method is never cached
+                none,
+
+                // The response is valid until the head block changes
+                head_block,
+
+                // The first argument of the method is a block number:
+                //   responses for irreversible blocks are kept until evicted,
+                //   responses for reversible blocks are valid until the head block changes
+                irreversible_block
+            };
+
+            /**
+             * @brief Cacheable methods of an API, passed to JSON_RPC_REGISTER_API
+             *
+             * Ex.
+             * JSON_RPC_REGISTER_API(name(), {
+             *     {"get_config", api_cache_scope::head_block},
+             *     {"get_block",  api_cache_scope::irreversible_block}
+             * })
+             */
+            using api_cache_policy = std::map<std::string, api_cache_scope>;
+
+            struct api_cache_statistics {
+                uint64_t hits = 0;
+                uint64_t misses = 0;
+                uint64_t evictions = 0;
+                uint64_t entries = 0;
+                uint64_t size = 0;
+            };
+
+            /**
+             * @brief LRU cache of serialized API responses, keyed by canonicalized (api, method, args)
+             *
+             * The cache is bounded both by the number of entries and by the size of stored responses.
+             * It is thread-safe, because requests are handled from the webserver thread pool.
+             */
+            class api_cache final {
+            public:
+                struct ticket {
+                    std::string key;
+                    fc::ripemd160 head_block_id;
+                    bool permanent = false;
+                };
+
+                api_cache() = default;
+
+                void configure(std::size_t max_entries, std::size_t max_size);
+
+                bool enabled() const;
+
+                // Drops all responses which depend on the previous head block
+                void set_head(const fc::ripemd160 &head_block_id, uint32_t last_irreversible_block_num);
+
+                ticket make_ticket(const msg_pack &msg, api_cache_scope scope) const;
+
+                fc::optional<std::string> find(const ticket &t);
+
+                void store(const ticket &t, const std::string &result);
+
+                api_cache_statistics statistics() const;
+
+            private:
+                struct entry {
+                    std::string key;
+                    std::string result; // serialized JSON
+                    bool permanent;
+                    std::size_t size;
+                };
+
+                using entry_list = std::list<entry>;
+
+                void erase(entry_list::iterator itr);
+
+                std::size_t max_entries_ = 0;
+                std::size_t max_size_ = 0;
+
+                mutable std::mutex mutex_;
+                fc::ripemd160 head_block_id_;
+                uint32_t last_irreversible_block_num_ = 0;
+
+                entry_list entries_; // most recently used are in the front
+                std::unordered_map<std::string, entry_list::iterator> index_;
+                api_cache_statistics stats_;
+            };
+
+        }
+    }
+} // golos::plugins::json_rpc
+
+FC_REFLECT((golos::plugins::json_rpc::api_cache_statistics), (hits)(misses)(evictions)(entries)(size))
@@ -0,0 +1,221 @@
+#pragma once
+
+#include <fc/variant.hpp>
+#include <fc/optional.hpp>
+#include <fc/safe.hpp>
+#include <fc/time.hpp>
+#include <fc/fixed_string.hpp>
+#include <fc/io/json.hpp>
+#include <fc/reflect/reflect.hpp>
+
+#include <cstdint>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+/**
+ * Declares that the reflected TYPE doesn't have a custom to_variant(),
+ * so json_writer can serialize it member-by-member without building fc::variant.
+ *
+ * Should be placed in the namespace of TYPE, can be repeated in several headers.
+ *
+ * Ex.
+ * namespace golos { namespace api {
+ *     JSON_RPC_STREAMABLE(discussion)
+ * } }
+ */
+#define JSON_RPC_STREAMABLE(TYPE) \
+    const TYPE *json_rpc_streamable(const TYPE *);
+
+namespace golos {
+    namespace plugins {
+        namespace json_rpc {
+
+            // Fallback for types, which weren't declared by JSON_RPC_STREAMABLE
+            void json_rpc_streamable(const void *);
+
+            template<typename T>
+            struct is_streamable: std::is_same<
+                decltype(json_rpc_streamable(static_cast<const T *>(nullptr))), const T *> {
+            };
+
+            template<typename T>
+            struct is_streamable<std::vector<T>>: is_streamable<T> {
+            };
+
+            template<typename T>
+            struct is_streamable<fc::optional<T>>: is_streamable<T> {
+            };
+
+            /**
+             * @brief Writes JSON directly to the output buffer
+             *
+             * Streamable structures, vectors and optionals of them are written by reflection.
+             * Strings, integers, booleans and types which are converted to strings (time, account names)
+             * are written directly, all other values are converted through fc::variant.
+             * The result is the same as for fc::json::to_string() with the default formatting.
+             */
+            class json_writer final {
+            public:
+                explicit json_writer(std::string &out): out_(out) {
+                }
+
+                template<typename T>
+                void write(const T &value) {
+                    write(value, is_streamable<T>());
+                }
+
+            private:
+                template<typename T>
+                class member_visitor final {
+                public:
+                    member_visitor(json_writer &writer, const T &value, bool &first)
+                        : writer_(writer), value_(value), first_(first) {
+                    }
+
+                    template<typename Member, class Class, Member (Class::*member)>
+                    void operator()(const char *name) const {
+                        add(name, value_.*member);
+                    }
+
+                private:
+                    // The same as fc::to_variant_visitor: absent optional members are skipped
+                    template<typename M>
+                    void add(const char *name, const fc::optional<M> &value) const {
+                        if (value.valid()) {
+                            add(name, *value);
+                        }
+                    }
+
+                    template<typename M>
+                    void add(const char *name, const M &value) const {
+                        if (!first_) {
+                            writer_.out_.push_back(',');
+                        }
+                        first_ = false;
+
+                        writer_.out_.push_back('"');
+                        writer_.out_.append(name);
+                        writer_.out_.append("\":");
+                        writer_.write(value);
+                    }
+
+                    json_writer &writer_;
+                    const T &value_;
+                    bool &first_;
+                };
+
+                template<typename T>
+                void write(const T &value, std::false_type) {
+                    write_value(value);
+                }
+
+                void write_value(const std::string &value) {
+                    // Only characters, which are escaped by fc::json, require the slow path
+                    for (auto c: value) {
+                        auto u = static_cast<unsigned char>(c);
+                        if (u < 0x20 || u == 0x7f || c == '"' || c == '\\') {
+                            out_.append(fc::json::to_string(fc::variant(value)));
+                            return;
+                        }
+                    }
+                    out_.push_back('"');
+                    out_.append(value);
+                    out_.push_back('"');
+                }
+
+                void write_value(bool value) {
+                    out_.append(value ? "true" : "false");
+                }
+
+                // fc::json quotes integers greater than 0xffffffff, because JavaScript loses their precision
+                void write_value(int64_t value) {
+                    if (value > 0xffffffffll) {
+                        out_.push_back('"');
+                        out_.append(std::to_string(value));
+                        out_.push_back('"');
+                    } else {
+                        out_.append(std::to_string(value));
+                    }
+                }
+
+                void write_value(uint64_t value) {
+                    if (value > 0xffffffffull) {
+                        out_.push_back('"');
+                        out_.append(std::to_string(value));
+                        out_.push_back('"');
+                    } else {
+                        out_.append(std::to_string(value));
+                    }
+                }
+
+                // char is converted to a string by fc::variant
+                template<typename T>
+                typename std::enable_if<std::is_integral<T>::value &&
+                    !std::is_same<T, bool>::value && !std::is_same<T, char>::value &&
+                    !std::is_same<T, int64_t>::value && !std::is_same<T, uint64_t>::value
+                >::type write_value(T value) {
+                    if (std::is_signed<T>::value) {
+                        write_value(int64_t(value));
+                    } else {
+                        write_value(uint64_t(value));
+                    }
+                }
+
+                template<typename T>
+                void write_value(const fc::safe<T> &value) {
+                    write_value(value.value);
+                }
+
+                void write_value(const fc::time_point_sec &value) {
+                    write_value(std::string(value));
+                }
+
+                template<typename Storage>
+                void write_value(const fc::fixed_string<Storage> &value) {
+                    write_value(std::string(value));
+                }
+
+                template<typename T>
+                typename std::enable_if<!std::is_integral<T>::value || std::is_same<T, char>::value
+                >::type write_value(const T &value) {
+                    out_.append(fc::json::to_string(fc::variant(value)));
+                }
+
+                template<typename T>
+                void write(const std::vector<T> &value, std::true_type) {
+                    out_.push_back('[');
+                    bool first = true;
+                    for (const auto &item: value) {
+                        if (!first) {
+                            out_.push_back(',');
+                        }
+                        first = false;
+                        write(item);
+                    }
+                    out_.push_back(']');
+                }
+
+                template<typename T>
+                void write(const fc::optional<T> &value, std::true_type) {
+                    if (value.valid()) {
+                        write(*value);
+                    } else {
+                        out_.append("null");
+                    }
+                }
+
+                template<typename T>
+                void write(const T &value, std::true_type) {
+                    bool first = true;
+                    out_.push_back('{');
+                    fc::reflector<T>::visit(member_visitor<T>(*this, value, first));
+                    out_.push_back('}');
+                }
+
+                std::string &out_;
+            };
+
+        }
+    }
+} // golos::plugins::json_rpc
@@ -2,6 +2,9 @@
 
 #include <appbase/application.hpp>
 #include <golos/plugins/json_rpc/utility.hpp>
+#include <golos/plugins/json_rpc/api_cache.hpp>
+#include <golos/plugins/json_rpc/json_writer.hpp>
+#include <golos/plugins/json_rpc/request_parser.hpp>
 #include <fc/variant.hpp>
 #include <fc/io/json.hpp>
 #include <fc/reflect/variant.hpp>
@@ -33,13 +36,19 @@
  *
  * For methods that do not require arguments, use api_void_args
  * as the argument type.
+ *
+ * Read-only methods can be declared as cacheable on registering of API,
+ * see api_cache_policy.
+ *
+ * Results of types declared by JSON_RPC_STREAMABLE are serialized
+ * directly to JSON without building fc::variant, see json_writer.
  */
 
 #define STEEM_JSON_RPC_PLUGIN_NAME "json_rpc"
 
-#define JSON_RPC_REGISTER_API(API_NAME)                                                       \
+#define JSON_RPC_REGISTER_API(...)                                                            \
 {                                                                                               \
-   golos::plugins::json_rpc::detail::register_api_method_visitor vtor( API_NAME );            \
+   golos::plugins::json_rpc::detail::register_api_method_visitor vtor( __VA_ARGS__ );         \
    for_each_api( vtor );                                                                        \
 }
 
@@ -67,6 +76,12 @@ namespace golos {
              */
             using api_method = std::function<fc::variant(msg_pack &)>;
 
+            /**
+             * @brief Internal type used to bind api methods,
+             * which results are serialized directly to JSON
+             */
+            using api_json_method = std::function<std::string(msg_pack &)>;
+
             /**
              * @brief An API, containing APIs and Methods
              *
@@ -84,6 +99,8 @@ namespace golos {
             class plugin final : public appbase::plugin<plugin> {
             public:
                 using response_handler_type = std::function<void (const std::string &)>;
+                // Returns false if the task is rejected, because the executor is overloaded
+                using executor_type = std::function<bool (std::function<void()>)>;
 
                 plugin();
 
@@ -92,8 +109,7 @@ namespace golos {
                 APPBASE_PLUGIN_REQUIRES();
 
                 void set_program_options(boost::program_options::options_description &,
-                                         boost::program_options::options_description &) override {
-                }
+                                         boost::program_options::options_description &) override;
 
                 static const std::string &name() {
                     static std::string name = STEEM_JSON_RPC_PLUGIN_NAME;
@@ -107,10 +123,26 @@ namespace golos {
                 void plugin_shutdown() override;
 
                 void add_api_method(const string &api_name, const string &method_name,
-                                    const api_method &api/*, const api_method_signature& sig */);
+                                    const api_method &api/*, const api_method_signature& sig */,
+                                    api_cache_scope cache_scope = api_cache_scope::none,
+                                    const api_json_method &json_api = api_json_method());
 
                 void call(const string &body, response_handler_type);
 
+                // Executes the single request already scanned by request_parser,
+                //   its body should be alive until the response is passed.
+                void call(const parsed_request &request, response_handler_type);
+
+                // Invalidates cached responses, should be called on each new head block
+                void set_cache_head(const fc::ripemd160 &head_block_id, uint32_t last_irreversible_block_num);
+
+                api_cache_statistics get_cache_statistics() const;
+
+                // Sets the thread pool for executing requests of batches in parallel,
+                //   by default they are executed in the calling thread.
+                //   Requests rejected by the executor are answered with the "Server is busy" error.
+                void set_executor(executor_type);
+
             private:
                 class impl;
 
@@ -120,22 +152,42 @@ namespace golos {
             namespace detail {
                 class register_api_method_visitor {
                 public:
-                    register_api_method_visitor(const std::string &api_name) : _api_name(api_name),
-                            _json_rpc_plugin(appbase::app().get_plugin< json_rpc::plugin >()) {
+                    register_api_method_visitor(const std::string &api_name, api_cache_policy cache_policy = api_cache_policy())
+                            : _api_name(api_name),
+                              _cache_policy(std::move(cache_policy)),
+                              _json_rpc_plugin(appbase::app().get_plugin< json_rpc::plugin >()) {
                     }
 
                     template<typename Plugin, typename Method, typename Args, typename Ret>
                     void operator()(Plugin &plugin, const std::string &method_name, Method method, Args *args,
                                     Ret *ret) {
+                        auto cache_itr = _cache_policy.find(method_name);
                         _json_rpc_plugin.add_api_method(_api_name, method_name,
                                                         [&plugin, method](msg_pack &args) -> fc::variant {
                                                             return fc::variant((plugin.*method)(args));
-                                                        });
-                        /*api_method_signature{ fc::variant( Args() ), fc::variant( Ret() ) }*/ //);
+                                                        },
+                                                        /*api_method_signature{ fc::variant( Args() ), fc::variant( Ret() ) }*/
+                                                        _cache_policy.end() != cache_itr ? cache_itr->second : api_cache_scope::none,
+                                                        make_json_method(plugin, method, is_streamable<Ret>()));
                     }
 
                 private:
+                    template<typename Plugin, typename Method>
+                    api_json_method make_json_method(Plugin &plugin, Method method, std::true_type) {
+                        return [&plugin, method](msg_pack &args) -> std::string {
+                            std::string json;
+                            json_writer(json).write((plugin.*method)(args));
+                            return json;
+                        };
+                    }
+
+                    template<typename Plugin, typename Method>
+                    api_json_method make_json_method(Plugin &, Method, std::false_type) {
+                        return api_json_method();
+                    }
+
                     std::string _api_name;
+                    api_cache_policy _cache_policy;
                     json_rpc::plugin &_json_rpc_plugin;
                 };
             }
@@ -0,0 +1,74 @@
+#pragma once
+
+#include <fc/variant.hpp>
+#include <fc/optional.hpp>
+
+#include <limits>
+#include <string>
+#include <vector>
+
+namespace golos {
+    namespace plugins {
+        namespace json_rpc {
+
+            /**
+             * @brief Part of the request body, which isn't parsed yet
+             */
+            struct json_span final {
+                const char *begin = nullptr;
+                const char *end = nullptr;
+
+                bool empty() const {
+                    return begin == end;
+                }
+
+                std::string str() const {
+                    return std::string(begin, end);
+                }
+            };
+
+            /**
+             * @brief Top-level members of a JSON-RPC request
+             *
+             * Only the members required for dispatching are decoded, "params" is kept as raw JSON
+             * and is parsed only once, directly into arguments of the API method.
+             * "jsonrpc" and "method" are left empty if they aren't strings.
+             */
+            struct parsed_request final {
+                json_span body;
+                fc::optional<std::string> jsonrpc;
+                fc::optional<std::string> method;
+                fc::optional<json_span> id;
+                fc::optional<json_span> params;
+            };
+
+            /**
+             * @brief Scans a JSON-RPC request without building a tree of fc::variant
+             *
+             * Throws fc::parse_error_exception on malformed JSON.
+             */
+            class request_parser final {
+            public:
+                // Returns true if the body is a batch of requests
+                static bool is_batch(const std::string &body);
+
+                // Splits the batch into raw requests
+                static std::vector<json_span> split_batch(const std::string &body);
+
+                // Splits the array into raw elements, so only the required elements can be parsed.
+                //   The scanning stops after max_size elements, the rest of the array isn't checked then.
+                static std::vector<json_span> split_array(
+                    json_span span, std::size_t max_size = std::numeric_limits<std::size_t>::max());
+
+                static parsed_request parse(json_span request);
+
+                static std::vector<fc::variant> parse_array(json_span span);
+
+                static std::string parse_string(json_span span);
+
+                static fc::variant parse_value(json_span span);
+            };
+
+        }
+    }
+} // golos::plugins::json_rpc
@@ -1,13 +1,15 @@
 #include <golos/plugins/json_rpc/plugin.hpp>
 #include <golos/plugins/json_rpc/utility.hpp>
-
-#include <boost/algorithm/string.hpp>
+#include <golos/plugins/json_rpc/request_parser.hpp>
 
 #include <fc/log/logger_config.hpp>
 #include <fc/exception/exception.hpp>
+#include <fc/string.hpp>
 #include <thirdparty/fc/vendor/websocketpp/websocketpp/error.hpp>
 #include <thirdparty/fc/include/fc/time.hpp>
 
+#include <atomic>
+
 namespace golos {
     namespace plugins {
         namespace json_rpc {
@@ -29,8 +31,42 @@ namespace golos {
                 fc::optional<fc::variant> result;
                 fc::optional<json_rpc_error> error;
                 fc::variant id;
+
+                // Already serialized result, isn't reflected
+                fc::optional<std::string> raw_result;
             };
 
+            std::string to_json(const json_rpc_response &response) {
+                if (!response.raw_result.valid()) {
+                    return fc::json::to_string(response);
+                }
+
+                // The same order of members as in FC_REFLECT
+                std::string json;
+                json.reserve(response.raw_result->size() + 64);
+                json.append("{\"jsonrpc\":").append(fc::json::to_string(fc::variant(response.jsonrpc)));
+                json.append(",\"result\":").append(*response.raw_result);
+                if (response.error.valid()) {
+                    json.append(",\"error\":").append(fc::json::to_string(fc::variant(*response.error)));
+                }
+                json.append(",\"id\":").append(fc::json::to_string(response.id));
+                json.push_back('}');
+                return json;
+            }
+
+            std::string to_json(const vector<json_rpc_response> &responses) {
+                std::string json;
+                json.push_back('[');
+                for (const auto &response: responses) {
+                    if (json.size() > 1) {
+                        json.push_back(',');
+                    }
+                    json.append(to_json(response));
+                }
+                json.push_back(']');
+                return json;
+            }
+
             struct msg_pack::impl final {
                 using handler_type = std::function<void (json_rpc_response &)>;
 
@@ -103,6 +139,18 @@ namespace golos {
                 }
             }
 
+            void msg_pack::raw_result(std::string json) {
+                // Pimpl can absent in case if msg_pack delegated its handlers to other msg_pack (see move constructor)
+                FC_ASSERT(valid(), "The msg_pack delegated its handlers");
+                pimpl->response.raw_result = std::move(json);
+                try {
+                    pimpl->handler(pimpl->response);
+                } catch (const websocketpp::exception &) {
+                    // Can't send data via socket -
+                    //    don't pass exception to upper level, because it doesn't have handler for exception
+                }
+            }
+
             fc::optional<fc::variant> msg_pack::result() const {
                 // Pimpl can absent in case if msg_pack delegated its handlers to other msg_pack (see move constructor)
                 if (valid()) {
@@ -157,9 +205,16 @@ namespace golos {
                 }
 
                 void add_api_method(const string &api_name, const string &method_name,
-                                    const api_method &api/*, const api_method_signature& sig*/ ) {
+                                    const api_method &api/*, const api_method_signature& sig*/,
+                                    api_cache_scope cache_scope, const api_json_method &json_api) {
                     _registered_apis[api_name][method_name] = api;
                     // _method_sigs[ api_name ][ method_name ] = sig;
+                    if (api_cache_scope::none != cache_scope) {
+                        _cache_scopes[api_name][method_name] = cache_scope;
+                    }
+                    if (json_api) {
+                        _json_apis[api_name][method_name] = json_api;
+                    }
                     add_method_reindex(api_name, method_name);
                     std::stringstream canonical_name;
                     canonical_name << api_name << '.' << method_name;
@@ -177,63 +232,89 @@ namespace golos {
                     return &(method_itr->second);
                 }
 
-                api_method *process_params(string method, const fc::variant_object &request, msg_pack &func_args) {
+                api_json_method *find_json_method(const std::string &api, const std::string &method) {
+                    auto api_itr = _json_apis.find(api);
+                    if (_json_apis.end() == api_itr) {
+                        return nullptr;
+                    }
+
+                    auto method_itr = api_itr->second.find(method);
+                    if (api_itr->second.end() == method_itr) {
+                        return nullptr;
+                    }
+
+                    return &(method_itr->second);
+                }
+
+                api_cache_scope find_cache_scope(const std::string &api, const std::string &method) const {
+                    auto api_itr = _cache_scopes.find(api);
+                    if (_cache_scopes.end() == api_itr) {
+                        return api_cache_scope::none;
+                    }
+
+                    auto method_itr = api_itr->second.find(method);
+                    if (api_itr->second.end() == method_itr) {
+                        return api_cache_scope::none;
+                    }
+
+                    return method_itr->second;
+                }
+
+                api_method *process_params(const string &method, const parsed_request &request, msg_pack &func_args) {
                     api_method *ret = nullptr;
 
                     if (method == "call") {
-                        FC_ASSERT(request.contains("params"));
+                        FC_ASSERT(request.params.valid());
 
-                        std::vector<fc::variant> v;
-
-                        if (request["params"].is_array()) {
-                            v = request["params"].as<std::vector<fc::variant> >();
-                        }
+                        // only the names are decoded before the method is found, arguments are parsed once
+                        //   directly from the request
+                        auto v = request_parser::split_array(*request.params);
 
                         FC_ASSERT(v.size() == 2 || v.size() == 3, "params should be {\"api\", \"method\", \"args\"");
 
-                        ret = find_api_method(v[0].as_string(), v[1].as_string());
-                        func_args.plugin = v[0].as_string();
-                        func_args.method = v[1].as_string();
-                        fc::variant tmp = (v.size() == 3) ? v[2] : fc::json::from_string("{}");
-                        func_args.args = tmp.as<std::vector<fc::variant>>();
+                        func_args.plugin = request_parser::parse_string(v[0]);
+                        func_args.method = request_parser::parse_string(v[1]);
+                        ret = find_api_method(func_args.plugin, func_args.method);
+                        if (v.size() == 3) {
+                            func_args.args = request_parser::parse_array(v[2]);
+                        } else {
+                            func_args.args = std::vector<fc::variant>();
+                        }
                     } else {
-                        vector<std::string> v;
-                        boost::split(v, method, boost::is_any_of("."));
+                        auto dot = method.find('.');
 
-                        FC_ASSERT(v.size() == 2, "method specification invalid. Should be api.method");
+                        FC_ASSERT(dot != string::npos && method.find('.', dot + 1) == string::npos,
+                            "method specification invalid. Should be api.method");
 
-                        ret = find_api_method(v[0], v[1]);
-                        func_args.plugin = v[0];
-                        func_args.method = v[1];
-                        fc::variant tmp = (v.size() == 3) ? v[2] : fc::json::from_string("{}");
-                        func_args.args = tmp.as<std::vector<fc::variant>>();
+                        func_args.plugin = method.substr(0, dot);
+                        func_args.method = method.substr(dot + 1);
+                        ret = find_api_method(func_args.plugin, func_args.method);
+                        if (request.params.valid()) {
+                            func_args.args = request_parser::parse_array(*request.params);
+                        } else {
+                            func_args.args = std::vector<fc::variant>();
+                        }
                     }
 
                     return ret;
                 }
 
-                void rpc_jsonrpc(const fc::variant_object &request, msg_pack &msg) {
+                void rpc_jsonrpc(const parsed_request &request, msg_pack &msg) {
                     // TODO: id is optional value or not?
-                    if (request.contains("id")) {
-                        msg.rpc_id(request["id"]);
+                    if (request.id.valid()) {
+                        msg.rpc_id(request_parser::parse_value(*request.id));
                     }
 
-                    if (!request.contains("jsonrpc") || request["jsonrpc"].as_string() != "2.0") {
+                    if (!request.jsonrpc.valid() || *request.jsonrpc != "2.0") {
                         return msg.error(JSON_RPC_INVALID_REQUEST, "jsonrpc value is not \"2.0\"");
-                    } else if (!request.contains("method")) {
-                        return msg.error(JSON_RPC_INVALID_REQUEST, "A member \"method\" does not exist");
+                    } else if (!request.method.valid()) {
+                        return msg.error(JSON_RPC_INVALID_REQUEST, "A member \"method\" does not exist or is not a string");
                     }
 
-                    string method;
-
-                    try {
-                        method = request["method"].as_string();
-                    } catch (const fc::assert_exception &e) {
-                        return msg.error(JSON_RPC_METHOD_NOT_FOUND, e);
-                    }
+                    const string &method = *request.method;
 
                     // This is to maintain backwards compatibility with existing call structure.
-                    if ((method == "call" && request.contains("params")) || method != "call") {
+                    if ((method == "call" && request.params.valid()) || method != "call") {
                         api_method *call = nullptr;
 
                         try {
@@ -242,10 +323,41 @@ namespace golos {
                             return msg.error(JSON_RPC_PARSE_PARAMS_ERROR, e);
                         }
 
+                        fc::optional<api_cache::ticket> ticket;
+                        if (_cache.enabled()) {
+                            auto cache_scope = find_cache_scope(msg.plugin, msg.method);
+                            if (api_cache_scope::none != cache_scope) {
+                                ticket = _cache.make_ticket(msg, cache_scope);
+                                auto cached = _cache.find(*ticket);
+                                if (cached.valid()) {
+                                    return msg.raw_result(std::move(*cached));
+                                }
+                            }
+                        }
+
+                        auto json_call = find_json_method(msg.plugin, msg.method);
+
                         try {
-                            auto result = (*call)(msg);
-                            if (msg.valid()) {
-                                msg.result(std::move(result));
+                            // Responses of delegated calls (see msg_pack_transfer) are not cached
+                            if (json_call != nullptr) {
+                                auto json = (*json_call)(msg);
+                                if (msg.valid()) {
+                                    if (ticket.valid()) {
+                                        _cache.store(*ticket, json);
+                                    }
+                                    msg.raw_result(std::move(json));
+                                }
+                            } else {
+                                auto result = (*call)(msg);
+                                if (msg.valid()) {
+                                    if (ticket.valid()) {
+                                        auto json = fc::json::to_string(result);
+                                        _cache.store(*ticket, json);
+                                        msg.raw_result(std::move(json));
+                                    } else {
+                                        msg.result(std::move(result));
+                                    }
+                                }
                             }
                         } catch (const fc::assert_exception &e) {
                             return msg.error(JSON_RPC_ERROR_DURING_CALL, e);
@@ -256,22 +368,22 @@ namespace golos {
                 }
 
                 struct dump_rpc_time {
-                    dump_rpc_time(const fc::variant& data)
+                    dump_rpc_time(const json_span& data)
                         : data_(data) {
 
-                        dlog("data: ${data}", ("data", fc::json::to_string(data_)));
+                        dlog("data: ${data}", ("data", data_.str()));
                     }
 
                     ~dump_rpc_time() {
                         if (error_.empty()) {
                             dlog(
                                 "elapsed: ${time} sec, data: ${data}",
-                                ("data", fc::json::to_string(data_))
+                                ("data", data_.str())
                                 ("time", double((fc::time_point::now() - start_).count()) / 1000000.0));
                         } else {
                             dlog(
                                 "elapsed: ${time} sec, error: '${error}', data: ${data}",
-                                ("data", fc::json::to_string(data_))
+                                ("data", data_.str())
                                 ("error", error_)
                                 ("time", double((fc::time_point::now() - start_).count()) / 1000000.0));
                         }
@@ -284,14 +396,19 @@ namespace golos {
                 private:
                     fc::time_point start_ = fc::time_point::now();
                     std::string error_;
-                    const fc::variant& data_;
+                    const json_span& data_;
                 };
 
-                void rpc(const fc::variant& data, msg_pack& msg) {
+                // The request can be already scanned by the caller, then it isn't scanned again
+                void rpc(const json_span& data, msg_pack& msg, const parsed_request* request = nullptr) {
                     dump_rpc_time dump(data);
 
                     try {
-                        rpc_jsonrpc(data.get_object(), msg);
+                        if (request != nullptr) {
+                            rpc_jsonrpc(*request, msg);
+                        } else {
+                            rpc_jsonrpc(request_parser::parse(data), msg);
+                        }
                     } catch (const fc::parse_error_exception& e) {
                         msg.error(JSON_RPC_INVALID_PARAMS, e);
                         dump.error("invalid params");
@@ -310,29 +427,105 @@ namespace golos {
                     }
                 }
 
-                void rpc(vector<fc::variant> messages, response_handler_type response_handler) {
-                    auto responses = std::make_shared<vector<json_rpc_response>>();
+                // Elements of a batch are executed in parallel, but the response keeps their order
+                struct batch_state final {
+                    batch_state(std::string b, response_handler_type h)
+                        : body(std::move(b)),
+                          messages(request_parser::split_batch(body)),
+                          responses(messages.size()),
+                          response_handler(std::move(h)) {
+                    }
 
-                    responses->reserve(messages.size());
+                    std::string body; // messages point to it
+                    vector<json_span> messages;
+                    vector<json_rpc_response> responses;
+                    response_handler_type response_handler;
+                    std::atomic<std::size_t> next_message{0};
+                    std::atomic<std::size_t> completed_messages{0};
+                };
 
-                    std::function<void()> next_handler = [response_handler, responses]{
-                        response_handler(fc::json::to_string(*responses.get()));
-                    };
+                // State of one element, shared by the worker and the handler of the response
+                struct batch_call final {
+                    enum : int {running, returned, completed};
 
-                    for (auto it = messages.rbegin(); messages.rend() != it; ++it) {
-                        auto v = *it;
+                    std::atomic<int> state{running};
+                    std::size_t next = 0;
+                };
+
+                // Stores the response of the element and returns the next element for the caller to execute
+                std::size_t complete_batch_element(batch_state &batch, std::size_t idx, json_rpc_response &response) {
+                    batch.responses[idx] = response;
+
+                    auto next = batch.next_message++;
+                    if (++batch.completed_messages == batch.messages.size()) {
+                        batch.response_handler(to_json(batch.responses));
+                    }
+                    return next;
+                }
+
+                static fc::variant batch_element_id(const json_span &element) {
+                    try {
+                        auto request = request_parser::parse(element);
+                        if (request.id.valid()) {
+                            return request_parser::parse_value(*request.id);
+                        }
+                    } catch (...) {
+                        // the id is unknown for a malformed request
+                    }
+                    return fc::variant();
+                }
+
+                // Elements completed inside rpc() are continued by the loop instead of the recursion,
+                //   so the stack doesn't grow with the batch size when the executor runs tasks inline
+                void rpc_batch_worker(std::shared_ptr<batch_state> batch, std::size_t idx) {
+                    while (idx < batch->messages.size()) {
+                        auto call = std::make_shared<batch_call>();
+
+                        msg_pack msg([this, batch, idx, call](json_rpc_response &response) {
+                            call->next = complete_batch_element(*batch, idx, response);
+                            // the worker has already returned, so the next element is scheduled from here
+                            if (call->state.exchange(batch_call::completed) == batch_call::returned) {
+                                schedule_batch_element(batch, call->next);
+                            }
+                        });
 
-                        next_handler = [next_handler, responses, v, this]{
-                            msg_pack msg([next_handler, responses](json_rpc_response &response){
-                                responses->push_back(response);
-                                next_handler();
-                            });
+                        this->rpc(batch->messages[idx], msg);
 
-                            this->rpc(v, msg);
-                        };
+                        if (call->state.exchange(batch_call::returned) != batch_call::completed) {
+                            return; // the response will be passed from another thread (see msg_pack_transfer)
+                        }
+                        idx = call->next;
                     }
+                }
+
+                void schedule_batch_element(std::shared_ptr<batch_state> batch, std::size_t idx) {
+                    while (idx < batch->messages.size()) {
+                        if (_executor([this, batch, idx]() { this->rpc_batch_worker(batch, idx); })) {
+                            return;
+                        }
+
+                        // The executor is overloaded, so the element is answered without executing
+                        json_rpc_response response;
+                        response.error = json_rpc_error(JSON_RPC_SERVER_ERROR, "Server is busy, try again later");
+                        response.id = batch_element_id(batch->messages[idx]);
+                        idx = complete_batch_element(*batch, idx, response);
+                    }
+                }
 
-                    next_handler();
+                void rpc_batch(const string &body, response_handler_type response_handler) {
+                    auto batch = std::make_shared<batch_state>(body, std::move(response_handler));
+
+                    FC_ASSERT(batch->messages.size(), "Array is invalid");
+                    FC_ASSERT(batch->messages.size() <= _batch_size_limit,
+                        "Batch contains ${n} requests, but only ${limit} are allowed",
+                        ("n", batch->messages.size())("limit", _batch_size_limit));
+
+                    auto concurrency = std::min<std::size_t>(_batch_concurrency, batch->messages.size());
+
+                    batch->next_message = concurrency;
+                    for (std::size_t idx = 0; idx < concurrency; ++idx) {
+                        schedule_batch_element(batch, idx);
+                    }
                 }
 
                 void initialize() {
@@ -359,6 +552,18 @@ namespace golos {
                 map<string, api_description> _registered_apis;
                 vector<string> _methods;
                 map<string, map<string, api_method_signature> > _method_sigs;
+                map<string, map<string, api_cache_scope> > _cache_scopes;
+                map<string, map<string, api_json_method> > _json_apis;
+
+                api_cache _cache;
+                uint32_t _cache_head_changes = 0;
+
+                uint32_t _batch_size_limit = 0;
+                uint32_t _batch_concurrency = 1;
+                executor_type _executor = [](std::function<void()> task) {
+                    task();
+                    return true;
+                };
             private:
                 // This is a reindex which allows to get parent plugin by method
                 // unordered_map[method] -> plugin
@@ -375,10 +580,34 @@ namespace golos {
             plugin::~plugin() {
             }
 
+            void plugin::set_program_options(boost::program_options::options_description &,
+                                             boost::program_options::options_description &cfg) {
+                cfg.add_options()
+                    ("json-rpc-cache-entries", boost::program_options::value<uint32_t>()->default_value(0),
+                        "Maximum number of cached responses of read-only API methods. Default: 0 (cache is disabled).")
+                    ("json-rpc-cache-size", boost::program_options::value<std::string>()->default_value("64M"),
+                        "Maximum size of cached responses of read-only API methods. Default: 64M")
+                    ("json-rpc-batch-size-limit", boost::program_options::value<uint32_t>()->default_value(1000),
+                        "Maximum number of requests in one batch. Default: 1000")
+                    ("json-rpc-batch-concurrency", boost::program_options::value<uint32_t>()->default_value(8),
+                        "Maximum number of requests from one batch executed in parallel. Default: 8");
+            }
+
             void plugin::plugin_initialize(const boost::program_options::variables_map &options) {
                 ilog("json_rpc plugin: plugin_initialize() begin");
                 pimpl = std::make_unique<impl>();
                 pimpl->initialize();
+
+                auto cache_entries = options.at("json-rpc-cache-entries").as<uint32_t>();
+                auto cache_size = fc::parse_size(options.at("json-rpc-cache-size").as<std::string>());
+                pimpl->_cache.configure(cache_entries, cache_size);
+
+                pimpl->_batch_size_limit = options.at("json-rpc-batch-size-limit").as<uint32_t>();
+                pimpl->_batch_concurrency = options.at("json-rpc-batch-concurrency").as<uint32_t>();
+                FC_ASSERT(pimpl->_batch_concurrency > 0, "json-rpc-batch-concurrency must be greater than 0");
+                if (pimpl->_cache.enabled()) {
+                    ilog("json_rpc plugin: caching up to ${n} responses of ${s} bytes", ("n", cache_entries)("s", cache_size));
+                }
                 ilog("json_rpc plugin: plugin_initialize() end");
             }
 
@@ -390,30 +619,53 @@ namespace golos {
 
             void plugin::plugin_shutdown() {
                 ilog("json_rpc plugin: plugin_shutdown() begin");
+                if (pimpl->_cache.enabled()) {
+                    ilog("json_rpc plugin: cache statistics ${s}", ("s", pimpl->_cache.statistics()));
+                }
 
                 ilog("json_rpc plugin: plugin_shutdown() end");
             }
 
             void plugin::add_api_method(const string &api_name, const string &method_name,
-                                        const api_method &api/*, const api_method_signature& sig */) {
-                pimpl->add_api_method(api_name, method_name, api/*, sig*/ );
+                                        const api_method &api/*, const api_method_signature& sig */,
+                                        api_cache_scope cache_scope, const api_json_method &json_api) {
+                pimpl->add_api_method(api_name, method_name, api/*, sig*/, cache_scope, json_api);
             }
 
-            void plugin::call(const string &message, response_handler_type response_handler) {
-                try {
-                    fc::variant v = fc::json::from_string(message);
+            void plugin::set_cache_head(const fc::ripemd160 &head_block_id, uint32_t last_irreversible_block_num) {
+                if (!pimpl->_cache.enabled()) {
+                    return;
+                }
 
-                    if (v.is_array()) {
-                        vector<fc::variant> messages = v.as<vector<fc::variant>>();
+                pimpl->_cache.set_head(head_block_id, last_irreversible_block_num);
+
+                // each hour
+                if (++pimpl->_cache_head_changes % 1200 == 0) {
+                    ilog("json_rpc plugin: cache statistics ${s}", ("s", pimpl->_cache.statistics()));
+                }
+            }
+
+            api_cache_statistics plugin::get_cache_statistics() const {
+                return pimpl->_cache.statistics();
+            }
 
-                        FC_ASSERT(messages.size(), "Array is invalid");
-                        pimpl->rpc(messages, response_handler);
+            void plugin::set_executor(executor_type executor) {
+                pimpl->_executor = std::move(executor);
+            }
+
+            void plugin::call(const string &message, response_handler_type response_handler) {
+                try {
+                    if (request_parser::is_batch(message)) {
+                        pimpl->rpc_batch(message, response_handler);
                     } else {
                         msg_pack msg([response_handler](json_rpc_response &response){
-                            response_handler(fc::json::to_string(response));
+                            response_handler(to_json(response));
                         });
 
-                        pimpl->rpc(v, msg);
+                        json_span request;
+                        request.begin = message.data();
+                        request.end = message.data() + message.size();
+                        pimpl->rpc(request, msg);
                     }
                 } catch (const fc::exception &e) {
                     json_rpc_response response;
@@ -421,6 +673,20 @@ namespace golos {
                     response_handler(fc::json::to_string(response));
                 }
             }
+
+            void plugin::call(const parsed_request &request, response_handler_type response_handler) {
+                try {
+                    msg_pack msg([response_handler](json_rpc_response &response){
+                        response_handler(to_json(response));
+                    });
+
+                    pimpl->rpc(request.body, msg, &request);
+                } catch (const fc::exception &e) {
+                    json_rpc_response response;
+                    response.error = json_rpc_error(JSON_RPC_SERVER_ERROR, e.to_string(), fc::variant(*(e.dynamic_copy_exception())));
+                    response_handler(fc::json::to_string(response));
+                }
+            }
         }
     }
 } // golos::plugins::json_rpc
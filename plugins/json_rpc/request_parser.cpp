@@ -0,0 +1,233 @@
+#include <golos/plugins/json_rpc/request_parser.hpp>
+
+#include <fc/io/json.hpp>
+#include <fc/exception/exception.hpp>
+
+namespace golos {
+    namespace plugins {
+        namespace json_rpc {
+
+            namespace {
+                bool is_space(char c) {
+                    return c == ' ' || c == '\t' || c == '\n' || c == '\r';
+                }
+
+                const char *skip_spaces(const char *p, const char *end) {
+                    while (p < end && is_space(*p)) {
+                        ++p;
+                    }
+                    return p;
+                }
+
+                // p points to the opening quote, returns the position after the closing quote
+                const char *skip_string(const char *p, const char *end, bool &has_escapes) {
+                    for (++p; p < end; ++p) {
+                        if (*p == '\\') {
+                            has_escapes = true;
+                            ++p;
+                        } else if (*p == '"') {
+                            return p + 1;
+                        }
+                    }
+                    FC_THROW_EXCEPTION(fc::parse_error_exception, "Unexpected end of string");
+                }
+
+                // Values are not validated here, they are validated on parsing
+                const char *skip_value(const char *p, const char *end) {
+                    bool has_escapes = false;
+
+                    if (p >= end) {
+                        FC_THROW_EXCEPTION(fc::parse_error_exception, "Value is expected");
+                    }
+
+                    if (*p == '"') {
+                        return skip_string(p, end, has_escapes);
+                    }
+
+                    if (*p == '{' || *p == '[') {
+                        uint32_t depth = 0;
+                        while (p < end) {
+                            if (*p == '"') {
+                                p = skip_string(p, end, has_escapes);
+                                continue;
+                            } else if (*p == '{' || *p == '[') {
+                                ++depth;
+                            } else if (*p == '}' || *p == ']') {
+                                if (--depth == 0) {
+                                    return p + 1;
+                                }
+                            }
+                            ++p;
+                        }
+                        FC_THROW_EXCEPTION(fc::parse_error_exception, "Unexpected end of object or array");
+                    }
+
+                    // number, true, false, null
+                    auto start = p;
+                    while (p < end && *p != ',' && *p != '}' && *p != ']' && !is_space(*p)) {
+                        ++p;
+                    }
+                    if (p == start) {
+                        FC_THROW_EXCEPTION(fc::parse_error_exception, "Value is expected");
+                    }
+                    return p;
+                }
+
+                bool is_string(json_span span) {
+                    return !span.empty() && *span.begin == '"';
+                }
+
+                // The span should be a string, which is already checked by the scanner
+                std::string decode_string(json_span span) {
+                    for (auto p = span.begin + 1; p < span.end - 1; ++p) {
+                        if (*p == '\\') {
+                            return fc::json::from_string(span.str()).as_string();
+                        }
+                    }
+                    return std::string(span.begin + 1, span.end - 1);
+                }
+            }
+
+            bool request_parser::is_batch(const std::string &body) {
+                auto end = body.data() + body.size();
+                auto p = skip_spaces(body.data(), end);
+                return p < end && *p == '[';
+            }
+
+            std::vector<json_span> request_parser::split_batch(const std::string &body) {
+                json_span span;
+                span.begin = body.data();
+                span.end = body.data() + body.size();
+                return split_array(span);
+            }
+
+            std::vector<json_span> request_parser::split_array(json_span span, std::size_t max_size) {
+                std::vector<json_span> result;
+
+                auto end = span.end;
+                auto p = skip_spaces(span.begin, end);
+                FC_ASSERT(p < end && *p == '[', "Value should be an array");
+
+                p = skip_spaces(p + 1, end);
+                if (p < end && *p == ']') {
+                    p = skip_spaces(p + 1, end);
+                } else {
+                    while (true) {
+                        json_span element;
+                        element.begin = p;
+                        element.end = p = skip_value(p, end);
+                        result.push_back(element);
+                        if (result.size() >= max_size) {
+                            return result;
+                        }
+
+                        p = skip_spaces(p, end);
+                        if (p < end && *p == ',') {
+                            p = skip_spaces(p + 1, end);
+                        } else if (p < end && *p == ']') {
+                            p = skip_spaces(p + 1, end);
+                            break;
+                        } else {
+                            FC_THROW_EXCEPTION(fc::parse_error_exception, "Expected ',' or ']' in array");
+                        }
+                    }
+                }
+
+                if (p != end) {
+                    FC_THROW_EXCEPTION(fc::parse_error_exception, "Unexpected data after array");
+                }
+
+                return result;
+            }
+
+            parsed_request request_parser::parse(json_span request) {
+                parsed_request result;
+                result.body = request;
+
+                auto end = request.end;
+                auto p = skip_spaces(request.begin, end);
+                if (p >= end || *p != '{') {
+                    FC_THROW_EXCEPTION(fc::parse_error_exception, "Request should be an object");
+                }
+
+                p = skip_spaces(p + 1, end);
+                if (p < end && *p == '}') {
+                    p = skip_spaces(p + 1, end);
+                } else {
+                    while (true) {
+                        if (p >= end || *p != '"') {
+                            FC_THROW_EXCEPTION(fc::parse_error_exception, "Name of member is expected");
+                        }
+
+                        json_span key;
+                        bool has_escapes = false;
+                        key.begin = p;
+                        key.end = p = skip_string(p, end, has_escapes);
+
+                        p = skip_spaces(p, end);
+                        if (p >= end || *p != ':') {
+                            FC_THROW_EXCEPTION(fc::parse_error_exception, "Expected ':' after name of member");
+                        }
+
+                        json_span value;
+                        value.begin = p = skip_spaces(p + 1, end);
+                        value.end = p = skip_value(p, end);
+
+                        auto name = has_escapes ? decode_string(key) : std::string(key.begin + 1, key.end - 1);
+                        // a member of a wrong type is left empty, so the request is invalid
+                        if (name == "jsonrpc") {
+                            if (is_string(value)) {
+                                result.jsonrpc = decode_string(value);
+                            }
+                        } else if (name == "method") {
+                            if (is_string(value)) {
+                                result.method = decode_string(value);
+                            }
+                        } else if (name == "id") {
+                            result.id = value;
+                        } else if (name == "params") {
+                            result.params = value;
+                        }
+
+                        p = skip_spaces(p, end);
+                        if (p < end && *p == ',') {
+                            p = skip_spaces(p + 1, end);
+                        } else if (p < end && *p == '}') {
+                            p = skip_spaces(p + 1, end);
+                            break;
+                        } else {
+                            FC_THROW_EXCEPTION(fc::parse_error_exception, "Expected ',' or '}' in request");
+                        }
+                    }
+                }
+
+                if (p != end) {
+                    FC_THROW_EXCEPTION(fc::parse_error_exception, "Unexpected data after request");
+                }
+
+                return result;
+            }
+
+            std::vector<fc::variant> request_parser::parse_array(json_span span) {
+                auto value = parse_value(span);
+                if (!value.is_array()) {
+                    FC_THROW_EXCEPTION(fc::parse_error_exception, "Array is expected");
+                }
+                return std::move(value.get_array());
+            }
+
+            std::string request_parser::parse_string(json_span span) {
+                if (is_string(span)) {
+                    return decode_string(span);
+                }
+                // a scalar is converted to a string as fc::variant::as_string() does
+                return parse_value(span).as_string();
+            }
+
+            fc::variant request_parser::parse_value(json_span span) {
+                return fc::json::from_string(span.str());
+            }
+
+        }
+    }
+} // golos::plugins::json_rpc
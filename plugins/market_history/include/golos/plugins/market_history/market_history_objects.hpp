@@ -34,9 +34,13 @@ namespace golos {
 
             enum market_history_object_types {
                 bucket_object_type = (MARKET_HISTORY_SPACE_ID << 8),
-                order_history_object_type = (MARKET_HISTORY_SPACE_ID << 8) + 1
+                order_history_object_type = (MARKET_HISTORY_SPACE_ID << 8) + 1,
+                market_history_layout_object_type = (MARKET_HISTORY_SPACE_ID << 8) + 2
             };
 
+            // Changed with the layout of the plugin objects in the shared memory, a change requires a replay
+            constexpr uint32_t market_history_layout_version = 2;
+
             // Api params
             struct market_ticker {
                 double latest = 0;
@@ -97,7 +101,8 @@ namespace golos {
                 double real_price = 0;
                 bool rewarded = false;
             };
-          
+
+            // OHLCV of a time interval, buckets are kept in memory of the plugin, not in the shared memory
             struct bucket_object
                     : public object<bucket_object_type, bucket_object> {
                 template<typename Constructor, typename Allocator>
@@ -136,7 +141,10 @@ namespace golos {
 
             typedef object_id <bucket_object> bucket_id_type;
 
-
+            /**
+             * Trade of a reversible block, it is moved to the memory of the plugin
+             * when the block becomes irreversible, so the shared memory keeps only the recent trades
+             */
             struct order_history_object
                     : public object<order_history_object_type, order_history_object> {
                 template<typename Constructor, typename Allocator>
@@ -146,6 +154,7 @@ namespace golos {
 
                 id_type id;
 
+                uint32_t block_num = 0;
                 fc::time_point_sec time;
                 golos::protocol::fill_order_operation op;
             };
@@ -153,23 +162,6 @@ namespace golos {
             typedef object_id <order_history_object> order_history_id_type;
 
             struct by_id;
-            struct by_bucket;
-            typedef multi_index_container <
-            bucket_object,
-            indexed_by<
-                    ordered_unique < tag < by_id>, member<bucket_object, bucket_id_type, &bucket_object::id>>,
-            ordered_unique <tag<by_bucket>,
-            composite_key<bucket_object,
-                    member < bucket_object, uint32_t, &bucket_object::seconds>,
-            member<bucket_object, fc::time_point_sec, &bucket_object::open>
-            >,
-            composite_key_compare <std::less<uint32_t>, std::less<fc::time_point_sec>>
-            >
-            >,
-            allocator <bucket_object>
-            >
-            bucket_index;
-
             struct by_time;
             typedef multi_index_container <
             order_history_object,
@@ -181,6 +173,44 @@ namespace golos {
             allocator <order_history_object>
             >
             order_history_index;
+
+            /**
+             * Layout version of the plugin objects, it is created on applying of the first block.
+             * The shared memory of an older layout has no such object, so it isn't opened without a replay,
+             *   even if the size of order_history_object is the same.
+             */
+            struct market_history_layout_object
+                    : public object<market_history_layout_object_type, market_history_layout_object> {
+                template<typename Constructor, typename Allocator>
+                market_history_layout_object(Constructor &&c, allocator <Allocator> a) {
+                    c(*this);
+                }
+
+                id_type id;
+
+                uint32_t version = 0;
+            };
+
+            typedef multi_index_container <
+            market_history_layout_object,
+            indexed_by<
+                    ordered_unique < tag <
+                    by_id>, member<market_history_layout_object, market_history_layout_object::id_type, &market_history_layout_object::id>>
+            >,
+            allocator <market_history_layout_object>
+            >
+            market_history_layout_index;
+
+            /**
+             * Irreversible market history written to the data directory on shutdown.
+             * It contains trades up to the last irreversible block, which is the head block after reopening
+             *   of the database, so it is loaded only if the chain continues from the next block.
+             */
+            struct market_history_snapshot {
+                uint32_t last_irreversible_block_num = 0;
+                std::vector<bucket_object> buckets; // ordered by (seconds, open)
+                std::vector<market_trade> trades; // ordered by date
+            };
         }
     }
 } // golos::plugins::market_history
@@ -210,7 +240,12 @@ FC_REFLECT((golos::plugins::market_history::bucket_object),
                    (open_steem)(open_sbd)
                    (close_steem)(close_sbd)
                    (steem_volume)(sbd_volume))
-CHAINBASE_SET_INDEX_TYPE(golos::plugins::market_history::bucket_object, golos::plugins::market_history::bucket_index)
 
-FC_REFLECT((golos::plugins::market_history::order_history_object),(id)(time)(op))
+FC_REFLECT((golos::plugins::market_history::order_history_object), (id)(block_num)(time)(op))
 CHAINBASE_SET_INDEX_TYPE(golos::plugins::market_history::order_history_object, golos::plugins::market_history::order_history_index)
+
+FC_REFLECT((golos::plugins::market_history::market_history_layout_object), (id)(version))
+CHAINBASE_SET_INDEX_TYPE(golos::plugins::market_history::market_history_layout_object, golos::plugins::market_history::market_history_layout_index)
+
+FC_REFLECT((golos::plugins::market_history::market_history_snapshot),
+           (last_irreversible_block_num)(buckets)(trades))
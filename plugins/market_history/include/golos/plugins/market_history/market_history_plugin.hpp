@@ -42,7 +42,7 @@ namespace golos {
             class market_history_plugin : public appbase::plugin<market_history_plugin> {
             public:
 
-                APPBASE_PLUGIN_REQUIRES((json_rpc::plugin))
+                APPBASE_PLUGIN_REQUIRES((chain::plugin)(json_rpc::plugin))
 
                 market_history_plugin();
 
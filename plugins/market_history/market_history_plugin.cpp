@@ -4,7 +4,16 @@
 #include <golos/chain/operation_notification.hpp>
 #include <golos/chain/steem_objects.hpp>
 #include <golos/chain/account_object.hpp>
+#include <golos/chain/database_exceptions.hpp>
 
+#include <fc/filesystem.hpp>
+#include <fc/io/fstream.hpp>
+
+#include <boost/circular_buffer.hpp>
+
+#include <algorithm>
+#include <fstream>
+#include <mutex>
 
 
 #define CHECK_ARG_SIZE(s) \
@@ -16,8 +25,81 @@ namespace golos {
         namespace market_history {
 
             using golos::protocol::fill_order_operation;
+            using golos::protocol::limit_order_create_operation;
+            using golos::protocol::limit_order_create2_operation;
+            using golos::protocol::limit_order_cancel_operation;
             using golos::chain::operation_notification;
 
+            namespace {
+                template<typename Buckets>
+                void apply_trade(Buckets &buckets, uint32_t seconds, const market_trade &trade) {
+                    auto open = fc::time_point_sec((trade.date.sec_since_epoch() / seconds) * seconds);
+
+                    share_type steem;
+                    share_type sbd;
+                    if (trade.open_pays.symbol == STEEM_SYMBOL) {
+                        steem = trade.open_pays.amount;
+                        sbd = trade.current_pays.amount;
+                    } else {
+                        steem = trade.current_pays.amount;
+                        sbd = trade.open_pays.amount;
+                    }
+
+                    // Trades come in order of time, so only the last bucket can be changed
+                    if (buckets.empty() || buckets.back().open != open) {
+                        bucket_object b;
+                        b.open = open;
+                        b.seconds = seconds;
+                        b.high_steem = steem;
+                        b.high_sbd = sbd;
+                        b.low_steem = steem;
+                        b.low_sbd = sbd;
+                        b.open_steem = steem;
+                        b.open_sbd = sbd;
+                        b.close_steem = steem;
+                        b.close_sbd = sbd;
+                        b.steem_volume = steem;
+                        b.sbd_volume = sbd;
+                        buckets.push_back(b);
+                        return;
+                    }
+
+                    auto &b = buckets.back();
+                    auto trade_price = asset(sbd, SBD_SYMBOL) / asset(steem, STEEM_SYMBOL);
+
+                    b.steem_volume += steem;
+                    b.sbd_volume += sbd;
+                    b.close_steem = steem;
+                    b.close_sbd = sbd;
+
+                    if (b.high() < trade_price) {
+                        b.high_steem = steem;
+                        b.high_sbd = sbd;
+                    }
+
+                    if (b.low() > trade_price) {
+                        b.low_steem = steem;
+                        b.low_sbd = sbd;
+                    }
+                }
+
+                bool bucket_open_less(const bucket_object &b, const fc::time_point_sec &open) {
+                    return b.open < open;
+                }
+
+                bool trade_date_less(const market_trade &t, const fc::time_point_sec &date) {
+                    return t.date < date;
+                }
+
+                market_trade to_market_trade(const order_history_object &o) {
+                    market_trade trade;
+                    trade.date = o.time;
+                    trade.current_pays = o.op.current_pays;
+                    trade.open_pays = o.op.open_pays;
+                    return trade;
+                }
+            }
+
 
             class market_history_plugin::market_history_plugin_impl {
             public:
@@ -43,6 +125,23 @@ namespace golos {
 
                 void update_market_histories(const golos::chain::operation_notification &o);
 
+                void on_applied_block(const signed_block &block);
+
+                void commit_trade(const market_trade &trade);
+
+                order_book build_order_book(uint32_t limit) const;
+
+                market_volume build_volume() const;
+
+                fc::path snapshot_path() const;
+
+                // Checks the layout of the plugin objects and loads the saved history before the given block
+                void check_history(uint32_t next_block_num);
+
+                void save_snapshot() const;
+
+                void clear_history();
+
                 golos::chain::database &database() const {
                     return _db;
                 }
@@ -52,133 +151,108 @@ namespace golos {
 
                 int32_t _maximum_history_per_bucket_size = 1000;
 
+                uint32_t _maximum_trades = 100000;
+
+                // History of irreversible blocks isn't stored in the shared memory. It is changed under the write lock
+                // of the database (on applying of blocks) and is read under its read lock.
+                // Trades of reversible blocks are order_history_objects, so they are undone with their blocks.
+
+                // The oldest entries are overwritten when buffers are full
+                std::map<uint32_t, boost::circular_buffer<bucket_object>> _buckets;
+                boost::circular_buffer<market_trade> _trades;
+
+                // Trades of blocks up to this one are moved to _buckets and _trades
+                uint32_t _last_irreversible_block_num = 0;
+
+                // The saved history is checked on startup or on applying of the first block, which comes first
+                bool _history_checked = false;
+
+                // Changed on each change of limit orders or trades, invalidates the cached results
+                uint64_t _revision = 0;
+
+                static constexpr uint32_t _order_book_depth = 500;
+
+                mutable std::mutex _cache_mutex;
+                mutable uint64_t _order_book_revision = 0;
+                mutable fc::optional<order_book> _order_book;
+                mutable uint64_t _volume_revision = 0;
+                mutable fc::optional<market_volume> _volume;
+
                 golos::chain::database &_db;
             };
 
             void market_history_plugin::market_history_plugin_impl::update_market_histories(const operation_notification &o) {
-                if (o.op.which() ==
-                    operation::tag<fill_order_operation>::value) {
+                if (o.op.which() == operation::tag<fill_order_operation>::value) {
                     fill_order_operation op = o.op.get<fill_order_operation>();
 
                     auto &db = database();
-                    const auto &bucket_idx = db.get_index<bucket_index>().indices().get<by_bucket>();
 
                     db.create<order_history_object>([&](order_history_object &ho) {
+                        ho.block_num = o.block;
                         ho.time = db.head_block_time();
                         ho.op = op;
                     });
 
-                    if (!_maximum_history_per_bucket_size) {
-                        return;
-                    }
-                    if (!_tracked_buckets.size()) {
-                        return;
-                    }
+                    ++_revision;
+                } else if (o.op.which() == operation::tag<limit_order_create_operation>::value ||
+                           o.op.which() == operation::tag<limit_order_create2_operation>::value ||
+                           o.op.which() == operation::tag<limit_order_cancel_operation>::value
+                ) {
+                    ++_revision;
+                }
+            }
 
-                    for (auto bucket : _tracked_buckets) {
-                        auto cutoff = db.head_block_time() - fc::seconds(
-                                bucket * _maximum_history_per_bucket_size);
-
-                        auto open = fc::time_point_sec(
-                                (db.head_block_time().sec_since_epoch() /
-                                 bucket) * bucket);
-                        auto seconds = bucket;
-
-                        auto itr = bucket_idx.find(boost::make_tuple(seconds, open));
-                        if (itr == bucket_idx.end()) {
-                            db.create<bucket_object>([&](bucket_object &b) {
-                                b.open = open;
-                                b.seconds = bucket;
-
-                                if (op.open_pays.symbol == STEEM_SYMBOL) {
-                                    b.high_steem = op.open_pays.amount;
-                                    b.high_sbd = op.current_pays.amount;
-                                    b.low_steem = op.open_pays.amount;
-                                    b.low_sbd = op.current_pays.amount;
-                                    b.open_steem = op.open_pays.amount;
-                                    b.open_sbd = op.current_pays.amount;
-                                    b.close_steem = op.open_pays.amount;
-                                    b.close_sbd = op.current_pays.amount;
-                                    b.steem_volume = op.open_pays.amount;
-                                    b.sbd_volume = op.current_pays.amount;
-                                } else {
-                                    b.high_steem = op.current_pays.amount;
-                                    b.high_sbd = op.open_pays.amount;
-                                    b.low_steem = op.current_pays.amount;
-                                    b.low_sbd = op.open_pays.amount;
-                                    b.open_steem = op.current_pays.amount;
-                                    b.open_sbd = op.open_pays.amount;
-                                    b.close_steem = op.current_pays.amount;
-                                    b.close_sbd = op.open_pays.amount;
-                                    b.steem_volume = op.current_pays.amount;
-                                    b.sbd_volume = op.open_pays.amount;
-                                }
-                            });
-                        } else {
-                            db.modify(*itr, [&](bucket_object &b) {
-                                if (op.open_pays.symbol == STEEM_SYMBOL) {
-                                    b.steem_volume += op.open_pays.amount;
-                                    b.sbd_volume += op.current_pays.amount;
-                                    b.close_steem = op.open_pays.amount;
-                                    b.close_sbd = op.current_pays.amount;
-
-                                    if (b.high() <
-                                        price(op.current_pays, op.open_pays)) {
-                                        b.high_steem = op.open_pays.amount;
-                                        b.high_sbd = op.current_pays.amount;
-                                    }
-
-                                    if (b.low() >
-                                        price(op.current_pays, op.open_pays)) {
-                                        b.low_steem = op.open_pays.amount;
-                                        b.low_sbd = op.current_pays.amount;
-                                    }
-                                } else {
-                                    b.steem_volume += op.current_pays.amount;
-                                    b.sbd_volume += op.open_pays.amount;
-                                    b.close_steem = op.current_pays.amount;
-                                    b.close_sbd = op.open_pays.amount;
-
-                                    if (b.high() <
-                                        price(op.open_pays, op.current_pays)) {
-                                        b.high_steem = op.current_pays.amount;
-                                        b.high_sbd = op.open_pays.amount;
-                                    }
-
-                                    if (b.low() >
-                                        price(op.open_pays, op.current_pays)) {
-                                        b.low_steem = op.current_pays.amount;
-                                        b.low_sbd = op.open_pays.amount;
-                                    }
-                                }
-                            });
-
-                            if (_maximum_history_per_bucket_size > 0) {
-                                open = fc::time_point_sec();
-                                itr = bucket_idx.lower_bound(boost::make_tuple(seconds, open));
-
-                                while (itr->seconds == seconds &&
-                                       itr->open < cutoff) {
-                                    auto old_itr = itr;
-                                    ++itr;
-                                    db.remove(*old_itr);
-                                }
-                            }
-                        }
+            void market_history_plugin::market_history_plugin_impl::on_applied_block(const signed_block &block) {
+                auto &db = database();
+
+                if (block.block_num() == 1 && db.find<market_history_layout_object>() == nullptr) {
+                    db.create<market_history_layout_object>([&](market_history_layout_object &o) {
+                        o.version = market_history_layout_version;
+                    });
+                }
+
+                if (!_history_checked) {
+                    check_history(block.block_num());
+                }
+
+                auto last_irreversible_block_num = db.last_non_undoable_block_num();
+
+                const auto &idx = db.get_index<order_history_index>().indices().get<by_id>();
+                auto itr = idx.begin();
+                while (itr != idx.end() && itr->block_num <= last_irreversible_block_num) {
+                    const auto &trade_object = *itr;
+                    ++itr;
+
+                    // Removing is undone if the current block is popped, then the trade is already in memory
+                    if (trade_object.block_num > _last_irreversible_block_num) {
+                        commit_trade(to_market_trade(trade_object));
                     }
+                    db.remove(trade_object);
+                }
+
+                _last_irreversible_block_num = std::max(_last_irreversible_block_num, last_irreversible_block_num);
+
+                ++_revision;
+            }
+
+            void market_history_plugin::market_history_plugin_impl::commit_trade(const market_trade &trade) {
+                _trades.push_back(trade);
+
+                for (auto &buckets : _buckets) {
+                    apply_trade(buckets.second, buckets.first, trade);
                 }
             }
 
             market_ticker market_history_plugin::market_history_plugin_impl::get_ticker() const {
                 market_ticker result;
-                const auto &bucket_idx = database().get_index<bucket_index>().indices().get<by_bucket>();
-                auto itr = bucket_idx.lower_bound(boost::make_tuple(86400, database().head_block_time() - 86400));
-
-                if (itr != bucket_idx.end()) {
-                    auto open = (asset(itr->open_sbd, SBD_SYMBOL) /
-                                 asset(itr->open_steem, STEEM_SYMBOL)).to_real();
-                    result.latest = (asset(itr->close_sbd, SBD_SYMBOL) /
-                                     asset(itr->close_steem, STEEM_SYMBOL)).to_real();
+                auto day_buckets = get_market_history(86400, database().head_block_time() - 86400, time_point_sec::maximum());
+
+                if (!day_buckets.empty()) {
+                    auto &b = day_buckets.front();
+                    auto open = (asset(b.open_sbd, SBD_SYMBOL) /
+                                 asset(b.open_steem, STEEM_SYMBOL)).to_real();
+                    result.latest = (asset(b.close_sbd, SBD_SYMBOL) /
+                                     asset(b.close_steem, STEEM_SYMBOL)).to_real();
                     result.percent_change =
                             ((result.latest - open) / open) * 100;
                 } else {
@@ -202,29 +276,55 @@ namespace golos {
             }
 
             market_volume market_history_plugin::market_history_plugin_impl::get_volume() const {
-                const auto &bucket_idx = database().get_index<bucket_index>().indices().get<by_bucket>();
-                auto itr = bucket_idx.lower_bound(boost::make_tuple(0, database().head_block_time() - 86400));
+                std::lock_guard<std::mutex> lock(_cache_mutex);
+                if (!_volume.valid() || _volume_revision != _revision) {
+                    _volume = build_volume();
+                    _volume_revision = _revision;
+                }
+                return *_volume;
+            }
+
+            market_volume market_history_plugin::market_history_plugin_impl::build_volume() const {
                 market_volume result;
 
-                if (itr == bucket_idx.end()) {
+                if (_tracked_buckets.empty()) {
                     return result;
                 }
 
-                uint32_t bucket_size = itr->seconds;
-                do {
-                    result.steem_volume.amount += itr->steem_volume;
-                    result.sbd_volume.amount += itr->sbd_volume;
-
-                    ++itr;
-                } while (itr != bucket_idx.end() &&
-                         itr->seconds == bucket_size);
+                // Volume of the last 24 hours by the smallest buckets
+                auto buckets = get_market_history(
+                    *_tracked_buckets.begin(), database().head_block_time() - 86400, time_point_sec::maximum());
+                for (auto &b : buckets) {
+                    result.steem_volume.amount += b.steem_volume;
+                    result.sbd_volume.amount += b.sbd_volume;
+                }
 
                 return result;
             }
 
             order_book market_history_plugin::market_history_plugin_impl::get_order_book(uint32_t limit) const {
-                FC_ASSERT(limit <= 500);
+                FC_ASSERT(limit <= _order_book_depth);
+
+                order_book result;
+                {
+                    std::lock_guard<std::mutex> lock(_cache_mutex);
+                    if (!_order_book.valid() || _order_book_revision != _revision) {
+                        _order_book = build_order_book(_order_book_depth);
+                        _order_book_revision = _revision;
+                    }
 
+                    result.bids.assign(
+                        _order_book->bids.begin(),
+                        _order_book->bids.begin() + std::min<std::size_t>(limit, _order_book->bids.size()));
+                    result.asks.assign(
+                        _order_book->asks.begin(),
+                        _order_book->asks.begin() + std::min<std::size_t>(limit, _order_book->asks.size()));
+                }
+
+                return result;
+            }
+
+            order_book market_history_plugin::market_history_plugin_impl::build_order_book(uint32_t limit) const {
                 const auto &order_idx = database().get_index<golos::chain::limit_order_index>().indices().get<golos::chain::by_price>();
                 auto itr = order_idx.lower_bound(price::max(SBD_SYMBOL, STEEM_SYMBOL));
 
@@ -302,19 +402,20 @@ namespace golos {
             vector<market_trade> market_history_plugin::market_history_plugin_impl::get_trade_history(
                     time_point_sec start, time_point_sec end, uint32_t limit) const {
                 FC_ASSERT(limit <= 1000);
-                const auto &bucket_idx = database().get_index<order_history_index>().indices().get<by_time>();
-                auto itr = bucket_idx.lower_bound(start);
 
                 std::vector<market_trade> result;
 
-                while (itr != bucket_idx.end() && itr->time <= end &&
-                       result.size() < limit) {
-                    market_trade trade;
-                    trade.date = itr->time;
-                    trade.current_pays = itr->op.current_pays;
-                    trade.open_pays = itr->op.open_pays;
-                    result.push_back(trade);
-                    ++itr;
+                auto itr = std::lower_bound(_trades.begin(), _trades.end(), start, trade_date_less);
+                for (; itr != _trades.end() && itr->date <= end && result.size() < limit; ++itr) {
+                    result.push_back(*itr);
+                }
+
+                const auto &idx = database().get_index<order_history_index>().indices().get<by_time>();
+                auto ritr = idx.lower_bound(start);
+                for (; ritr != idx.end() && ritr->time <= end && result.size() < limit; ++ritr) {
+                    if (ritr->block_num > _last_irreversible_block_num) {
+                        result.push_back(to_market_trade(*ritr));
+                    }
                 }
 
                 return result;
@@ -322,18 +423,18 @@ namespace golos {
 
             vector<market_trade> market_history_plugin::market_history_plugin_impl::get_recent_trades(uint32_t limit) const {
                 FC_ASSERT(limit <= 1000);
-                const auto &order_idx = database().get_index<order_history_index>().indices().get<by_time>();
-                auto itr = order_idx.rbegin();
 
                 vector<market_trade> result;
 
-                while (itr != order_idx.rend() && result.size() < limit) {
-                    market_trade trade;
-                    trade.date = itr->time;
-                    trade.current_pays = itr->op.current_pays;
-                    trade.open_pays = itr->op.open_pays;
-                    result.push_back(trade);
-                    ++itr;
+                const auto &idx = database().get_index<order_history_index>().indices().get<by_time>();
+                for (auto ritr = idx.rbegin(); ritr != idx.rend() && result.size() < limit; ++ritr) {
+                    if (ritr->block_num > _last_irreversible_block_num) {
+                        result.push_back(to_market_trade(*ritr));
+                    }
+                }
+
+                for (auto itr = _trades.rbegin(); itr != _trades.rend() && result.size() < limit; ++itr) {
+                    result.push_back(*itr);
                 }
 
                 return result;
@@ -341,21 +442,138 @@ namespace golos {
 
             vector<bucket_object> market_history_plugin::market_history_plugin_impl::get_market_history(
                     uint32_t bucket_seconds, time_point_sec start, time_point_sec end) const {
-                const auto &bucket_idx = database().get_index<bucket_index>().indices().get<by_bucket>();
-                auto itr = bucket_idx.lower_bound(boost::make_tuple(bucket_seconds, start));
-
                 std::vector<bucket_object> result;
 
-                while (itr != bucket_idx.end() &&
-                       itr->seconds == bucket_seconds && itr->open < end) {
+                auto buckets = _buckets.find(bucket_seconds);
+                if (buckets == _buckets.end()) {
+                    return result;
+                }
+
+                auto itr = std::lower_bound(buckets->second.begin(), buckets->second.end(), start, bucket_open_less);
+                for (; itr != buckets->second.end() && itr->open < end; ++itr) {
                     result.push_back(*itr);
+                }
 
-                    ++itr;
+                // Trades of reversible blocks are newer than all stored buckets, they change only the tail.
+                // Removed trades of irreversible blocks can come back after reopening, they are already in memory.
+                const auto &idx = database().get_index<order_history_index>().indices().get<by_time>();
+                for (auto &trade_object : idx) {
+                    if (trade_object.block_num <= _last_irreversible_block_num) {
+                        continue;
+                    }
+                    auto open = fc::time_point_sec((trade_object.time.sec_since_epoch() / bucket_seconds) * bucket_seconds);
+                    if (open < start || open >= end) {
+                        continue;
+                    }
+                    apply_trade(result, bucket_seconds, to_market_trade(trade_object));
                 }
 
                 return result;
             }
 
+            fc::path market_history_plugin::market_history_plugin_impl::snapshot_path() const {
+                return appbase::app().data_dir() / "market_history.bin";
+            }
+
+            void market_history_plugin::market_history_plugin_impl::check_history(uint32_t next_block_num) {
+                auto &db = database();
+
+                // Blocks after the first one are applied only to the shared memory with the current layout
+                if (next_block_num > 1) {
+                    const auto *layout = db.find<market_history_layout_object>();
+                    if (layout == nullptr || layout->version != market_history_layout_version) {
+                        FC_THROW_EXCEPTION(golos::chain::plugin_exception,
+                            "Shared memory has an older layout of market history objects, replay the blockchain");
+                    }
+                }
+
+                auto path = snapshot_path();
+                if (!fc::exists(path)) {
+                    if (next_block_num > 1) {
+                        wlog("There is no saved market history, it starts from block ${n}", ("n", next_block_num));
+                    }
+                    _history_checked = true;
+                    return;
+                }
+
+                // The history is collected again on replaying from the first block
+                if (next_block_num == 1) {
+                    ilog("Market history is replayed, ${p} is ignored", ("p", path.string()));
+                    _history_checked = true;
+                    return;
+                }
+
+                std::string data;
+                fc::read_file_contents(path, data);
+                auto snapshot = fc::raw::unpack<market_history_snapshot>(std::vector<char>(data.begin(), data.end()));
+
+                // Trades are lost or doubled, if the shared memory doesn't continue from the saved block
+                if (snapshot.last_irreversible_block_num + 1 != next_block_num) {
+                    FC_THROW_EXCEPTION(golos::chain::plugin_exception,
+                        "Market history in ${p} is saved on irreversible block ${s}, but the chain continues from block ${n}. "
+                        "Remove the file and replay the blockchain",
+                        ("p", path.string())("s", snapshot.last_irreversible_block_num)("n", next_block_num));
+                }
+
+                clear_history();
+                for (auto &b : snapshot.buckets) {
+                    auto itr = _buckets.find(b.seconds);
+                    if (itr != _buckets.end()) {
+                        itr->second.push_back(b);
+                    }
+                }
+                for (auto &t : snapshot.trades) {
+                    _trades.push_back(t);
+                }
+                _last_irreversible_block_num = snapshot.last_irreversible_block_num;
+                _history_checked = true;
+                ++_revision;
+
+                ilog("Market history is loaded: ${t} trades", ("t", _trades.size()));
+            }
+
+            void market_history_plugin::market_history_plugin_impl::save_snapshot() const {
+                // The saved history isn't replaced, if it wasn't loaded
+                if (!_history_checked) {
+                    return;
+                }
+
+                try {
+                    market_history_snapshot snapshot;
+                    snapshot.last_irreversible_block_num = _last_irreversible_block_num;
+
+                    // Trades of reversible blocks stay in the shared memory
+                    for (auto &buckets : _buckets) {
+                        snapshot.buckets.insert(snapshot.buckets.end(), buckets.second.begin(), buckets.second.end());
+                    }
+                    snapshot.trades.assign(_trades.begin(), _trades.end());
+
+                    // A crash or a full disk during the write shouldn't leave a truncated file instead of the previous one
+                    auto data = fc::raw::pack(snapshot);
+                    auto path = snapshot_path();
+                    fc::path temp_path = path.string() + ".tmp";
+                    {
+                        std::ofstream out(temp_path.string(), std::ios::out | std::ios::binary | std::ios::trunc);
+                        out.write(data.data(), data.size());
+                        out.flush();
+                        FC_ASSERT(out.good(), "Can't write to ${p}", ("p", temp_path.string()));
+                    }
+                    fc::rename(temp_path, path);
+                } catch (const fc::exception &e) {
+                    wlog("Can't save market history: ${e}", ("e", e.to_detail_string()));
+                }
+            }
+
+            void market_history_plugin::market_history_plugin_impl::clear_history() {
+                for (auto &buckets : _buckets) {
+                    buckets.second.clear();
+                }
+                _trades.clear();
+                _last_irreversible_block_num = 0;
+                _history_checked = false;
+                ++_revision;
+            }
+
             flat_set<uint32_t> market_history_plugin::market_history_plugin_impl::get_market_history_buckets() const {
                 return appbase::app().get_plugin<market_history_plugin>().get_tracked_buckets();
             }
@@ -395,7 +613,10 @@ namespace golos {
                          "Track market history by grouping orders into buckets of equal size measured in seconds specified as a JSON array of numbers")
                         ("market-history-buckets-per-size",
                          boost::program_options::value<uint32_t>()->default_value(5760),
-                         "How far back in time to track history for each bucket size, measured in the number of buckets (default: 5760)");
+                         "How far back in time to track history for each bucket size, measured in the number of buckets (default: 5760)")
+                        ("market-history-max-trades",
+                         boost::program_options::value<uint32_t>()->default_value(100000),
+                         "Max number of recent trades kept in memory for get_trade_history and get_recent_trades");
                 cfg.add(cli);
             }
 
@@ -407,8 +628,10 @@ namespace golos {
 
                     db.post_apply_operation.connect(
                             [&](const golos::chain::operation_notification &o) { _my->update_market_histories(o); });
-                    golos::chain::add_plugin_index<bucket_index>(db);
+                    db.applied_block.connect(
+                            [&](const signed_block &b) { _my->on_applied_block(b); });
                     golos::chain::add_plugin_index<order_history_index>(db);
+                    golos::chain::add_plugin_index<market_history_layout_index>(db);
 
                     if (options.count("bucket-size")) {
                         std::string buckets = options["bucket-size"].as<string>();
@@ -417,6 +640,16 @@ namespace golos {
                     if (options.count("history-per-size")) {
                         _my->_maximum_history_per_bucket_size = options["history-per-size"].as<uint32_t>();
                     }
+                    if (options.count("market-history-max-trades")) {
+                        _my->_maximum_trades = options["market-history-max-trades"].as<uint32_t>();
+                    }
+
+                    if (_my->_maximum_history_per_bucket_size > 0) {
+                        for (auto bucket : _my->_tracked_buckets) {
+                            _my->_buckets[bucket].set_capacity(_my->_maximum_history_per_bucket_size);
+                        }
+                    }
+                    _my->_trades.set_capacity(_my->_maximum_trades);
 
                     wlog("bucket-size ${b}", ("b", _my->_tracked_buckets));
                     wlog("history-per-size ${h}", ("h", _my->_maximum_history_per_bucket_size));
@@ -429,12 +662,23 @@ namespace golos {
             void market_history_plugin::plugin_startup() {
                 ilog("market_history plugin: plugin_startup() begin");
 
+                auto &db = _my->database();
+                db.with_weak_read_lock([&]() {
+                    if (!_my->_history_checked) {
+                        _my->check_history(db.head_block_num() + 1);
+                    }
+                });
+
                 ilog("market_history plugin: plugin_startup() end");
             }
 
             void market_history_plugin::plugin_shutdown() {
                 ilog("market_history plugin: plugin_shutdown() begin");
 
+                // The history is in the saved file now, it is checked again on the next startup
+                _my->save_snapshot();
+                _my->clear_history();
+
                 ilog("market_history plugin: plugin_shutdown() end");
             }
 
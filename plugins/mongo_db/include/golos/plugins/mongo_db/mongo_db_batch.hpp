@@ -0,0 +1,50 @@
+#pragma once
+
+#include <golos/plugins/mongo_db/mongo_db_types.hpp>
+
+#include <bsoncxx/document/value.hpp>
+
+#include <string>
+#include <vector>
+
+namespace golos {
+namespace plugins {
+namespace mongo_db {
+
+    // A document with its target collection, it owns the data until it's written by the writer thread
+    struct write_request {
+        write_request(const named_document& named_doc);
+        write_request(const std::string& collection_name, bsoncxx::document::value doc);
+
+        std::string collection_name;
+        std::string key;
+        std::string keyval;
+        bool is_removal;
+        bool is_update;
+        bsoncxx::document::value doc;
+        std::vector<bsoncxx::document::value> indexes_to_create;
+    };
+
+    // Documents of irreversible blocks, formatted in one on_block() call
+    struct write_batch {
+        uint32_t block_count = 0;
+        std::vector<write_request> requests;
+    };
+
+    // Receives the documents of one collection, which should be written by one bulk write
+    class write_sink {
+    public:
+        virtual ~write_sink() = default;
+
+        virtual void write(const std::string& collection_name, const std::vector<const write_request*>& requests) = 0;
+    };
+
+    /**
+     * Passes the documents of the batches to the sink, grouped by collection.
+     *
+     * Upserts and removals of the same object (collection, key, keyval) are replaced by the latest one,
+     *   which takes the position of its own occurrence. Plain inserts are passed as is.
+     */
+    void write_batches(const std::vector<write_batch>& batches, write_sink& sink);
+
+}}} // golos::plugins::mongo_db
@@ -6,6 +6,7 @@
 
 #include <golos/plugins/mongo_db/mongo_db_types.hpp>
 #include <golos/plugins/mongo_db/mongo_db_state.hpp>
+#include <golos/plugins/mongo_db/mongo_db_batch.hpp>
 
 #include <libraries/chain/include/golos/chain/operation_notification.hpp>
 
@@ -21,7 +22,9 @@
 #include <appbase/application.hpp>
 
 #include <thread>
+#include <chrono>
 #include <map>
+#include <deque>
 #include <mutex>
 #include <condition_variable>
 
@@ -37,15 +40,17 @@ namespace mongo_db {
     using golos::chain::operation_notification;
     using namespace golos::protocol;
 
-    using bulk_ptr = std::unique_ptr<mongocxx::bulk_write>;
-
-    class mongo_db_writer final {
+    class mongo_db_writer final : private write_sink {
     public:
         mongo_db_writer();
         ~mongo_db_writer();
 
         bool initialize(const std::string& uri_str, const bool write_raw, const std::vector<std::string>& op,
-            unsigned int store_history_dgp, unsigned int store_history_wso);
+            unsigned int store_history_dgp, unsigned int store_history_wso,
+            uint32_t max_queue_blocks, uint32_t max_bulk_blocks);
+
+        // Writes all queued blocks and stops the writer thread
+        void shutdown();
 
         void on_block(const signed_block& block);
         void on_operation(const golos::chain::operation_notification& note);
@@ -53,16 +58,22 @@ namespace mongo_db {
     private:
         using operations = std::vector<operation>;
 
-        void write_blocks();
-        void write_raw_block(const signed_block& block, const operations&);
+        void write_raw_block(write_batch& batch, const signed_block& block, const operations&);
         void write_block_operations(state_writer& st_writer, const signed_block& block, const operations&);
-        void write_document(named_document const& named_doc);
-        void remove_document(named_document const& named_doc);
 
         void format_block_info(const signed_block& block, document& doc);
         void format_transaction_info(const signed_transaction& tran, document& doc);
 
-        void write_data();
+        void enqueue(write_batch&& batch);
+        void write_loop();
+        // Writes the documents of one collection, retrying on connection failures
+        void write(const std::string& collection_name, const std::vector<const write_request*>& requests) override;
+        void append_request(mongocxx::bulk_write& bulk, const write_request& request);
+
+        // Waits before the next attempt to write, returns false if the writer is stopping
+        bool wait_for_retry(
+            const std::string& collection_name, std::size_t count, std::chrono::milliseconds& retry_delay,
+            const std::exception& e);
 
         uint64_t processed_blocks = 0;
 
@@ -74,9 +85,6 @@ namespace mongo_db {
         std::map<uint32_t, operations> virtual_ops;
         std::map<uint32_t, dynamic_global_property_object> dgp_s;
         std::map<uint32_t, witness_schedule_object> wso_s;
-        // Table name, bulk write
-        std::map<std::string, bulk_ptr> formatted_blocks;
-
         bool write_raw_blocks;
         flat_set<std::string> write_operations;
         unsigned int store_history_mode_dgp;
@@ -91,6 +99,17 @@ namespace mongo_db {
 
         std::unordered_map<std::string, std::string> indexes; // Prevent repeative create_index() calls. Only in current session 
 
+        // Formatted batches are written by a separate thread, so Mongo latency doesn't stall block application.
+        // When the queue is full, on_block() waits for the writer instead of dropping blocks.
+        std::deque<write_batch> write_queue;
+        std::mutex queue_mutex;
+        std::condition_variable queue_cond;
+        uint32_t queued_blocks = 0;
+        uint32_t max_queue_blocks = 0;
+        uint32_t max_bulk_blocks = 0;
+        bool stopping = false;
+        std::thread writer_thread;
+
         golos::chain::database &_db;
     };
 }}}
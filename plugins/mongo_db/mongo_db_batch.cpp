@@ -0,0 +1,66 @@
+#include <golos/plugins/mongo_db/mongo_db_batch.hpp>
+
+#include <map>
+#include <tuple>
+
+namespace golos {
+namespace plugins {
+namespace mongo_db {
+
+    write_request::write_request(const named_document& named_doc)
+        : collection_name(named_doc.collection_name),
+          key(named_doc.key),
+          keyval(named_doc.keyval),
+          is_removal(named_doc.is_removal),
+          is_update(false),
+          doc(named_doc.doc.view()) {
+        auto view = doc.view();
+        is_update = (view.find("$set") != view.end());
+        for (auto& index_to_create : named_doc.indexes_to_create) {
+            indexes_to_create.emplace_back(index_to_create.view());
+        }
+    }
+
+    write_request::write_request(const std::string& collection_name, bsoncxx::document::value doc)
+        : collection_name(collection_name),
+          is_removal(false),
+          is_update(false),
+          doc(std::move(doc)) {
+    }
+
+    void write_batches(const std::vector<write_batch>& batches, write_sink& sink) {
+        using request_key = std::tuple<std::string, std::string, std::string>;
+
+        // A removal after an upsert of the same object (and vice versa) supersedes it,
+        // so the position of the previous request is cleared and the latest one is appended
+        std::map<request_key, std::size_t> latest;
+        std::vector<const write_request*> requests;
+        for (auto& batch : batches) {
+            for (auto& request : batch.requests) {
+                if (request.is_update || request.is_removal) {
+                    request_key key{request.collection_name, request.key, request.keyval};
+                    auto itr = latest.find(key);
+                    if (itr == latest.end()) {
+                        latest.emplace(std::move(key), requests.size());
+                    } else {
+                        requests[itr->second] = nullptr;
+                        itr->second = requests.size();
+                    }
+                }
+                requests.push_back(&request);
+            }
+        }
+
+        std::map<std::string, std::vector<const write_request*>> collections;
+        for (auto request : requests) {
+            if (request != nullptr) {
+                collections[request->collection_name].push_back(request);
+            }
+        }
+
+        for (auto& collection : collections) {
+            sink.write(collection.first, collection.second);
+        }
+    }
+
+}}} // golos::plugins::mongo_db
@@ -19,8 +19,14 @@ namespace mongo_db {
         }
 
         bool initialize(const std::string& uri, const bool write_raw, const std::vector<std::string>& op,
-            unsigned int store_history_dgp, unsigned int store_history_wso) {
-            return writer.initialize(uri, write_raw, op, store_history_dgp, store_history_wso);
+            unsigned int store_history_dgp, unsigned int store_history_wso,
+            uint32_t max_queue_blocks, uint32_t max_bulk_blocks) {
+            return writer.initialize(uri, write_raw, op, store_history_dgp, store_history_wso,
+                max_queue_blocks, max_bulk_blocks);
+        }
+
+        void shutdown() {
+            writer.shutdown();
         }
 
         ~mongo_db_plugin_impl() = default;
@@ -71,7 +77,13 @@ namespace mongo_db {
              "Mode of storing global_property_object history for each N block")
             ("mongodb-store-wso-history",
              boost::program_options::value<unsigned int>()->default_value(10),
-             "Mode of storing witness_schedule_object history for each N block");
+             "Mode of storing witness_schedule_object history for each N block")
+            ("mongodb-max-queue-blocks",
+             boost::program_options::value<uint32_t>()->default_value(1000),
+             "Max number of irreversible blocks waiting to be written into mongo, block application waits when it is reached")
+            ("mongodb-max-bulk-blocks",
+             boost::program_options::value<uint32_t>()->default_value(100),
+             "Max number of blocks written into mongo by one bulk write");
         cfg.add(cli);
     }
 
@@ -96,6 +108,15 @@ namespace mongo_db {
                 store_history_wso = options.at("mongodb-store-wso-history").as<unsigned int>();
             }
 
+            uint32_t max_queue_blocks = 1000;
+            if (options.count("mongodb-max-queue-blocks")) {
+                max_queue_blocks = options.at("mongodb-max-queue-blocks").as<uint32_t>();
+            }
+            uint32_t max_bulk_blocks = 100;
+            if (options.count("mongodb-max-bulk-blocks")) {
+                max_bulk_blocks = options.at("mongodb-max-bulk-blocks").as<uint32_t>();
+            }
+
             // First init mongo db
             if (options.count("mongodb-uri")) {
                 std::string uri_str = options.at("mongodb-uri").as<std::string>();
@@ -103,7 +124,8 @@ namespace mongo_db {
 
                 pimpl_ = std::make_unique<mongo_db_plugin_impl>(*this);
 
-                if (!pimpl_->initialize(uri_str, raw_blocks, write_operations, store_history_dgp, store_history_wso)) {
+                if (!pimpl_->initialize(uri_str, raw_blocks, write_operations, store_history_dgp, store_history_wso,
+                        max_queue_blocks, max_bulk_blocks)) {
                     ilog("Cannot initialize MongoDB plugin. Plugin disabled.");
                     pimpl_.reset();
                     return;
@@ -136,6 +158,11 @@ namespace mongo_db {
     void mongo_db_plugin::plugin_shutdown() {
         ilog("mongo_db plugin: plugin_shutdown() begin");
 
+        if (pimpl_) {
+            // Writes blocks which are still in the queue
+            pimpl_->shutdown();
+        }
+
         ilog("mongo_db plugin: plugin_shutdown() end");
     }
 
@@ -8,6 +8,7 @@
 #include <appbase/application.hpp>
 
 #include <mongocxx/exception/exception.hpp>
+#include <mongocxx/exception/bulk_write_exception.hpp>
 #include <bsoncxx/array/element.hpp>
 #include <bsoncxx/builder/stream/array.hpp>
 
@@ -18,6 +19,9 @@
 #include <boost/multi_index/random_access_index.hpp>
 #include <boost/multi_index/sequenced_index.hpp>
 
+#include <algorithm>
+#include <chrono>
+
 namespace golos {
 namespace plugins {
 namespace mongo_db {
@@ -35,10 +39,12 @@ namespace mongo_db {
     }
 
     mongo_db_writer::~mongo_db_writer() {
+        shutdown();
     }
 
     bool mongo_db_writer::initialize(const std::string& uri_str, const bool write_raw, const std::vector<std::string>& ops,
-        unsigned int store_history_dgp, unsigned int store_history_wso) {
+        unsigned int store_history_dgp, unsigned int store_history_wso,
+        uint32_t max_queue_blocks_, uint32_t max_bulk_blocks_) {
         try {
             uri = mongocxx::uri {uri_str};
             mongo_conn = mongocxx::client {uri};
@@ -48,6 +54,8 @@ namespace mongo_db {
             write_raw_blocks = write_raw;
             store_history_mode_dgp = store_history_dgp;
             store_history_mode_wso = store_history_wso;
+            max_queue_blocks = std::max<uint32_t>(max_queue_blocks_, 1);
+            max_bulk_blocks = std::max<uint32_t>(max_bulk_blocks_, 1);
 
             for (auto& op : ops) {
                 if (!op.empty()) {
@@ -55,6 +63,8 @@ namespace mongo_db {
                 }
             }
 
+            writer_thread = std::thread([this]() { write_loop(); });
+
             ilog("MongoDB writer initialized.");
 
             return true;
@@ -83,6 +93,7 @@ namespace mongo_db {
             if (last_irreversible_block_num >= blocks.begin()->first) {
 
                 db_map all_docs;
+                write_batch batch;
 
                 // Write all the blocks that has num less then last irreversible block
                 while (!blocks.empty() && blocks.begin()->first <= last_irreversible_block_num) {
@@ -90,7 +101,7 @@ namespace mongo_db {
 
                     try {
                         if (write_raw_blocks) {
-                            write_raw_block(head_iter->second, virtual_ops[head_iter->first]);
+                            write_raw_block(batch, head_iter->second, virtual_ops[head_iter->first]);
                         }
 
                         state_writer st_writer(all_docs, block);
@@ -127,23 +138,17 @@ namespace mongo_db {
                     dgp_s.erase(head_iter->first);
                     wso_s.erase(head_iter->first);
                     virtual_ops.erase(head_iter->first);
+                    ++batch.block_count;
                 }
 
-                // End of blocks series. Writing all docs to bulk
+                // End of blocks series. Passing all docs to the writer thread
 
+                batch.requests.reserve(batch.requests.size() + all_docs.size());
                 for (auto& it : all_docs) {
-                    if (!it.is_removal) {
-                        //wlog(it.collection_name);
-                        write_document(it);
-                    } else {
-                        //wlog(it.collection_name + std::string("_REM"));
-                        remove_document(it);
-                    }
+                    batch.requests.emplace_back(it);
                 }
 
-                // Writing bulk to mongo
-
-                write_data();
+                enqueue(std::move(batch));
             }
 
             ++processed_blocks;
@@ -161,7 +166,7 @@ namespace mongo_db {
         virtual_ops.erase(itr, virtual_ops.end());
     }
 
-    void mongo_db_writer::write_raw_block(const signed_block& block, const operations& ops) {
+    void mongo_db_writer::write_raw_block(write_batch& batch, const signed_block& block, const operations& ops) {
 
         operation_writer op_writer;
         document block_doc;
@@ -216,56 +221,7 @@ namespace mongo_db {
         block_doc << transactions << transactions_array;
 
         static const std::string blocks = "blocks";
-        if (formatted_blocks.find(blocks) == formatted_blocks.end()) {
-            formatted_blocks[blocks] = std::make_unique<mongocxx::bulk_write>(bulk_opts);
-        }
-
-        mongocxx::model::insert_one insert_msg{block_doc.view()};
-        formatted_blocks[blocks]->append(insert_msg);
-    }
-
-    void mongo_db_writer::write_document(named_document const& named_doc) {
-        if (formatted_blocks.find(named_doc.collection_name) == formatted_blocks.end()) {
-            formatted_blocks[named_doc.collection_name] = std::make_unique<mongocxx::bulk_write>(bulk_opts);
-        }
-
-        auto view = named_doc.doc.view();
-        auto itr = view.find("$set");
-        if (view.end() == itr) {
-            mongocxx::model::insert_one msg{std::move(view)};
-            formatted_blocks[named_doc.collection_name]->append(msg);
-        } else {
-            document filter;
-
-            filter << "_id" << bsoncxx::oid(named_doc.keyval); 
-
-            mongocxx::model::update_one msg{filter.view(), 
-                view};
-            msg.upsert(true);
-            formatted_blocks[named_doc.collection_name]->append(msg);
-        }
-
-        if (indexes.find(named_doc.collection_name) == indexes.end()) {
-            for (auto& index_to_create : named_doc.indexes_to_create) {
-                mongo_database[named_doc.collection_name].create_index(index_to_create.view());
-                indexes[named_doc.collection_name] = "created";
-            }
-        }
-    }
-
-    void mongo_db_writer::remove_document(named_document const& named_doc) {
-        if (formatted_blocks.find(named_doc.collection_name) == formatted_blocks.end()) {
-            formatted_blocks[named_doc.collection_name] = std::make_unique<mongocxx::bulk_write>(bulk_opts);
-        }
-
-        document filter;
-        filter << named_doc.key << bsoncxx::oid(named_doc.keyval);
-        auto v1 = filter.view();
-        document newval;
-        newval << "$set" << open_document << "removed" << true << close_document;
-        auto v2 = newval.view();
-        mongocxx::model::update_many msg{v1, v2};
-        formatted_blocks[named_doc.collection_name]->append(msg);
+        batch.requests.emplace_back(blocks, block_doc.extract());
     }
 
     void mongo_db_writer::write_block_operations(state_writer& st_writer, const signed_block& block, const operations& ops) {
@@ -290,27 +246,147 @@ namespace mongo_db {
             << "transaction_expiration"     << tran.expiration;
     }
 
-    void mongo_db_writer::write_data() {
-        auto iter = formatted_blocks.begin();
-        for (; iter != formatted_blocks.end(); ++iter) {
+    void mongo_db_writer::enqueue(write_batch&& batch) {
+        std::unique_lock<std::mutex> lock(queue_mutex);
+
+        // Backpressure: block application waits for the writer instead of dropping blocks
+        if (queued_blocks >= max_queue_blocks && !stopping) {
+            wlog("MongoDB write queue is full (${n} blocks), waiting for the writer", ("n", queued_blocks));
+            queue_cond.wait(lock, [&]() { return queued_blocks < max_queue_blocks || stopping; });
+        }
+
+        queued_blocks += batch.block_count;
+        write_queue.push_back(std::move(batch));
+        queue_cond.notify_all();
+    }
+
+    void mongo_db_writer::shutdown() {
+        {
+            std::lock_guard<std::mutex> lock(queue_mutex);
+            stopping = true;
+        }
+        queue_cond.notify_all();
+
+        if (writer_thread.joinable()) {
+            writer_thread.join();
+        }
+    }
+
+    void mongo_db_writer::write_loop() {
+        while (true) {
+            std::vector<write_batch> batches;
+            {
+                std::unique_lock<std::mutex> lock(queue_mutex);
+                queue_cond.wait(lock, [&]() { return !write_queue.empty() || stopping; });
+                if (write_queue.empty()) {
+                    return; // stopping and all blocks are written
+                }
+
+                // Several batches are merged into one bulk write per collection
+                uint32_t block_count = 0;
+                while (!write_queue.empty() && (batches.empty() || block_count < max_bulk_blocks)) {
+                    block_count += write_queue.front().block_count;
+                    batches.push_back(std::move(write_queue.front()));
+                    write_queue.pop_front();
+                }
+            }
+
+            write_batches(batches, *this);
 
-            auto& oper = *iter;
+            {
+                std::lock_guard<std::mutex> lock(queue_mutex);
+                for (auto& batch : batches) {
+                    queued_blocks -= batch.block_count;
+                }
+            }
+            queue_cond.notify_all();
+        }
+    }
+
+    void mongo_db_writer::write(
+        const std::string& collection_name, const std::vector<const write_request*>& requests
+    ) {
+        auto retry_delay = std::chrono::milliseconds(500);
+        while (true) {
             try {
-                const std::string& collection_name = oper.first;
                 mongocxx::collection _collection = mongo_database[collection_name];
 
-                auto& bulkp = oper.second;
-                if (!_collection.bulk_write(*bulkp)) {
+                if (indexes.find(collection_name) == indexes.end()) {
+                    for (auto request : requests) {
+                        for (auto& index_to_create : request->indexes_to_create) {
+                            _collection.create_index(index_to_create.view());
+                            indexes[collection_name] = "created";
+                        }
+                    }
+                }
+
+                // The bulk is built again on each attempt, because it is consumed by bulk_write()
+                mongocxx::bulk_write bulk(bulk_opts);
+                for (auto request : requests) {
+                    append_request(bulk, *request);
+                }
+
+                if (!_collection.bulk_write(bulk)) {
                     wlog("Failed to write blocks to Mongo DB");
                 }
+                return;
+            }
+            catch (const mongocxx::bulk_write_exception& e) {
+                if (e.raw_server_error()) {
+                    // Documents rejected by server will be rejected again, so don't retry them
+                    wlog("Exception while writing blocks to mongo: ${e}", ("e", e.what()));
+                    return;
+                }
+                if (!wait_for_retry(collection_name, requests.size(), retry_delay, e)) {
+                    return;
+                }
             }
             catch (const std::exception& e) {
-                wlog("Unknown exception while writing blocks to mongo: ${e}", ("e", e.what()));
-                // If we got some errors writing block into mongo just skip this block and move on
-                formatted_blocks.erase(iter);
-                throw;
+                if (!wait_for_retry(collection_name, requests.size(), retry_delay, e)) {
+                    return;
+                }
             }
         }
-        formatted_blocks.clear();
+    }
+
+    bool mongo_db_writer::wait_for_retry(
+        const std::string& collection_name, std::size_t count, std::chrono::milliseconds& retry_delay,
+        const std::exception& e
+    ) {
+        static const auto max_retry_delay = std::chrono::milliseconds(30000);
+
+        std::unique_lock<std::mutex> lock(queue_mutex);
+        if (stopping) {
+            elog("Can't write ${n} documents to mongo collection ${c} on shutdown: ${e}",
+                ("n", count)("c", collection_name)("e", e.what()));
+            return false;
+        }
+
+        wlog("Exception while writing blocks to mongo, retrying in ${d} ms: ${e}",
+            ("d", retry_delay.count())("e", e.what()));
+        queue_cond.wait_for(lock, retry_delay, [&]() { return stopping; });
+        retry_delay = std::min(retry_delay * 2, max_retry_delay);
+        return true;
+    }
+
+    void mongo_db_writer::append_request(mongocxx::bulk_write& bulk, const write_request& request) {
+        auto view = request.doc.view();
+        if (request.is_removal) {
+            document filter;
+            filter << request.key << bsoncxx::oid(request.keyval);
+            document newval;
+            newval << "$set" << open_document << "removed" << true << close_document;
+            mongocxx::model::update_many msg{filter.view(), newval.view()};
+            bulk.append(msg);
+        } else if (request.is_update) {
+            document filter;
+            filter << "_id" << bsoncxx::oid(request.keyval);
+            mongocxx::model::update_one msg{filter.view(), view};
+            msg.upsert(true);
+            bulk.append(msg);
+        } else {
+            mongocxx::model::insert_one msg{view};
+            bulk.append(msg);
+        }
     }
 }}}
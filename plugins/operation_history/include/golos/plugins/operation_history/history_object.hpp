@@ -57,6 +57,10 @@ namespace golos { namespace plugins { namespace operation_history {
         buffer_type serialized_op;
     };
 
+    inline std::size_t dynamic_memory_usage(const operation_object &o) {
+        return golos::chain::dynamic_memory_usage(o.serialized_op);
+    }
+
     using operation_id_type = object_id<operation_object>;
 
     struct by_location;
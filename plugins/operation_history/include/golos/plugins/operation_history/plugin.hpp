@@ -36,6 +36,8 @@
 
 
 namespace golos { namespace plugins { namespace operation_history {
+    JSON_RPC_STREAMABLE(applied_operation)
+
     using namespace chain;
 
     using plugins::json_rpc::void_type;
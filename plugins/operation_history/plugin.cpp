@@ -225,7 +225,9 @@ namespace golos { namespace plugins { namespace operation_history {
             pimpl->start_block = 0;
         }
         ilog("operation_history: start_block ${s}", ("s", pimpl->start_block));
-        JSON_RPC_REGISTER_API(name());
+        JSON_RPC_REGISTER_API(name(), {
+            {"get_ops_in_block", json_rpc::api_cache_scope::irreversible_block}
+        });
         ilog("operation_history plugin: plugin_initialize() end");
     }
 
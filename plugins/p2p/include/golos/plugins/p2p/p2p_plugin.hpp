@@ -1,6 +1,9 @@
 #pragma once
 
 #include <golos/plugins/chain/plugin.hpp>
+#include <golos/plugins/json_rpc/utility.hpp>
+#include <golos/plugins/json_rpc/plugin.hpp>
+#include <golos/network/node.hpp>
 
 #include <appbase/application.hpp>
 
@@ -11,13 +14,19 @@ namespace golos {
         namespace p2p {
             namespace bpo = boost::program_options;
 
+            using golos::plugins::json_rpc::msg_pack;
+
             namespace detail {
                 class p2p_plugin_impl;
             }
 
-            class p2p_plugin final : public appbase::plugin<p2p_plugin> {
+            DEFINE_API_ARGS(get_network_statistics, msg_pack, golos::network::network_statistics)
+
+            class p2p_plugin final
+                    : public appbase::plugin<p2p_plugin>,
+                      public golos::network::network_statistics_provider {
             public:
-                APPBASE_PLUGIN_REQUIRES((chain::plugin))
+                APPBASE_PLUGIN_REQUIRES((chain::plugin)(json_rpc::plugin))
 
                 p2p_plugin();
 
@@ -43,6 +52,12 @@ namespace golos {
 
                 void set_block_production(bool producing_blocks);
 
+                golos::network::network_statistics get_network_statistics() const override;
+
+                DECLARE_API(
+                    (get_network_statistics)
+                )
+
             private:
                 std::unique_ptr<detail::p2p_plugin_impl> my;
             };
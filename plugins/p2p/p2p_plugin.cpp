@@ -10,6 +10,8 @@
 #include <boost/range/algorithm/reverse.hpp>
 #include <boost/range/adaptor/reversed.hpp>
 
+#include <atomic>
+
 using std::string;
 using std::vector;
 
@@ -45,6 +47,9 @@ namespace golos {
 
                     bool is_included_block(const block_id_type &block_id);
 
+                    // Checks which don't need the database, returns keys of signatures
+                    fc::flat_set<protocol::public_key_type> pre_verify_transaction(const protocol::signed_transaction &trx) const;
+
                     chain_id_type get_chain_id() const;
 
                     // node_delegate interface
@@ -61,6 +66,8 @@ namespace golos {
 
                     virtual message get_item(const item_id &) override;
 
+                    virtual std::vector<message> get_block_range(const item_hash_t &, uint32_t, uint32_t) override;
+
                     virtual std::vector<item_hash_t> get_blockchain_synopsis(const item_hash_t &, uint32_t) override;
 
                     virtual void sync_status(uint32_t, uint32_t) override;
@@ -96,6 +103,12 @@ namespace golos {
                     chain::plugin &chain;
 
                     fc::thread p2p_thread;
+
+                    // threads for stateless verification of incoming transactions
+                    std::vector<std::unique_ptr<fc::thread>> verify_threads;
+                    uint32_t next_verify_thread = 0;
+                    std::atomic<uint32_t> max_transaction_size{STEEMIT_MAX_TRANSACTION_SIZE};
+                    boost::signals2::scoped_connection applied_block_connection;
                 };
 
                 ////////////////////////////// Begin node_delegate Implementation //////////////////////////////
@@ -159,9 +172,30 @@ namespace golos {
                     } FC_CAPTURE_AND_RETHROW((blk_msg)(sync_mode))
                 }
 
+                fc::flat_set<protocol::public_key_type> p2p_plugin_impl::pre_verify_transaction(
+                        const protocol::signed_transaction &trx) const {
+                    auto trx_size = fc::raw::pack_size(trx);
+                    FC_ASSERT(trx_size <= max_transaction_size, "Transaction is too large",
+                              ("trx_size", trx_size)("max_transaction_size", max_transaction_size.load()));
+                    trx.validate();
+                    return trx.get_signature_keys(STEEMIT_CHAIN_ID);
+                }
+
                 void p2p_plugin_impl::handle_transaction(const trx_message &trx_msg) {
                     try {
-                        chain.accept_transaction(trx_msg.trx);
+                        if (verify_threads.empty()) {
+                            chain.accept_transaction(trx_msg.trx);
+                            return;
+                        }
+
+                        // Signature recovery is done in the pool, while the p2p thread handles messages from other peers,
+                        //   invalid transactions are dropped here without taking the database lock
+                        auto &verify_thread = *verify_threads[next_verify_thread++ % verify_threads.size()];
+                        auto signature_keys = verify_thread.async([&]() {
+                            return pre_verify_transaction(trx_msg.trx);
+                        }, "pre_verify_transaction").wait();
+
+                        chain.accept_transaction(trx_msg.trx, signature_keys);
                     } FC_CAPTURE_AND_RETHROW((trx_msg))
                 }
 
@@ -246,6 +280,52 @@ namespace golos {
                     } FC_CAPTURE_AND_RETHROW((id))
                 }
 
+                std::vector<message> p2p_plugin_impl::get_block_range(const item_hash_t &last_block_id,
+                                                                      uint32_t first_block_num, uint32_t count) {
+                    try {
+                        return chain.db().with_weak_read_lock([&]() {
+                            auto &db = chain.db();
+                            FC_ASSERT(db.find_block_id_for_num(block_header::num_from_id(last_block_id)) == last_block_id,
+                                      "Block isn't in our main chain");
+
+                            std::vector<message> result;
+                            result.reserve(count);
+
+                            // irreversible blocks are copied from the block log as they are stored,
+                            // only headers are unpacked to get block ids
+                            auto blocks = db.get_block_log().read_serialized_blocks(first_block_num, count);
+                            for (auto &data : blocks) {
+                                fc::datastream<const char *> ds(data.data(), data.size());
+                                signed_block_header header;
+                                fc::raw::unpack(ds, header);
+
+                                auto packed_block_id = fc::raw::pack(header.id());
+                                data.insert(data.end(), packed_block_id.begin(), packed_block_id.end());
+
+                                message msg;
+                                msg.msg_type = network::block_message_type;
+                                msg.size = data.size();
+                                msg.data = std::move(data);
+                                result.push_back(std::move(msg));
+                            }
+
+                            // the rest of blocks is reversible, they are in the fork database
+                            for (uint32_t block_num = first_block_num + result.size();
+                                 block_num - first_block_num < count; ++block_num) {
+                                auto block_id = db.find_block_id_for_num(block_num);
+                                if (block_id == block_id_type()) {
+                                    break;
+                                }
+                                auto opt_block = db.fetch_block_by_id(block_id);
+                                FC_ASSERT(opt_block.valid());
+                                result.push_back(block_message(std::move(*opt_block)));
+                            }
+
+                            return result;
+                        });
+                    } FC_CAPTURE_AND_RETHROW((last_block_id)(first_block_num)(count))
+                }
+
                 chain_id_type p2p_plugin_impl::get_chain_id() const {
                     return STEEMIT_CHAIN_ID;
                 }
@@ -443,7 +523,10 @@ namespace golos {
                     ("seed-node", boost::program_options::value<vector<string>>()->composing(),
                         "The IP address and port of a remote peer to sync with. Deprecated in favor of p2p-seed-node.")
                     ("p2p-seed-node", boost::program_options::value<vector<string>>()->composing(),
-                        "The IP address and port of a remote peer to sync with.");
+                        "The IP address and port of a remote peer to sync with.")
+                    ("p2p-verify-threads", boost::program_options::value<uint32_t>()->default_value(2),
+                        "Number of threads to check signatures of incoming transactions before pushing them to the chain "
+                        "(0 - check in the P2P thread).");
                 cli.add_options()
                     ("force-validate", boost::program_options::bool_switch()->default_value(false),
                         "Force validation of all transactions. Deprecated in favor of p2p-force-validate")
@@ -496,9 +579,25 @@ namespace golos {
                     wlog("Option force-validate is deprecated in favor of p2p-force-validate");
                     my->force_validate = true;
                 }
+
+                auto verify_threads = options.at("p2p-verify-threads").as<uint32_t>();
+                for (uint32_t i = 0; i < verify_threads; ++i) {
+                    my->verify_threads.emplace_back(new fc::thread("p2p verify " + std::to_string(i)));
+                }
+
+                JSON_RPC_REGISTER_API(name());
             }
 
             void p2p_plugin::plugin_startup() {
+                auto &db = my->chain.db();
+                auto update_max_transaction_size = [this, &db]() {
+                    my->max_transaction_size = db.get_dynamic_global_properties().maximum_block_size - 256;
+                };
+                db.with_weak_read_lock(update_max_transaction_size);
+                my->applied_block_connection = db.applied_block.connect([update_max_transaction_size](const signed_block &) {
+                    update_max_transaction_size();
+                });
+
                 my->p2p_thread.async([this] {
                     my->node.reset(new golos::network::node(my->user_agent));
                     my->node->load_configuration(app().data_dir() / "p2p");
@@ -539,6 +638,9 @@ namespace golos {
                 ilog("Shutting down P2P Plugin");
                 my->node->close();
                 my->p2p_thread.quit();
+                for (auto &verify_thread : my->verify_threads) {
+                    verify_thread->quit();
+                }
                 my->node.reset();
             }
 
@@ -556,6 +658,15 @@ namespace golos {
                 my->block_producer = producing_blocks;
             }
 
+            golos::network::network_statistics p2p_plugin::get_network_statistics() const {
+                FC_ASSERT(my->node, "P2P node isn't started");
+                return my->node->get_network_statistics();
+            }
+
+            DEFINE_API(p2p_plugin, get_network_statistics) {
+                return get_network_statistics();
+            }
+
         }
     }
 } // namespace steem::plugins::p2p
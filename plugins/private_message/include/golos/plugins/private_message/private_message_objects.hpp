@@ -59,6 +59,10 @@ namespace golos {
                 buffer_type encrypted_message;
             };
 
+            inline std::size_t dynamic_memory_usage(const message_object &o) {
+                return golos::chain::dynamic_memory_usage(o.encrypted_message);
+            }
+
             typedef message_object::id_type message_id_type;
 
             struct message_api_obj {
@@ -6,6 +6,13 @@
 #include <golos/plugins/follow/plugin.hpp>
 #include <golos/api/account_vote.hpp>
 #include <golos/api/vote_state.hpp>
+#include <golos/plugins/json_rpc/json_writer.hpp>
+
+namespace golos { namespace api {
+    JSON_RPC_STREAMABLE(discussion)
+    JSON_RPC_STREAMABLE(vote_state)
+    JSON_RPC_STREAMABLE(account_vote)
+} } // golos::api
 
 namespace golos { namespace plugins { namespace social_network {
     using plugins::json_rpc::msg_pack;
@@ -41,6 +41,7 @@ public:
         return name;
     }
 
+    // P2P plugin is optional, network statistics are sent only if it is enabled
     APPBASE_PLUGIN_REQUIRES((chain::plugin))
 
     plugin();
@@ -8,9 +8,12 @@
 #include <golos/chain/operation_notification.hpp>
 #include <golos/protocol/block.hpp>
 #include <golos/chain/database.hpp>
+#include <golos/network/node.hpp>
 #include <fc/io/json.hpp>
 #include <boost/program_options.hpp>
+#include <boost/asio/deadline_timer.hpp>
 #include <golos/plugins/statsd/statistics_sender.hpp>
+#include <golos/plugins/chain/async_observer.hpp>
 
 
 
@@ -25,6 +28,12 @@ void increment_counter(std::vector<std::string>& result, std::string name, uint3
     }
 }
 
+void increment_counter(std::vector<std::string>& result, std::string name, uint64_t value, std::string stat_type = "c") {
+    if (value != 0) {
+        result.push_back(name + ":" + std::to_string(value) + "|" + stat_type);
+    }
+}
+
 void increment_counter(std::vector<std::string>& result, std::string name, share_type value, std::string stat_type = "c") {
     if (value != 0) {
         result.push_back(name + ":" + std::string(value) + "|" + stat_type);
@@ -34,6 +43,19 @@ void increment_counter(std::vector<std::string>& result, std::string name, share
 using namespace golos::protocol;
 
 
+// State of objects touched by an operation, it's captured on the write thread and counted on the observer thread
+struct operation_snapshot {
+    operation op;
+    bool is_reply = false;            ///< comment, vote, delete_comment: the comment is a reply
+    bool is_new = false;              ///< comment, pow, withdraw_vesting: the object is created by the operation
+    bool has_vote_changes = false;    ///< vote: the vote object has changes
+    bool is_finished = false;         ///< fill_vesting_withdraw: the withdrawal is finished
+    share_type vesting_withdraw_rate_delta = 0;
+    uint32_t num_pow_witnesses = 0;
+};
+
+using statsd_observer = chain::async_observer<operation_snapshot>;
+
 struct plugin::plugin_impl final {
 public:
     plugin_impl( ) : database_(appbase::app().get_plugin<chain::plugin>().db()) {
@@ -45,23 +67,46 @@ public:
         return database_;
     }
 
-    void on_block(const signed_block &b);
+    void on_block(const statsd_observer::block_notification &n);
+
+    void pre_operation(const operation_notification &o, operation_snapshot &s);
+
+    void post_operation(const operation_notification &o, operation_snapshot &s);
+
+    // P2P statistics aren't tied to blocks, so they are sent by the timer
+    void schedule_network_statistics();
+
+    void send_network_statistics();
 
-    void pre_operation(const operation_notification &o);
+    // Usage of the shared memory by indexes is sent by the timer too
+    void schedule_memory_statistics();
 
-    void post_operation(const operation_notification &o);
+    void send_memory_statistics();
 
     golos::chain::database &database_;
 
     std::shared_ptr<statistics_sender> stat_sender;
+
+    // Statistics are calculated on the separate thread, which receives irreversible blocks
+    std::unique_ptr<statsd_observer> observer;
+
+    uint32_t network_statistics_interval = 0;
+    // P2P plugin, it is found on startup
+    const appbase::abstract_plugin *p2p = nullptr;
+    const golos::network::network_statistics_provider *network_statistics_provider = nullptr;
+    std::unique_ptr<boost::asio::deadline_timer> network_statistics_timer;
+    fc::optional<golos::network::network_statistics> previous_network_statistics;
+
+    uint32_t memory_statistics_interval = 0;
+    std::unique_ptr<boost::asio::deadline_timer> memory_statistics_timer;
 };
 
 struct operation_process {
-    database &_db;
+    const operation_snapshot &_snapshot;
     std::shared_ptr<statistics_sender> stat_sender;
 
-    operation_process(database &db, std::shared_ptr<statistics_sender> stat_sender) :
-        _db(db), stat_sender(stat_sender) {
+    operation_process(const operation_snapshot &snapshot, std::shared_ptr<statistics_sender> stat_sender) :
+        _snapshot(snapshot), stat_sender(stat_sender) {
     }
 
     typedef void result_type;
@@ -89,28 +134,24 @@ struct operation_process {
     }
 
     void operator()(const pow_operation &op) const {
-        auto &worker = _db.get_account(op.worker_account);
-
-        if (worker.created == _db.head_block_time()) {
+        if (_snapshot.is_new) {
            stat_sender->current_bucket.mined_accounts_created++;
         }
 
         stat_sender->current_bucket.total_pow++;
 
-        stat_sender->current_bucket.num_pow_witnesses = _db.get_dynamic_global_properties().num_pow_witnesses;
+        stat_sender->current_bucket.num_pow_witnesses = _snapshot.num_pow_witnesses;
     }
 
     void operator()(const comment_operation &op) const {
-        auto &comment = _db.get_comment(op.author, op.permlink);
-
-        if (comment.created == _db.head_block_time()) {
-            if (comment.parent_author.length()) {
+        if (_snapshot.is_new) {
+            if (_snapshot.is_reply) {
                 stat_sender->current_bucket.replies++;
             } else {
                 stat_sender->current_bucket.root_comments++;
             }
         } else {
-            if (comment.parent_author.length()) {
+            if (_snapshot.is_reply) {
                 stat_sender->current_bucket.reply_edits++;
             } else {
                 stat_sender->current_bucket.root_comment_edits++;
@@ -118,20 +159,23 @@ struct operation_process {
         }
     }
 
-    void operator()(const vote_operation &op) const {
-        const auto &cv_idx = _db.get_index<comment_vote_index>().indices().get<by_comment_voter>();
-        auto &comment = _db.get_comment(op.author, op.permlink);
-        auto &voter = _db.get_account(op.voter);
-        auto itr = cv_idx.find(boost::make_tuple(comment.id, voter.id));
+    void operator()(const delete_comment_operation &op) const {
+        if (_snapshot.is_reply) {
+            stat_sender->current_bucket.replies_deleted++;
+        } else {
+            stat_sender->current_bucket.root_comments_deleted++;
+        }
+    }
 
-        if (itr->num_changes) {
-            if (comment.parent_author.size()) {
+    void operator()(const vote_operation &op) const {
+        if (_snapshot.has_vote_changes) {
+            if (_snapshot.is_reply) {
                 stat_sender->current_bucket.new_reply_votes++;
             } else {
                 stat_sender->current_bucket.new_root_votes++;
             }
         } else {
-            if (comment.parent_author.size()) {
+            if (_snapshot.is_reply) {
                 stat_sender->current_bucket.changed_reply_votes++;
             } else {
                 stat_sender->current_bucket.changed_root_votes++;
@@ -158,9 +202,18 @@ struct operation_process {
         stat_sender->current_bucket.steem_vested += op.amount.amount;
     }
 
-    void operator()(const fill_vesting_withdraw_operation &op) const {
-        auto &account = _db.get_account(op.from_account);
+    void operator()(const withdraw_vesting_operation &op) const {
+        if (_snapshot.is_new) {
+            stat_sender->current_bucket.new_vesting_withdrawal_requests++;
+        } else {
+            stat_sender->current_bucket.modified_vesting_withdrawal_requests++;
+        }
 
+        // TODO: Figure out how to change delta when a vesting withdraw finishes. Have until March 24th 2018 to figure that out...
+        stat_sender->current_bucket.vesting_withdraw_rate_delta += _snapshot.vesting_withdraw_rate_delta;
+    }
+
+    void operator()(const fill_vesting_withdraw_operation &op) const {
         stat_sender->current_bucket.vesting_withdrawals_processed++;
 
         if (op.deposited.symbol == STEEM_SYMBOL) {
@@ -169,7 +222,7 @@ struct operation_process {
             stat_sender->current_bucket.vests_transferred += op.withdrawn.amount;
         }
 
-        if (account.vesting_withdraw_rate.amount == 0) {
+        if (_snapshot.is_finished) {
             stat_sender->current_bucket.finished_vesting_withdrawals++;
         }
     }
@@ -197,7 +250,16 @@ struct operation_process {
     }
 };
 
-void plugin::plugin_impl::on_block(const signed_block &b) {
+void plugin::plugin_impl::on_block(const statsd_observer::block_notification &n) {
+    const auto &b = n.block;
+
+    for (const auto &s : n.snapshots) {
+        if (!is_virtual_operation(s.op)) {
+            stat_sender->current_bucket.operations++;
+        }
+        s.op.visit( operation_process( s, stat_sender ) );
+    }
+
     if (b.block_num() == 1) {
         stat_sender->current_bucket.seconds = 0;
         stat_sender->current_bucket.blocks = 1;
@@ -222,7 +284,7 @@ void plugin::plugin_impl::on_block(const signed_block &b) {
     uint32_t trx_size = 0;
     uint32_t num_trx = b.transactions.size();
 
-    for (auto trx : b.transactions) {
+    for (const auto &trx : b.transactions) {
         trx_size += fc::raw::pack_size(trx);
     }
 
@@ -230,22 +292,18 @@ void plugin::plugin_impl::on_block(const signed_block &b) {
     stat_sender->current_bucket.bandwidth += trx_size;
 }
 
-void plugin::plugin_impl::pre_operation(const operation_notification &o) {
+void plugin::plugin_impl::pre_operation(const operation_notification &o, operation_snapshot &s) {
     auto &db = database();
 
     if (o.op.which() == operation::tag<delete_comment_operation>::value) {
 
-        delete_comment_operation op = o.op.get<delete_comment_operation>();
-        auto comment = db.get_comment(op.author, op.permlink);
+        const auto &op = o.op.get<delete_comment_operation>();
+        const auto &comment = db.get_comment(op.author, op.permlink);
 
-        if (comment.parent_author.length()) {
-            stat_sender->current_bucket.replies_deleted++;
-        } else {
-            stat_sender->current_bucket.root_comments_deleted++;
-        }
+        s.is_reply = comment.parent_author.length();
     } else if (o.op.which() == operation::tag<withdraw_vesting_operation>::value) {
-        withdraw_vesting_operation op = o.op.get<withdraw_vesting_operation>();
-        auto &account = db.get_account(op.account);
+        const auto &op = o.op.get<withdraw_vesting_operation>();
+        const auto &account = db.get_account(op.account);
 
         auto new_vesting_withdrawal_rate =
                 op.vesting_shares.amount /
@@ -259,29 +317,150 @@ void plugin::plugin_impl::pre_operation(const operation_notification &o) {
             new_vesting_withdrawal_rate *= 10000;
         }
 
-        if (account.vesting_withdraw_rate.amount > 0) {
-            stat_sender->current_bucket.modified_vesting_withdrawal_requests++;
-        } else {
-            stat_sender->current_bucket.new_vesting_withdrawal_requests++;
-        }
-
-        // TODO: Figure out how to change delta when a vesting withdraw finishes. Have until March 24th 2018 to figure that out...
-        stat_sender->current_bucket.vesting_withdraw_rate_delta +=
+        s.is_new = account.vesting_withdraw_rate.amount <= 0;
+        s.vesting_withdraw_rate_delta =
                 new_vesting_withdrawal_rate -
                 account.vesting_withdraw_rate.amount;
     }
 }
 
-void plugin::plugin_impl::post_operation(const operation_notification &o) {
+void plugin::plugin_impl::post_operation(const operation_notification &o, operation_snapshot &s) {
     try {
+        auto &db = database();
 
-        if (!is_virtual_operation(o.op)) {
-            stat_sender->current_bucket.operations++;
+        s.op = o.op;
+
+        switch (o.op.which()) {
+            case operation::tag<pow_operation>::value: {
+                const auto &op = o.op.get<pow_operation>();
+                s.is_new = db.get_account(op.worker_account).created == db.head_block_time();
+                s.num_pow_witnesses = db.get_dynamic_global_properties().num_pow_witnesses;
+                break;
+            }
+            case operation::tag<comment_operation>::value: {
+                const auto &op = o.op.get<comment_operation>();
+                const auto &comment = db.get_comment(op.author, op.permlink);
+                s.is_new = comment.created == db.head_block_time();
+                s.is_reply = comment.parent_author.length();
+                break;
+            }
+            case operation::tag<vote_operation>::value: {
+                const auto &op = o.op.get<vote_operation>();
+                const auto &cv_idx = db.get_index<comment_vote_index>().indices().get<by_comment_voter>();
+                const auto &comment = db.get_comment(op.author, op.permlink);
+                const auto &voter = db.get_account(op.voter);
+                auto itr = cv_idx.find(boost::make_tuple(comment.id, voter.id));
+                s.has_vote_changes = itr != cv_idx.end() && itr->num_changes;
+                s.is_reply = comment.parent_author.size();
+                break;
+            }
+            case operation::tag<fill_vesting_withdraw_operation>::value: {
+                const auto &op = o.op.get<fill_vesting_withdraw_operation>();
+                s.is_finished = db.get_account(op.from_account).vesting_withdraw_rate.amount == 0;
+                break;
+            }
+            default:
+                break;
         }
-        o.op.visit( operation_process( database(), stat_sender ) );
     } FC_CAPTURE_AND_RETHROW()
 }
 
+void plugin::plugin_impl::schedule_network_statistics() {
+    network_statistics_timer->expires_from_now(boost::posix_time::seconds(network_statistics_interval));
+    network_statistics_timer->async_wait([this](const boost::system::error_code &ec) {
+        if (ec) {
+            return;
+        }
+        try {
+            send_network_statistics();
+        } FC_CAPTURE_AND_LOG(())
+        schedule_network_statistics();
+    });
+}
+
+void plugin::plugin_impl::send_network_statistics() {
+    // the P2P node can be stopped or not started yet
+    if (p2p->get_state() != appbase::abstract_plugin::started) {
+        return;
+    }
+
+    auto current = network_statistics_provider->get_network_statistics();
+
+    if (previous_network_statistics.valid()) {
+        std::map<std::string, const golos::network::message_type_statistics *> previous_messages;
+        for (const auto &m : previous_network_statistics->messages) {
+            previous_messages[m.message_type] = &m;
+        }
+
+        std::vector<std::string> result;
+        const golos::network::message_type_statistics empty;
+        for (const auto &b : current.messages) {
+            auto itr = previous_messages.find(b.message_type);
+            const auto &a = itr != previous_messages.end() ? *itr->second : empty;
+            auto prefix = "p2p." + b.message_type + ".";
+
+            increment_counter( result, prefix + "messages_received", (b.messages_received - a.messages_received) );
+            increment_counter( result, prefix + "bytes_received", (b.bytes_received - a.bytes_received) );
+            increment_counter( result, prefix + "handling_time", (b.handling_time - a.handling_time) );
+            increment_counter( result, prefix + "messages_sent", (b.messages_sent - a.messages_sent) );
+            increment_counter( result, prefix + "bytes_sent", (b.bytes_sent - a.bytes_sent) );
+            increment_counter( result, prefix + "queue_time", (b.queue_time - a.queue_time) );
+        }
+        increment_counter( result, "p2p.crypto_time", (current.crypto_time - previous_network_statistics->crypto_time) );
+
+        uint64_t send_queue_bytes = 0;
+        for (const auto &peer : current.peers) {
+            send_queue_bytes += peer.send_queue_bytes;
+        }
+        result.push_back("p2p.connections:" + std::to_string(current.connections) + "|g");
+        result.push_back("p2p.send_queue_bytes:" + std::to_string(send_queue_bytes) + "|g");
+
+        if (current.block_propagation.blocks != previous_network_statistics->block_propagation.blocks) {
+            result.push_back("p2p.block_propagation_delay:" +
+                std::to_string(current.block_propagation.average_delay) + "|g");
+        }
+
+        for (const auto &line : result) {
+            stat_sender->push(line);
+        }
+    }
+
+    previous_network_statistics = std::move(current);
+}
+
+void plugin::plugin_impl::schedule_memory_statistics() {
+    memory_statistics_timer->expires_from_now(boost::posix_time::seconds(memory_statistics_interval));
+    memory_statistics_timer->async_wait([this](const boost::system::error_code &ec) {
+        if (ec) {
+            return;
+        }
+        try {
+            send_memory_statistics();
+        } FC_CAPTURE_AND_LOG(())
+        schedule_memory_statistics();
+    });
+}
+
+void plugin::plugin_impl::send_memory_statistics() {
+    auto &db = database();
+    std::vector<index_statistics> statistics;
+    uint64_t free_size = 0;
+    db.with_weak_read_lock([&]() {
+        statistics = db.get_index_statistics();
+        free_size = db.free_memory();
+    });
+
+    stat_sender->push("memory.free_size:" + std::to_string(free_size) + "|g");
+    for (const auto &s : statistics) {
+        // metric names can't contain the namespace separator
+        auto pos = s.name.rfind("::");
+        auto prefix = "memory." + (pos == std::string::npos ? s.name : s.name.substr(pos + 2)) + ".";
+
+        stat_sender->push(prefix + "objects:" + std::to_string(s.object_count) + "|g");
+        stat_sender->push(prefix + "size:" + std::to_string(s.total_size) + "|g");
+    }
+}
+
 plugin::plugin() {
 
 }
@@ -294,7 +473,11 @@ void plugin::set_program_options(options_description& cli, options_description&
         ("statsd-endpoints",
             boost::program_options::value<std::vector<std::string>>()->multitoken()->zero_tokens()->composing(),
             "StatsD endpoints that will receive the statistics in StatsD string format.")
-        ("statsd-default-port", boost::program_options::value<uint32_t>()->default_value(8125), "Default port for StatsD nodes.");
+        ("statsd-default-port", boost::program_options::value<uint32_t>()->default_value(8125), "Default port for StatsD nodes.")
+        ("statsd-p2p-interval", boost::program_options::value<uint32_t>()->default_value(10),
+            "Interval in seconds between sending P2P network statistics (0 - don't send).")
+        ("statsd-memory-interval", boost::program_options::value<uint32_t>()->default_value(60),
+            "Interval in seconds between sending usage of the shared memory by indexes (0 - don't send).");
     cfg.add(cli);
 }
 
@@ -309,17 +492,17 @@ void plugin::plugin_initialize(const boost::program_options::variables_map& opti
         uint32_t statsd_default_port = options["statsd-default-port"].as<uint32_t>();
         _my->stat_sender = std::shared_ptr<statistics_sender>(new statistics_sender(statsd_default_port) );
 
-        db.applied_block.connect([&](const signed_block &b) {
-            _my->on_block(b);
-        });
-
-        db.pre_apply_operation.connect([&](operation_notification &o) {
-            _my->pre_operation(o);
-        });
-
-        db.post_apply_operation.connect([&](const operation_notification &o) {
-            _my->post_operation(o);
-        });
+        _my->observer.reset(new statsd_observer(
+            db, name(),
+            [&](const operation_notification &o, operation_snapshot &s) {
+                _my->pre_operation(o, s);
+            },
+            [&](const operation_notification &o, operation_snapshot &s) {
+                _my->post_operation(o, s);
+            },
+            [&](const statsd_observer::block_notification &n) {
+                _my->on_block(n);
+            }));
 
         if (options.count("statsd-endpoints")) {
             for (auto it : options["statsd-endpoints"].as<std::vector<std::string>>()) {
@@ -327,6 +510,9 @@ void plugin::plugin_initialize(const boost::program_options::variables_map& opti
             }
         }
 
+        _my->network_statistics_interval = options["statsd-p2p-interval"].as<uint32_t>();
+        _my->memory_statistics_interval = options["statsd-memory-interval"].as<uint32_t>();
+
         ilog("statsd_plugin: plugin_initialize() end");
     } FC_CAPTURE_AND_RETHROW()
 }
@@ -337,6 +523,26 @@ void plugin::plugin_startup() {
     if (_my->stat_sender->can_start()) {
         wlog("statsd plugin: statitistics sender was started");
         wlog("StatsD endpoints: ${endpoints}", ( "endpoints", _my->stat_sender->get_endpoint_string_vector() ) );
+
+        if (_my->network_statistics_interval) {
+            // the plugin is found by name, so statsd doesn't depend on it
+            _my->p2p = appbase::app().find_plugin("p2p");
+            _my->network_statistics_provider =
+                dynamic_cast<const golos::network::network_statistics_provider *>(_my->p2p);
+            if (_my->network_statistics_provider != nullptr &&
+                _my->p2p->get_state() != appbase::abstract_plugin::registered
+            ) {
+                _my->network_statistics_timer.reset(new boost::asio::deadline_timer(appbase::app().get_io_service()));
+                _my->schedule_network_statistics();
+            } else {
+                wlog("statsd plugin: P2P plugin isn't enabled, network statistics won't be sent");
+            }
+        }
+
+        if (_my->memory_statistics_interval) {
+            _my->memory_statistics_timer.reset(new boost::asio::deadline_timer(appbase::app().get_io_service()));
+            _my->schedule_memory_statistics();
+        }
     }
     else {
         wlog("statsd plugin: statitistics sender was not started: no recipient's IPs were provided");
@@ -346,6 +552,13 @@ void plugin::plugin_startup() {
 }
 
 void plugin::plugin_shutdown() {
+    if (_my->network_statistics_timer) {
+        _my->network_statistics_timer->cancel();
+    }
+    if (_my->memory_statistics_timer) {
+        _my->memory_statistics_timer->cancel();
+    }
+    _my->observer.reset();
     _my->stat_sender.reset();
 }
 
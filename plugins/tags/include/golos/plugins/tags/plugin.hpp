@@ -6,8 +6,16 @@
 #include <golos/plugins/tags/tag_api_object.hpp>
 #include <golos/api/account_vote.hpp>
 #include <golos/plugins/follow/plugin.hpp>
+#include <golos/plugins/json_rpc/json_writer.hpp>
+
+namespace golos { namespace api {
+    JSON_RPC_STREAMABLE(discussion)
+    JSON_RPC_STREAMABLE(vote_state)
+} } // golos::api
 
 namespace golos { namespace plugins { namespace tags {
+    JSON_RPC_STREAMABLE(tag_api_object)
+
     using plugins::json_rpc::msg_pack;
     using namespace golos::api;
 
@@ -82,6 +82,16 @@ namespace golos { namespace plugins { namespace tags {
         template<typename DatabaseIndex, typename DiscussionIndex>
         std::vector<discussion> select_unordered_discussions(discussion_query& query) const;
 
+        std::vector<discussion> select_feed_discussions(discussion_query& query) const;
+
+        void add_unordered_discussion(
+            const comment_object::id_type& comment_id,
+            std::set<comment_object::id_type>& id_set,
+            bool& can_add,
+            std::vector<discussion>& result,
+            const discussion_query& query
+        ) const;
+
         template<typename Iterator, typename Order, typename Select, typename Exit>
         void select_discussions(
             std::set<comment_object::id_type>& id_set,
@@ -219,7 +229,19 @@ namespace golos { namespace plugins { namespace tags {
         add_plugin_index<tags::author_tag_stats_index>(db);
         add_plugin_index<tags::language_index>(db);
 #endif
-        JSON_RPC_REGISTER_API (name());
+        JSON_RPC_REGISTER_API (name(), {
+            {"get_trending_tags",           json_rpc::api_cache_scope::head_block},
+            {"get_discussions_by_trending", json_rpc::api_cache_scope::head_block},
+            {"get_discussions_by_created",  json_rpc::api_cache_scope::head_block},
+            {"get_discussions_by_active",   json_rpc::api_cache_scope::head_block},
+            {"get_discussions_by_cashout",  json_rpc::api_cache_scope::head_block},
+            {"get_discussions_by_payout",   json_rpc::api_cache_scope::head_block},
+            {"get_discussions_by_votes",    json_rpc::api_cache_scope::head_block},
+            {"get_discussions_by_children", json_rpc::api_cache_scope::head_block},
+            {"get_discussions_by_hot",      json_rpc::api_cache_scope::head_block},
+            {"get_discussions_by_promoted", json_rpc::api_cache_scope::head_block},
+            {"get_languages",               json_rpc::api_cache_scope::head_block}
+        });
 
     }
 
@@ -338,41 +360,77 @@ namespace golos { namespace plugins { namespace tags {
         for (; query.select_authors.end() != aitr && result.size() < query.limit; ++aitr) {
             auto itr = idx.lower_bound(*aitr);
             for (; itr != etr && itr->account == *aitr && result.size() < query.limit; ++itr) {
-                if (id_set.count(itr->comment)) {
-                    continue;
-                }
-                id_set.insert(itr->comment);
+                add_unordered_discussion(itr->comment, id_set, can_add, result, query);
+            }
+        }
+        return result;
+    }
 
-                if (query.has_start_comment() && !can_add) {
-                    can_add = (query.is_good_start(itr->comment));
-                    if (!can_add) {
-                        continue;
-                    }
-                }
+    std::vector<discussion> tags_plugin::impl::select_feed_discussions(discussion_query& query) const {
+        std::vector<discussion> result;
 
-                const auto* comment = db.find(itr->comment);
-                if (!comment) {
-                    continue;
-                }
+        if (!filter_start_comment(query) || !filter_query(query)) {
+            return result;
+        }
 
-                if ((query.parent_author && *query.parent_author != comment->parent_author) ||
-                    (query.parent_permlink && *query.parent_permlink != to_string(comment->parent_permlink))
-                ) {
-                    continue;
-                }
+        auto& db = database();
+        auto max_feed_size = appbase::app().get_plugin<follow::plugin>().max_feed_size();
+        bool can_add = !query.has_start_comment();
 
-                discussion d = create_discussion(*comment);
-                if (!query.is_good_tags(d)) {
-                    continue;
-                }
+        result.reserve(query.limit);
 
-                fill_discussion(d, query);
-                result.push_back(d);
+        std::set<comment_object::id_type> id_set;
+        auto aitr = query.select_authors.begin();
+        for (; query.select_authors.end() != aitr && result.size() < query.limit; ++aitr) {
+            // The same amount of entries as a stored feed can have
+            auto feed = follow::collect_account_feed(db, *aitr, 0, max_feed_size);
+            auto itr = feed.begin();
+            for (; itr != feed.end() && result.size() < query.limit; ++itr) {
+                add_unordered_discussion(itr->comment, id_set, can_add, result, query);
             }
         }
         return result;
     }
 
+    void tags_plugin::impl::add_unordered_discussion(
+        const comment_object::id_type& comment_id,
+        std::set<comment_object::id_type>& id_set,
+        bool& can_add,
+        std::vector<discussion>& result,
+        const discussion_query& query
+    ) const {
+        if (id_set.count(comment_id)) {
+            return;
+        }
+        id_set.insert(comment_id);
+
+        if (query.has_start_comment() && !can_add) {
+            can_add = (query.is_good_start(comment_id));
+            if (!can_add) {
+                return;
+            }
+        }
+
+        const auto* comment = database().find(comment_id);
+        if (!comment) {
+            return;
+        }
+
+        if ((query.parent_author && *query.parent_author != comment->parent_author) ||
+            (query.parent_permlink && *query.parent_permlink != to_string(comment->parent_permlink))
+        ) {
+            return;
+        }
+
+        discussion d = create_discussion(*comment);
+        if (!query.is_good_tags(d)) {
+            return;
+        }
+
+        fill_discussion(d, query);
+        result.push_back(d);
+    }
+
     template<
         typename Iterator,
         typename Order,
@@ -570,6 +628,11 @@ namespace golos { namespace plugins { namespace tags {
         FC_ASSERT(db.has_index<follow::feed_index>(), "Node is not running the follow plugin");
 
         return db.with_weak_read_lock([&]() {
+            if (appbase::app().get_plugin<follow::plugin>().feed_mode() ==
+                follow::feed_mode_type::fan_out_on_read
+            ) {
+                return pimpl->select_feed_discussions(query);
+            }
             return pimpl->select_unordered_discussions<follow::feed_index, follow::by_feed>(query);
         });
 #endif
@@ -20,10 +20,12 @@
 #include <websocketpp/logger/stub.hpp>
 #include <websocketpp/logger/syslog.hpp>
 
+#include <atomic>
 #include <thread>
 #include <memory>
 #include <iostream>
 #include <golos/plugins/json_rpc/plugin.hpp>
+#include <golos/plugins/json_rpc/request_parser.hpp>
 
 namespace golos {
     namespace plugins {
@@ -76,13 +78,66 @@ namespace golos {
 
             using websocket_server_type = websocketpp::server<asio_with_stub_log>;
 
+            /**
+             * The request scanned for selecting of the thread pool, it isn't scanned again on execution.
+             *   Spans of the request point to the body, which should be alive until the request is executed.
+             */
+            struct classified_request final {
+                bool heavy = false;
+                // empty for batches and malformed requests, they are scanned by json_rpc plugin
+                fc::optional<plugins::json_rpc::parsed_request> request;
+            };
+
+            /**
+             * Thread pool with the bounded number of pending requests.
+             *   When the limit is reached, new requests are rejected immediately.
+             */
+            struct request_pool final {
+                request_pool(boost::thread_group &thread_group, thread_pool_size_t size, uint32_t max_pending)
+                    : work(ios),
+                      max_pending_requests(max_pending) {
+                    for (uint32_t i = 0; i < size; ++i) {
+                        thread_group.create_thread(boost::bind(&asio::io_service::run, &ios));
+                    }
+                }
+
+                template <typename Task>
+                bool try_post(Task &&task) {
+                    if (max_pending_requests && pending_requests.fetch_add(1) >= max_pending_requests) {
+                        --pending_requests;
+                        return false;
+                    } else if (!max_pending_requests) {
+                        ++pending_requests;
+                    }
+
+                    ios.post([this, task]() {
+                        struct pending_guard {
+                            std::atomic<uint32_t> &pending;
+                            ~pending_guard() {
+                                --pending;
+                            }
+                        } guard{pending_requests};
+
+                        task();
+                    });
+                    return true;
+                }
+
+                asio::io_service ios;
+                asio::io_service::work work;
+                std::atomic<uint32_t> pending_requests{0};
+                uint32_t max_pending_requests;
+            };
+
             struct webserver_plugin::webserver_plugin_impl final {
             public:
                 boost::thread_group& thread_pool = appbase::app().scheduler();
-                webserver_plugin_impl(thread_pool_size_t thread_pool_size) : thread_pool_work(this->thread_pool_ios) {
-                    for (uint32_t i = 0; i < thread_pool_size; ++i) {
-                        thread_pool.create_thread(boost::bind(&asio::io_service::run, &thread_pool_ios));
-                    }
+                webserver_plugin_impl(
+                    thread_pool_size_t thread_pool_size,
+                    thread_pool_size_t heavy_thread_pool_size,
+                    uint32_t max_pending_requests
+                ) : light_pool(thread_pool, thread_pool_size, max_pending_requests),
+                    heavy_pool(thread_pool, heavy_thread_pool_size, max_pending_requests) {
                 }
 
                 void start_webserver();
@@ -93,22 +148,139 @@ namespace golos {
 
                 void handle_http_message(websocket_server_type *, connection_hdl);
 
+                classified_request classify_request(const std::string &body) const;
+
+                bool is_heavy_method(const std::string &method) const;
+
+                request_pool &select_pool(const classified_request &request) {
+                    return request.heavy ? heavy_pool : light_pool;
+                }
+
+                void call(const std::string &body, const classified_request &request,
+                          plugins::json_rpc::plugin::response_handler_type handler) {
+                    if (request.request.valid()) {
+                        api->call(*request.request, std::move(handler));
+                    } else {
+                        api->call(body, std::move(handler));
+                    }
+                }
+
+                // The calling thread runs the service too, its exceptions are caught by the caller
+                void run_io_service(asio::io_service &ios, std::vector<std::thread> &threads, const std::string &name) {
+                    for (uint32_t i = 1; i < io_threads; ++i) {
+                        threads.emplace_back([&ios, name]() {
+                            try {
+                                ios.run();
+                            } catch (...) {
+                                elog("error thrown from ${name} io service", ("name", name));
+                            }
+                        });
+                    }
+                    ios.run();
+                }
+
+                void join_io_threads(std::vector<std::thread> &threads) {
+                    for (auto &thread: threads) {
+                        thread.join();
+                    }
+                    threads.clear();
+                }
+
                 shared_ptr<std::thread> http_thread;
+                std::vector<std::thread> http_io_threads;
                 asio::io_service http_ios;
                 optional<tcp::endpoint> http_endpoint;
                 websocket_server_type http_server;
 
                 shared_ptr<std::thread> ws_thread;
+                std::vector<std::thread> ws_io_threads;
                 asio::io_service ws_ios;
                 optional<tcp::endpoint> ws_endpoint;
                 websocket_server_type ws_server;
-                asio::io_service thread_pool_ios;
-                asio::io_service::work thread_pool_work;
+
+                uint32_t io_threads = 1;
+
+                // Cheap requests aren't blocked by expensive ones, because they are executed in different pools
+                request_pool light_pool;
+                request_pool heavy_pool;
+                std::vector<std::string> heavy_methods;
 
                 plugins::json_rpc::plugin *api;
                 boost::signals2::connection chain_sync_con;
             };
 
+            bool webserver_plugin::webserver_plugin_impl::is_heavy_method(const std::string &method) const {
+                auto dot = method.find('.');
+                auto name = (dot == std::string::npos) ? method : method.substr(dot + 1);
+
+                for (const auto &pattern: heavy_methods) {
+                    if (!pattern.empty() && pattern.back() == '*') {
+                        auto prefix = pattern.substr(0, pattern.size() - 1);
+                        if (!method.compare(0, prefix.size(), prefix) || !name.compare(0, prefix.size(), prefix)) {
+                            return true;
+                        }
+                    } else if (pattern == method || pattern == name) {
+                        return true;
+                    }
+                }
+                return false;
+            }
+
+            classified_request webserver_plugin::webserver_plugin_impl::classify_request(const std::string &body) const {
+                using plugins::json_rpc::request_parser;
+
+                classified_request result;
+
+                try {
+                    // batches are long, so they are always executed in the heavy pool
+                    if (request_parser::is_batch(body)) {
+                        result.heavy = !heavy_methods.empty();
+                        return result;
+                    }
+
+                    plugins::json_rpc::json_span span;
+                    span.begin = body.data();
+                    span.end = body.data() + body.size();
+                    result.request = request_parser::parse(span);
+
+                    const auto &request = *result.request;
+                    if (heavy_methods.empty() || !request.method.valid()) {
+                        return result;
+                    }
+
+                    if (*request.method == "call" && request.params.valid()) {
+                        // only the names of API and method are decoded, arguments aren't scanned
+                        auto params = request_parser::split_array(*request.params, 2);
+                        if (params.size() >= 2) {
+                            result.heavy = is_heavy_method(
+                                request_parser::parse_string(params[0]) + '.' + request_parser::parse_string(params[1]));
+                            return result;
+                        }
+                    }
+                    result.heavy = is_heavy_method(*request.method);
+                } catch (...) {
+                    // the error will be returned on executing of the request
+                }
+                return result;
+            }
+
+            namespace {
+                std::string busy_ws_response(const classified_request &request) {
+                    std::string id = "null";
+                    if (request.request.valid() && request.request->id.valid()) {
+                        try {
+                            id = fc::json::to_string(
+                                plugins::json_rpc::request_parser::parse_value(*request.request->id));
+                        } catch (...) {
+                            // the invalid id can't be returned
+                        }
+                    }
+
+                    return "{\"jsonrpc\":\"2.0\",\"error\":{\"code\":" + std::to_string(JSON_RPC_SERVER_ERROR) +
+                           ",\"message\":\"Server is busy, try again later\"},\"id\":" + id + "}";
+                }
+            }
+
             void webserver_plugin::webserver_plugin_impl::start_webserver() {
                 if (ws_endpoint) {
                     ws_thread = std::make_shared<std::thread>([&]() {
@@ -130,10 +302,10 @@ namespace golos {
                             ws_server.listen(*ws_endpoint);
                             ws_server.start_accept();
 
-                            ws_ios.run();
+                            run_io_service(ws_ios, ws_io_threads, "ws");
                             ilog("ws io service exit");
                         } catch (...) {
-                            elog("error thrown from http io service");
+                            elog("error thrown from ws io service");
                         }
                     });
                 }
@@ -155,7 +327,7 @@ namespace golos {
                             http_server.listen(*http_endpoint);
                             http_server.start_accept();
 
-                            http_ios.run();
+                            run_io_service(http_ios, http_io_threads, "http");
                             ilog("http io service exit");
                         } catch (...) {
                             elog("error thrown from http io service");
@@ -173,19 +345,22 @@ namespace golos {
                     http_server.stop_listening();
                 }
 
-                thread_pool_ios.stop();
+                light_pool.ios.stop();
+                heavy_pool.ios.stop();
                 thread_pool.join_all();
 
                 if (ws_thread) {
                     ws_ios.stop();
                     ws_thread->join();
                     ws_thread.reset();
+                    join_io_threads(ws_io_threads);
                 }
 
                 if (http_thread) {
                     http_ios.stop();
                     http_thread->join();
                     http_thread.reset();
+                    join_io_threads(http_io_threads);
                 }
             }
 
@@ -195,10 +370,13 @@ namespace golos {
                 websocket_server_type::message_ptr msg
             ) {
                 auto con = server->get_con_from_hdl(hdl);
-                thread_pool_ios.post([con, msg, this]() {
+                // the payload is kept by msg until the request is executed
+                auto request = classify_request(msg->get_payload());
+                auto &pool = select_pool(request);
+                bool accepted = pool.try_post([con, msg, request, this]() {
                     try {
                         if (msg->get_opcode() == websocketpp::frame::opcode::text) {
-                            api->call(msg->get_payload(), [con](const std::string &data){
+                            call(msg->get_payload(), request, [con](const std::string &data){
                                 auto ec = con->send(data);
                                 if (ec) {
                                     throw websocketpp::exception(ec);
@@ -211,17 +389,36 @@ namespace golos {
                         con->send("error calling API " + e.to_string());
                     }
                 });
+
+                if (!accepted) {
+                    try {
+                        con->send(busy_ws_response(request));
+                    } catch (...) {
+                        // disable segfault
+                    }
+                }
             }
 
             void webserver_plugin::webserver_plugin_impl::handle_http_message(websocket_server_type *server, connection_hdl hdl) {
                 auto con = server->get_con_from_hdl(hdl);
-                con->defer_http_response();
 
-                thread_pool_ios.post([con, this]() {
-                    auto body = con->get_request_body();
+                // the body is shared with the task, because the scanned request points to it
+                auto body = std::make_shared<std::string>(con->get_request_body());
+                auto request = classify_request(*body);
+
+                // Reject the request before queueing, so the client doesn't wait for overloaded server
+                auto &pool = select_pool(request);
+                if (pool.max_pending_requests && pool.pending_requests >= pool.max_pending_requests) {
+                    con->set_body("Server is busy, try again later");
+                    con->set_status(websocketpp::http::status_code::service_unavailable);
+                    return;
+                }
+
+                con->defer_http_response();
 
+                bool accepted = pool.try_post([con, body, request, this]() {
                     try {
-                        api->call(body, [con](const std::string &data){
+                        call(*body, request, [con](const std::string &data){
                             // this lambda can be called from any thread in application
                             //   for example, when task was delegated ( see msg_pack(msg_pack&&) )
                             con->set_body(data);
@@ -243,6 +440,17 @@ namespace golos {
                         }
                     }
                 });
+
+                if (!accepted) {
+                    // the limit was reached between checking and posting
+                    con->set_body("Server is busy, try again later");
+                    con->set_status(websocketpp::http::status_code::service_unavailable);
+                    try {
+                        con->send_http_response();
+                    } catch (...) {
+                        // disable segfault
+                    }
+                }
             }
 
             webserver_plugin::webserver_plugin() {
@@ -260,14 +468,38 @@ namespace golos {
                     ("rpc-endpoint", boost::program_options::value<string>(),
                         "Local http and websocket endpoint for webserver requests. Deprectaed in favor of webserver-http-endpoint and webserver-ws-endpoint")
                     ("webserver-thread-pool-size", boost::program_options::value<thread_pool_size_t>()->default_value(256),
-                        "Number of threads used to handle queries. Default: 256.");
+                        "Number of threads used to handle queries. Default: 256.")
+                    ("webserver-heavy-thread-pool-size", boost::program_options::value<thread_pool_size_t>()->default_value(8),
+                        "Number of threads used to handle expensive queries (see webserver-heavy-method). Default: 8.")
+                    ("webserver-heavy-method", boost::program_options::value<std::vector<std::string>>()->composing()
+                        ->default_value(
+                            {"get_discussions_by_*", "get_blocks_with_info", "get_account_history", "get_state"},
+                            "get_discussions_by_* get_blocks_with_info get_account_history get_state"),
+                        "Methods (api.method or method, * at the end matches any suffix), which are handled by the separate "
+                        "thread pool, so they can't delay other queries. Batches are always handled by this pool.")
+                    ("webserver-max-pending-requests", boost::program_options::value<uint32_t>()->default_value(0),
+                        "Maximum number of queued and executing queries in each thread pool. "
+                        "New queries are rejected with 503, when the limit is reached. Default: 0 (unlimited).")
+                    ("webserver-io-threads", boost::program_options::value<uint32_t>()->default_value(1),
+                        "Number of threads, which accept connections and read requests on each endpoint. "
+                        "The optimal value is the number of CPU cores. Default: 1.");
             }
 
             void webserver_plugin::plugin_initialize(const boost::program_options::variables_map &options) {
                 auto thread_pool_size = options.at("webserver-thread-pool-size").as<thread_pool_size_t>();
                 FC_ASSERT(thread_pool_size > 0, "webserver-thread-pool-size must be greater than 0");
                 ilog("configured with ${tps} thread pool size", ("tps", thread_pool_size));
-                my.reset(new webserver_plugin_impl(thread_pool_size));
+
+                auto heavy_thread_pool_size = options.at("webserver-heavy-thread-pool-size").as<thread_pool_size_t>();
+                FC_ASSERT(heavy_thread_pool_size > 0, "webserver-heavy-thread-pool-size must be greater than 0");
+                ilog("configured with ${tps} heavy thread pool size", ("tps", heavy_thread_pool_size));
+
+                auto max_pending_requests = options.at("webserver-max-pending-requests").as<uint32_t>();
+                my.reset(new webserver_plugin_impl(thread_pool_size, heavy_thread_pool_size, max_pending_requests));
+
+                my->heavy_methods = options.at("webserver-heavy-method").as<std::vector<std::string>>();
+                my->io_threads = options.at("webserver-io-threads").as<uint32_t>();
+                FC_ASSERT(my->io_threads > 0, "webserver-io-threads must be greater than 0");
 
                 if (options.count("webserver-http-endpoint")) {
                     auto http_endpoint = options.at("webserver-http-endpoint").as<string>();
@@ -315,6 +547,12 @@ namespace golos {
                 my->api = appbase::app().find_plugin<plugins::json_rpc::plugin>();
                 FC_ASSERT(my->api != nullptr, "Could not find API Register Plugin");
 
+                // requests of batches are executed in parallel on the heavy thread pool
+                //   and are limited by webserver-max-pending-requests as other requests
+                my->api->set_executor([this](std::function<void()> task) {
+                    return my->heavy_pool.try_post(std::move(task));
+                });
+
                 chain::plugin *chain = appbase::app().find_plugin<chain::plugin>();
                 if (chain != nullptr && chain->get_state() != appbase::abstract_plugin::started) {
                     ilog("Waiting for chain plugin to start");
@@ -325,7 +325,8 @@ namespace golos {
 
                 switch (result) {
                     case block_production_condition::produced:
-                        ilog("Generated block #${n} with timestamp ${t} at time ${c} by ${w}", (capture));
+                        ilog("Generated block #${n} with timestamp ${t} at time ${c} by ${w}, "
+                             "${x} transactions in ${l} ms", (capture));
                         break;
                     case block_production_condition::not_synced:
                         // This log-record is commented, because it outputs very often
@@ -429,6 +430,8 @@ namespace golos {
                 int retry = 0;
                 do {
                     try {
+                        auto start = fc::time_point::now();
+
                         // TODO: the same thread as used in chain-plugin,
                         //       but in the future it should refactored to calling of a chain-plugin function
                         auto block = db.generate_block(
@@ -437,7 +440,11 @@ namespace golos {
                                 private_key_itr->second,
                                 _production_skip_flags
                         );
-                        capture("n", block.block_num())("t", block.timestamp)("c", now)("w", scheduled_witness);
+
+                        // Latency of production: assembling, signing and applying of the block
+                        auto latency = fc::time_point::now() - start;
+                        capture("n", block.block_num())("t", block.timestamp)("c", now)("w", scheduled_witness)
+                               ("x", block.transactions.size())("l", double(latency.count()) / 1000);
                         p2p().broadcast_block(block);
 
                         return block_production_condition::produced;
@@ -0,0 +1,183 @@
+/**
+ * Measures the hot apply paths of accounts: balance changes of transfers and voting power changes of votes.
+ *
+ * The database is filled directly with accounts. Each block is applied in an undo session like in push_block(),
+ * so each first change of an account in the block copies the whole object to the undo state.
+ * The sessions are committed after each block, as when the last irreversible block follows the head.
+ * Run it on builds before and after a change of account_object to compare the apply time and the memory usage.
+ */
+
+#include <golos/chain/database.hpp>
+#include <golos/chain/account_object.hpp>
+#include <golos/chain/index_statistics.hpp>
+
+#include <graphene/utilities/benchmark.hpp>
+
+#include <fc/filesystem.hpp>
+
+#include <boost/program_options.hpp>
+
+#include <algorithm>
+
+namespace bpo = boost::program_options;
+
+using golos::chain::account_index;
+using golos::chain::account_object;
+using golos::chain::database;
+using golos::protocol::account_name_type;
+using golos::protocol::asset;
+using golos::protocol::share_type;
+using golos::utilities::timer;
+using golos::utilities::timing_result;
+
+struct benchmark_options {
+    uint32_t accounts = 1000000;
+    uint32_t blocks = 10000;
+    uint32_t transfers_per_block = 100;
+    uint32_t votes_per_block = 100;
+    uint32_t shared_file_size = 2048;
+};
+
+struct benchmark_result {
+    uint32_t accounts = 0;
+    uint64_t account_object_size = 0;
+    golos::chain::index_statistics account_index_statistics;
+    int64_t setup_time_ms = 0;
+    timing_result transfers;
+    timing_result votes;
+    timing_result blocks;
+};
+
+FC_REFLECT((benchmark_result),
+    (accounts)(account_object_size)(account_index_statistics)(setup_time_ms)(transfers)(votes)(blocks))
+
+namespace {
+
+    const share_type account_balance = 1000000;
+
+    account_name_type account_name(uint32_t index) {
+        return "bench-a" + std::to_string(index);
+    }
+
+    void create_accounts(database &db, const benchmark_options &options) {
+        auto now = db.head_block_time();
+        for (uint32_t i = 0; i < options.accounts; ++i) {
+            db.create<account_object>([&](account_object &a) {
+                a.name = account_name(i);
+                a.created = now;
+                a.balance = asset(account_balance, STEEM_SYMBOL);
+                a.sbd_balance = asset(account_balance, SBD_SYMBOL);
+                // interest isn't paid during the benchmark
+                a.sbd_seconds_last_update = now;
+                a.sbd_last_interest_payment = now;
+                a.vesting_shares = asset(account_balance, VESTS_SYMBOL);
+            });
+        }
+    }
+
+    // Accounts are taken in a pseudo-random order, so the changes don't hit the same cache lines
+    const account_object &get_account(database &db, const benchmark_options &options, uint64_t index) {
+        return db.get_account(account_name(uint32_t((index * 2654435761ull) % options.accounts)));
+    }
+
+    void transfer(database &db, const account_object &from, const account_object &to, const asset &amount) {
+        db.adjust_balance(from, -amount);
+        db.adjust_balance(to, amount);
+    }
+
+    // The same changes of the voter as vote_evaluator does
+    void vote(database &db, const account_object &voter) {
+        auto now = db.head_block_time();
+        int64_t elapsed_seconds = (now - voter.last_vote_time).to_seconds();
+        int64_t regenerated_power = (STEEMIT_100_PERCENT * elapsed_seconds) / STEEMIT_VOTE_REGENERATION_SECONDS;
+        int64_t current_power = std::min(int64_t(voter.voting_power + regenerated_power), int64_t(STEEMIT_100_PERCENT));
+        int64_t used_power = std::max<int64_t>(current_power / 200, 1);
+        auto weight = voter.effective_vesting_shares().amount * used_power / STEEMIT_100_PERCENT;
+
+        db.modify(voter, [&](account_object &a) {
+            a.voting_power = current_power > used_power ? current_power - used_power : STEEMIT_100_PERCENT;
+            a.last_vote_time = now;
+            a.lifetime_vote_count += weight > 0 ? 1 : 0;
+        });
+    }
+
+    benchmark_result run_benchmark(const benchmark_options &options, const fc::path &data_dir) {
+        FC_ASSERT(options.accounts > 1, "At least two accounts are required");
+
+        benchmark_result result;
+        result.accounts = options.accounts;
+        result.account_object_size = sizeof(account_object);
+
+        database db;
+        fc::create_directories(data_dir);
+        db.open(data_dir / "blockchain", data_dir / "blockchain", STEEMIT_INIT_SUPPLY,
+                uint64_t(options.shared_file_size) * 1024 * 1024, chainbase::database::read_write);
+
+        db.with_strong_write_lock([&]() {
+            auto setup_start = fc::time_point::now();
+            create_accounts(db, options);
+            result.setup_time_ms = (fc::time_point::now() - setup_start).count() / 1000;
+            result.account_index_statistics = golos::chain::get_index_statistics<account_index>(db);
+
+            timer transfer_timer;
+            timer vote_timer;
+            timer block_timer;
+            uint64_t operation = 0;
+            for (uint32_t block = 0; block < options.blocks; ++block) {
+                block_timer.measure([&]() {
+                    auto session = db.start_undo_session();
+
+                    for (uint32_t i = 0; i < options.transfers_per_block; ++i, ++operation) {
+                        const auto &from = get_account(db, options, operation);
+                        const auto &to = get_account(db, options, operation + 1);
+                        // balances return back on the odd blocks
+                        auto amount = asset(block % 2 ? -1 : 1, i % 2 ? SBD_SYMBOL : STEEM_SYMBOL);
+                        transfer_timer.measure([&]() {
+                            transfer(db, from, to, amount);
+                        });
+                    }
+
+                    for (uint32_t i = 0; i < options.votes_per_block; ++i, ++operation) {
+                        const auto &voter = get_account(db, options, operation);
+                        vote_timer.measure([&]() {
+                            vote(db, voter);
+                        });
+                    }
+
+                    session.push();
+                    db.commit(db.revision());
+                });
+            }
+
+            result.transfers = transfer_timer.get_result();
+            result.votes = vote_timer.get_result();
+            result.blocks = block_timer.get_result();
+        });
+
+        db.close();
+        return result;
+    }
+
+} // anonymous namespace
+
+int main(int argc, char **argv) {
+    benchmark_options options;
+
+    bpo::options_description desc("Measures balance and voting power changes of accounts in undo sessions");
+    desc.add_options()
+        ("accounts", bpo::value<uint32_t>(&options.accounts)->default_value(options.accounts),
+            "Number of accounts")
+        ("blocks", bpo::value<uint32_t>(&options.blocks)->default_value(options.blocks),
+            "Number of applied blocks")
+        ("transfers-per-block", bpo::value<uint32_t>(&options.transfers_per_block)->default_value(options.transfers_per_block),
+            "Number of transfers in each block")
+        ("votes-per-block", bpo::value<uint32_t>(&options.votes_per_block)->default_value(options.votes_per_block),
+            "Number of votes in each block")
+        ("shared-file-size", bpo::value<uint32_t>(&options.shared_file_size)->default_value(options.shared_file_size),
+            "Size of the shared memory file in megabytes");
+
+    return golos::utilities::benchmark_main(argc, argv, desc, [&](const fc::path &data_dir, fc::variant &result) {
+        result = fc::variant(run_benchmark(options, data_dir));
+        return true;
+    });
+}
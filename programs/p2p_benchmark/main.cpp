@@ -0,0 +1,694 @@
+/**
+ * Runs several P2P nodes in one process and measures how they synchronize.
+ *
+ * The first node generates a synthetic chain of empty blocks, other nodes start with an empty database
+ * and sync it over loopback sockets using the given topology. After the sync the first node produces
+ * more blocks, and their propagation delay to all other nodes is measured.
+ *
+ * Links can be delayed by a relay, which holds the data in both directions for the given time.
+ */
+
+#include <golos/chain/database.hpp>
+#include <golos/network/node.hpp>
+#include <golos/network/exceptions.hpp>
+
+#include <graphene/utilities/benchmark.hpp>
+
+#include <fc/filesystem.hpp>
+#include <fc/network/tcp_socket.hpp>
+#include <fc/thread/thread.hpp>
+
+#include <boost/program_options.hpp>
+#include <boost/range/adaptor/reversed.hpp>
+
+#include <algorithm>
+#include <deque>
+#include <map>
+#include <memory>
+#include <mutex>
+
+namespace bpo = boost::program_options;
+
+using golos::chain::database;
+using golos::network::block_message;
+using golos::network::item_hash_t;
+using golos::network::item_id;
+using golos::network::message;
+using golos::network::network_statistics;
+using golos::network::node_delegate;
+using golos::network::trx_message;
+using golos::protocol::block_header;
+using golos::protocol::block_id_type;
+using golos::protocol::signed_block;
+using golos::protocol::signed_block_header;
+
+struct benchmark_options {
+    uint32_t nodes = 4;
+    std::string topology = "star";
+    uint32_t blocks = 10000;
+    uint32_t live_blocks = 20;
+    uint32_t block_interval_ms = 500;
+    uint32_t latency_ms = 0;
+    uint32_t bandwidth_limit = 0;
+    uint32_t shared_file_size = 256;
+    uint32_t timeout_sec = 600;
+};
+
+struct node_result {
+    uint32_t node = 0;
+    uint32_t head_block_num = 0;
+    int64_t sync_time_ms = -1;
+    uint32_t connections = 0;
+    uint64_t bytes_sent = 0;
+    uint64_t bytes_received = 0;
+    int64_t crypto_time_ms = 0;
+};
+
+struct propagation_result {
+    uint32_t deliveries = 0;
+    int64_t average_ms = 0;
+    int64_t median_ms = 0;
+    int64_t max_ms = 0;
+};
+
+struct benchmark_result {
+    uint32_t nodes = 0;
+    std::string topology;
+    uint32_t latency_ms = 0;
+    uint32_t blocks = 0;
+    bool synced = false;
+    int64_t sync_time_ms = 0;
+    propagation_result propagation;
+    std::vector<node_result> node_results;
+};
+
+FC_REFLECT((node_result), (node)(head_block_num)(sync_time_ms)(connections)(bytes_sent)(bytes_received)(crypto_time_ms))
+FC_REFLECT((propagation_result), (deliveries)(average_ms)(median_ms)(max_ms))
+FC_REFLECT((benchmark_result),
+    (nodes)(topology)(latency_ms)(blocks)(synced)(sync_time_ms)(propagation)(node_results))
+
+namespace {
+
+#ifdef STEEMIT_BUILD_TESTNET
+    const uint32_t block_skip_flags = database::skip_nothing;
+
+    fc::ecc::private_key get_block_signing_key() {
+        return STEEMIT_INIT_PRIVATE_KEY;
+    }
+#else
+    // the key of the initial witness is unknown, so blocks are neither signed nor checked
+    const uint32_t block_skip_flags = database::skip_witness_signature;
+
+    fc::ecc::private_key get_block_signing_key() {
+        return fc::ecc::private_key::regenerate(fc::sha256::hash(std::string("p2p_benchmark")));
+    }
+#endif
+
+    /**
+     * Collects delays between generation of blocks on the first node and their acceptance on other nodes
+     */
+    class propagation_tracker final {
+    public:
+        void block_generated(const block_id_type &block_id) {
+            std::lock_guard<std::mutex> lock(_mutex);
+            _generation_times[block_id] = fc::time_point::now();
+        }
+
+        void block_accepted(const block_id_type &block_id) {
+            auto now = fc::time_point::now();
+            std::lock_guard<std::mutex> lock(_mutex);
+            auto itr = _generation_times.find(block_id);
+            if (itr != _generation_times.end()) {
+                _delays.push_back((now - itr->second).count() / 1000);
+            }
+        }
+
+        propagation_result get_result() {
+            std::lock_guard<std::mutex> lock(_mutex);
+            propagation_result result;
+            if (_delays.empty()) {
+                return result;
+            }
+            std::sort(_delays.begin(), _delays.end());
+            int64_t total = 0;
+            for (auto delay : _delays) {
+                total += delay;
+            }
+            result.deliveries = _delays.size();
+            result.average_ms = total / int64_t(_delays.size());
+            result.median_ms = _delays[_delays.size() / 2];
+            result.max_ms = _delays.back();
+            return result;
+        }
+
+    private:
+        std::mutex _mutex;
+        std::map<block_id_type, fc::time_point> _generation_times;
+        std::vector<int64_t> _delays;
+    };
+
+    /**
+     * Accepts connections on a loopback port and forwards them to the target endpoint,
+     * data in both directions is delivered after the given delay
+     */
+    class latency_relay final {
+    public:
+        latency_relay(const fc::ip::endpoint &target, fc::microseconds latency)
+                : _target(target), _latency(latency) {
+            _server.listen(fc::ip::endpoint(fc::ip::address("127.0.0.1"), 0));
+            _accept_loop_done = fc::async([this]() { accept_loop(); }, "latency_relay accept_loop");
+        }
+
+        ~latency_relay() {
+            _server.close();
+            if (_accept_loop_done.valid() && !_accept_loop_done.ready()) {
+                _accept_loop_done.cancel_and_wait(__FUNCTION__);
+            }
+            for (auto &socket : _sockets) {
+                socket->close();
+            }
+            for (auto &task : _forward_tasks) {
+                if (task.valid() && !task.ready()) {
+                    task.cancel_and_wait(__FUNCTION__);
+                }
+            }
+        }
+
+        fc::ip::endpoint get_endpoint() {
+            return fc::ip::endpoint(fc::ip::address("127.0.0.1"), _server.get_port());
+        }
+
+    private:
+        using socket_ptr = std::shared_ptr<fc::tcp_socket>;
+
+        struct chunk {
+            fc::time_point delivery_time;
+            std::vector<char> data;
+        };
+
+        void accept_loop() {
+            while (!_accept_loop_done.canceled()) {
+                auto incoming = std::make_shared<fc::tcp_socket>();
+                try {
+                    _server.accept(*incoming);
+                } catch (const fc::exception &) {
+                    return;
+                }
+
+                auto outgoing = std::make_shared<fc::tcp_socket>();
+                try {
+                    outgoing->connect_to(_target);
+                } catch (const fc::exception &e) {
+                    wlog("Relay can't connect to ${target}: ${e}", ("target", _target)("e", e.to_string()));
+                    incoming->close();
+                    continue;
+                }
+
+                _sockets.push_back(incoming);
+                _sockets.push_back(outgoing);
+                _forward_tasks.push_back(fc::async([=]() { forward(incoming, outgoing); }, "latency_relay forward"));
+                _forward_tasks.push_back(fc::async([=]() { forward(outgoing, incoming); }, "latency_relay forward"));
+            }
+        }
+
+        void forward(socket_ptr from, socket_ptr to) {
+            // all tasks of the relay run in one thread, so the queue doesn't need a lock
+            auto queue = std::make_shared<std::deque<chunk>>();
+            auto reading_done = std::make_shared<bool>(false);
+
+            auto writer = fc::async([=]() {
+                try {
+                    while (!queue->empty() || !*reading_done) {
+                        if (queue->empty()) {
+                            fc::usleep(fc::milliseconds(1));
+                            continue;
+                        }
+                        fc::sleep_until(queue->front().delivery_time);
+                        to->write(queue->front().data.data(), queue->front().data.size());
+                        to->flush();
+                        queue->pop_front();
+                    }
+                } catch (const fc::exception &) {
+                }
+                to->close();
+            }, "latency_relay writer");
+
+            std::vector<char> buffer(64 * 1024);
+            try {
+                while (!writer.ready()) {
+                    auto size = from->readsome(buffer.data(), buffer.size());
+                    queue->push_back(chunk{fc::time_point::now() + _latency,
+                                           std::vector<char>(buffer.begin(), buffer.begin() + size)});
+                }
+            } catch (const fc::exception &) {
+            }
+            *reading_done = true;
+            writer.wait();
+            from->close();
+        }
+
+        fc::ip::endpoint _target;
+        fc::microseconds _latency;
+        fc::tcp_server _server;
+        fc::future<void> _accept_loop_done;
+        std::vector<socket_ptr> _sockets;
+        std::vector<fc::future<void>> _forward_tasks;
+    };
+
+    /**
+     * A P2P node with its own database, implements the delegate the same way as the p2p plugin,
+     * but without support of forks, because the synthetic chain has none
+     */
+    class benchmark_node final : public node_delegate {
+    public:
+        benchmark_node(uint32_t index, const fc::path &data_dir, const benchmark_options &options,
+                       propagation_tracker &tracker)
+                : _index(index),
+                  _data_dir(data_dir),
+                  _tracker(tracker),
+                  _thread(new fc::thread("p2p_benchmark_" + std::to_string(index))) {
+            fc::create_directories(_data_dir);
+            _db.open(_data_dir / "blockchain", _data_dir / "blockchain", STEEMIT_INIT_SUPPLY,
+                     uint64_t(options.shared_file_size) * 1024 * 1024, chainbase::database::read_write);
+        }
+
+        ~benchmark_node() {
+            close();
+        }
+
+        uint32_t index() const {
+            return _index;
+        }
+
+        void start(uint32_t bandwidth_limit) {
+            _thread->async([&]() {
+                _node.reset(new golos::network::node("p2p_benchmark"));
+                _node->load_configuration(_data_dir / "p2p");
+                _node->set_node_delegate(this);
+                // only the configured links are used
+                _node->disable_peer_advertising();
+                if (bandwidth_limit) {
+                    _node->set_total_bandwidth_limit(bandwidth_limit, bandwidth_limit);
+                }
+                _node->listen_on_endpoint(fc::ip::endpoint(fc::ip::address("127.0.0.1"), 0), false);
+                _node->listen_to_p2p_network();
+                _node->connect_to_p2p_network();
+                _node->sync_from(item_id(golos::network::block_message_type, get_head_block_id()),
+                                 std::vector<uint32_t>());
+            }, "start").wait();
+        }
+
+        void connect_to(const fc::ip::endpoint &endpoint) {
+            _node->add_node(endpoint);
+            _node->connect_to_endpoint(endpoint);
+        }
+
+        fc::ip::endpoint get_endpoint() const {
+            return _node->get_actual_listening_endpoint();
+        }
+
+        void close() {
+            if (_node) {
+                _node->close();
+                _node.reset();
+            }
+            if (_thread) {
+                _thread->quit();
+                _thread.reset();
+                _db.close();
+            }
+        }
+
+        uint32_t head_block_num() {
+            return _db.with_weak_read_lock([&]() {
+                return _db.head_block_num();
+            });
+        }
+
+        signed_block generate_block() {
+            auto key = get_block_signing_key();
+            fc::time_point_sec when;
+            std::string witness;
+            _db.with_weak_read_lock([&]() {
+                when = _db.get_slot_time(1);
+                witness = _db.get_scheduled_witness(1);
+            });
+            return _db.generate_block(when, witness, key, block_skip_flags);
+        }
+
+        void broadcast_block(const signed_block &block) {
+            _tracker.block_generated(block.id());
+            _node->broadcast(block_message(block));
+        }
+
+        network_statistics get_network_statistics() const {
+            return _node->get_network_statistics();
+        }
+
+        // node_delegate interface
+        bool has_item(const item_id &id) override {
+            return _db.with_weak_read_lock([&]() {
+                if (id.item_type == golos::network::block_message_type) {
+                    return _db.is_known_block(id.item_hash);
+                }
+                return _db.is_known_transaction(id.item_hash);
+            });
+        }
+
+        bool handle_block(const block_message &blk_msg, bool sync_mode, std::vector<fc::uint160_t> &) override {
+            bool result = _db.push_block(blk_msg.block, block_skip_flags);
+            if (!sync_mode) {
+                _tracker.block_accepted(blk_msg.block_id);
+            }
+            return result;
+        }
+
+        void handle_transaction(const trx_message &trx_msg) override {
+            _db.push_transaction(trx_msg.trx);
+        }
+
+        void handle_message(const message &) override {
+            FC_THROW("Invalid Message Type");
+        }
+
+        std::vector<item_hash_t> get_block_ids(const std::vector<item_hash_t> &blockchain_synopsis,
+                                               uint32_t &remaining_item_count, uint32_t limit) override {
+            return _db.with_weak_read_lock([&]() {
+                std::vector<item_hash_t> result;
+                remaining_item_count = 0;
+                if (_db.head_block_num() == 0) {
+                    return result;
+                }
+
+                block_id_type last_known_block_id;
+                if (!blockchain_synopsis.empty()) {
+                    bool found_a_block_in_synopsis = false;
+                    for (const item_hash_t &block_id : boost::adaptors::reverse(blockchain_synopsis)) {
+                        if (block_id == block_id_type() || is_included_block(block_id)) {
+                            last_known_block_id = block_id;
+                            found_a_block_in_synopsis = true;
+                            break;
+                        }
+                    }
+                    if (!found_a_block_in_synopsis) {
+                        FC_THROW_EXCEPTION(golos::network::peer_is_on_an_unreachable_fork,
+                                           "Unable to provide a list of blocks starting at any of the blocks in peer's synopsis");
+                    }
+                }
+
+                for (uint32_t num = block_header::num_from_id(last_known_block_id);
+                     num <= _db.head_block_num() && result.size() < limit; ++num) {
+                    if (num > 0) {
+                        result.push_back(_db.get_block_id_for_num(num));
+                    }
+                }
+
+                if (!result.empty() && block_header::num_from_id(result.back()) < _db.head_block_num()) {
+                    remaining_item_count = _db.head_block_num() - block_header::num_from_id(result.back());
+                }
+                return result;
+            });
+        }
+
+        message get_item(const item_id &id) override {
+            return _db.with_weak_read_lock([&]() -> message {
+                if (id.item_type == golos::network::block_message_type) {
+                    auto block = _db.fetch_block_by_id(id.item_hash);
+                    if (!block) {
+                        FC_THROW_EXCEPTION(fc::key_not_found_exception, "Block ${id} not found", ("id", id.item_hash));
+                    }
+                    return block_message(std::move(*block));
+                }
+                return trx_message(_db.get_recent_transaction(id.item_hash));
+            });
+        }
+
+        std::vector<message> get_block_range(const item_hash_t &last_block_id, uint32_t first_block_num,
+                                             uint32_t count) override {
+            return _db.with_weak_read_lock([&]() {
+                FC_ASSERT(is_included_block(last_block_id), "Block isn't in our main chain");
+
+                std::vector<message> result;
+                for (auto &data : _db.get_block_log().read_serialized_blocks(first_block_num, count)) {
+                    fc::datastream<const char *> ds(data.data(), data.size());
+                    signed_block_header header;
+                    fc::raw::unpack(ds, header);
+
+                    auto packed_block_id = fc::raw::pack(header.id());
+                    data.insert(data.end(), packed_block_id.begin(), packed_block_id.end());
+
+                    message msg;
+                    msg.msg_type = golos::network::block_message_type;
+                    msg.size = data.size();
+                    msg.data = std::move(data);
+                    result.push_back(std::move(msg));
+                }
+
+                for (uint32_t block_num = first_block_num + result.size();
+                     block_num - first_block_num < count; ++block_num) {
+                    auto block = _db.fetch_block_by_number(block_num);
+                    if (!block) {
+                        break;
+                    }
+                    result.push_back(block_message(std::move(*block)));
+                }
+                return result;
+            });
+        }
+
+        std::vector<item_hash_t> get_blockchain_synopsis(const item_hash_t &reference_point,
+                                                         uint32_t number_of_blocks_after_reference_point) override {
+            return _db.with_weak_read_lock([&]() {
+                std::vector<item_hash_t> synopsis;
+                uint32_t low_block_num = std::max<uint32_t>(_db.last_non_undoable_block_num(), 1);
+                uint32_t high_block_num = _db.head_block_num();
+                if (reference_point != item_hash_t()) {
+                    FC_ASSERT(is_included_block(reference_point), "Forks are not supported");
+                    high_block_num = block_header::num_from_id(reference_point);
+                    low_block_num = std::min(low_block_num, high_block_num);
+                }
+                if (high_block_num == 0) {
+                    return synopsis;
+                }
+
+                uint32_t true_high_block_num = high_block_num + number_of_blocks_after_reference_point;
+                do {
+                    synopsis.push_back(_db.get_block_id_for_num(low_block_num));
+                    low_block_num += (true_high_block_num - low_block_num + 2) / 2;
+                } while (low_block_num <= high_block_num);
+                return synopsis;
+            });
+        }
+
+        void sync_status(uint32_t, uint32_t) override {
+        }
+
+        void connection_count_changed(uint32_t) override {
+        }
+
+        uint32_t get_block_number(const item_hash_t &block_id) override {
+            return block_header::num_from_id(block_id);
+        }
+
+        fc::time_point_sec get_block_time(const item_hash_t &block_id) override {
+            return _db.with_weak_read_lock([&]() {
+                auto block = _db.fetch_block_by_id(block_id);
+                return block ? block->timestamp : fc::time_point_sec::min();
+            });
+        }
+
+        fc::time_point_sec get_blockchain_now() override {
+            return fc::time_point::now();
+        }
+
+        item_hash_t get_head_block_id() const override {
+            return _db.with_weak_read_lock([&]() {
+                return _db.head_block_id();
+            });
+        }
+
+        uint32_t estimate_last_known_fork_from_git_revision_timestamp(uint32_t) const override {
+            return 0;
+        }
+
+        void error_encountered(const std::string &, const fc::oexception &) override {
+        }
+
+    private:
+        bool is_included_block(const block_id_type &block_id) {
+            return _db.find_block_id_for_num(block_header::num_from_id(block_id)) == block_id;
+        }
+
+        uint32_t _index;
+        fc::path _data_dir;
+        propagation_tracker &_tracker;
+        mutable database _db;
+        std::unique_ptr<fc::thread> _thread;
+        std::unique_ptr<golos::network::node> _node;
+    };
+
+    // returns pairs of (connecting node, listening node)
+    std::vector<std::pair<uint32_t, uint32_t>> make_links(const std::string &topology, uint32_t nodes) {
+        std::vector<std::pair<uint32_t, uint32_t>> links;
+        if (topology == "star") {
+            for (uint32_t i = 1; i < nodes; ++i) {
+                links.emplace_back(i, 0);
+            }
+        } else if (topology == "line" || topology == "ring") {
+            for (uint32_t i = 1; i < nodes; ++i) {
+                links.emplace_back(i, i - 1);
+            }
+            if (topology == "ring" && nodes > 2) {
+                links.emplace_back(0, nodes - 1);
+            }
+        } else if (topology == "mesh") {
+            for (uint32_t i = 1; i < nodes; ++i) {
+                for (uint32_t j = 0; j < i; ++j) {
+                    links.emplace_back(i, j);
+                }
+            }
+        } else {
+            FC_THROW_EXCEPTION(fc::invalid_arg_exception, "Unknown topology ${t}", ("t", topology));
+        }
+        return links;
+    }
+
+    // waits until all nodes have the head block of the first node, returns false on timeout
+    bool wait_for_sync(std::vector<std::unique_ptr<benchmark_node>> &nodes, fc::time_point start,
+                       fc::time_point deadline, std::vector<node_result> &results) {
+        uint32_t target_block_num = nodes.front()->head_block_num();
+        while (true) {
+            bool synced = true;
+            for (auto &node : nodes) {
+                auto &result = results[node->index()];
+                result.head_block_num = node->head_block_num();
+                if (result.head_block_num < target_block_num) {
+                    synced = false;
+                } else if (result.sync_time_ms < 0) {
+                    result.sync_time_ms = (fc::time_point::now() - start).count() / 1000;
+                }
+            }
+            if (synced) {
+                return true;
+            }
+            if (fc::time_point::now() > deadline) {
+                return false;
+            }
+            fc::usleep(fc::milliseconds(50));
+        }
+    }
+
+    benchmark_result run_benchmark(const benchmark_options &options, const fc::path &data_dir) {
+        FC_ASSERT(options.nodes >= 2, "At least 2 nodes are required");
+        auto links = make_links(options.topology, options.nodes);
+
+        benchmark_result result;
+        result.nodes = options.nodes;
+        result.topology = options.topology;
+        result.latency_ms = options.latency_ms;
+        result.blocks = options.blocks;
+        result.node_results.resize(options.nodes);
+
+        propagation_tracker tracker;
+        std::vector<std::unique_ptr<benchmark_node>> nodes;
+        for (uint32_t i = 0; i < options.nodes; ++i) {
+            nodes.emplace_back(new benchmark_node(i, data_dir / ("node" + std::to_string(i)), options, tracker));
+            result.node_results[i].node = i;
+        }
+
+        ilog("Generating ${n} blocks", ("n", options.blocks));
+        for (uint32_t i = 0; i < options.blocks; ++i) {
+            nodes.front()->generate_block();
+        }
+
+        for (auto &node : nodes) {
+            node->start(options.bandwidth_limit);
+        }
+
+        fc::thread relay_thread("p2p_benchmark_relay");
+        std::vector<std::unique_ptr<latency_relay>> relays;
+
+        auto start = fc::time_point::now();
+        for (const auto &link : links) {
+            auto endpoint = nodes[link.second]->get_endpoint();
+            if (options.latency_ms) {
+                relays.emplace_back(relay_thread.async([&]() {
+                    return new latency_relay(endpoint, fc::milliseconds(options.latency_ms));
+                }, "create latency_relay").wait());
+                endpoint = relays.back()->get_endpoint();
+            }
+            nodes[link.first]->connect_to(endpoint);
+        }
+
+        auto deadline = start + fc::seconds(options.timeout_sec);
+        result.synced = wait_for_sync(nodes, start, deadline, result.node_results);
+        result.sync_time_ms = (fc::time_point::now() - start).count() / 1000;
+        ilog("Sync ${r} in ${t} ms", ("r", result.synced ? "completed" : "timed out")("t", result.sync_time_ms));
+
+        if (result.synced) {
+            for (uint32_t i = 0; i < options.live_blocks; ++i) {
+                nodes.front()->broadcast_block(nodes.front()->generate_block());
+                fc::usleep(fc::milliseconds(options.block_interval_ms));
+            }
+            std::vector<node_result> live_results(options.nodes);
+            wait_for_sync(nodes, fc::time_point::now(), fc::time_point::now() + fc::seconds(10), live_results);
+            for (auto &node : nodes) {
+                result.node_results[node->index()].head_block_num = live_results[node->index()].head_block_num;
+            }
+            result.propagation = tracker.get_result();
+        }
+
+        for (auto &node : nodes) {
+            auto statistics = node->get_network_statistics();
+            auto &node_result = result.node_results[node->index()];
+            node_result.connections = statistics.connections;
+            node_result.crypto_time_ms = statistics.crypto_time / 1000;
+            for (const auto &peer : statistics.peers) {
+                node_result.bytes_sent += peer.bytes_sent;
+                node_result.bytes_received += peer.bytes_received;
+            }
+        }
+
+        for (auto &node : nodes) {
+            node->close();
+        }
+        relay_thread.async([&]() {
+            relays.clear();
+        }, "destroy latency_relays").wait();
+        relay_thread.quit();
+
+        return result;
+    }
+
+} // anonymous namespace
+
+int main(int argc, char **argv) {
+    benchmark_options options;
+
+    bpo::options_description desc("Runs several P2P nodes in one process and measures their synchronization");
+    desc.add_options()
+        ("nodes", bpo::value<uint32_t>(&options.nodes)->default_value(options.nodes),
+            "Number of nodes, the first one has the whole chain")
+        ("topology", bpo::value<std::string>(&options.topology)->default_value(options.topology),
+            "How nodes are connected: star (all to the first node), line, ring or mesh")
+        ("blocks", bpo::value<uint32_t>(&options.blocks)->default_value(options.blocks),
+            "Number of blocks in the synthetic chain to sync")
+        ("live-blocks", bpo::value<uint32_t>(&options.live_blocks)->default_value(options.live_blocks),
+            "Number of blocks to broadcast after the sync to measure their propagation")
+        ("block-interval-ms", bpo::value<uint32_t>(&options.block_interval_ms)->default_value(options.block_interval_ms),
+            "Interval between broadcasted blocks")
+        ("latency-ms", bpo::value<uint32_t>(&options.latency_ms)->default_value(options.latency_ms),
+            "Artificial one-way delay of each link")
+        ("bandwidth-limit", bpo::value<uint32_t>(&options.bandwidth_limit)->default_value(options.bandwidth_limit),
+            "Upload and download limit of each node in bytes per second (0 - unlimited)")
+        ("shared-file-size", bpo::value<uint32_t>(&options.shared_file_size)->default_value(options.shared_file_size),
+            "Size of the shared memory file of each node in megabytes")
+        ("timeout", bpo::value<uint32_t>(&options.timeout_sec)->default_value(options.timeout_sec),
+            "Maximum duration of the sync in seconds");
+
+    return golos::utilities::benchmark_main(argc, argv, desc, [&](const fc::path &data_dir, fc::variant &result) {
+        auto benchmark = run_benchmark(options, data_dir);
+        result = fc::variant(benchmark);
+        return benchmark.synced;
+    });
+}
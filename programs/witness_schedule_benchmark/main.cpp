@@ -0,0 +1,205 @@
+/**
+ * Measures maintenance of the witness schedule with many registered witnesses and heavy proxy chains.
+ *
+ * The database is filled directly with witnesses and chains of accounts, where each account proxies
+ * its votes to the next one and the last account votes for the maximum number of witnesses.
+ * The benchmark changes vesting shares of the first accounts of chains, which propagates the change
+ * through the whole chain to the voted witnesses, and rebuilds the schedule after each batch of changes.
+ */
+
+#include <golos/chain/database.hpp>
+#include <golos/chain/account_object.hpp>
+#include <golos/chain/witness_objects.hpp>
+
+#include <graphene/utilities/benchmark.hpp>
+
+#include <fc/filesystem.hpp>
+
+#include <boost/program_options.hpp>
+
+#include <algorithm>
+
+namespace bpo = boost::program_options;
+
+using golos::chain::account_object;
+using golos::chain::database;
+using golos::chain::dynamic_global_property_object;
+using golos::chain::witness_object;
+using golos::chain::witness_vote_object;
+using golos::protocol::account_name_type;
+using golos::protocol::asset;
+using golos::protocol::public_key_type;
+using golos::protocol::share_type;
+using golos::utilities::timer;
+using golos::utilities::timing_result;
+
+struct benchmark_options {
+    uint32_t witnesses = 5000;
+    uint32_t proxy_chains = 2000;
+    uint32_t proxy_depth = STEEMIT_MAX_PROXY_RECURSION_DEPTH;
+    uint32_t rounds = 1000;
+    uint32_t updates_per_round = 100;
+    uint32_t shared_file_size = 1024;
+};
+
+struct benchmark_result {
+    uint32_t witnesses = 0;
+    uint32_t proxy_chains = 0;
+    uint32_t proxy_depth = 0;
+    int64_t setup_time_ms = 0;
+    timing_result vote_updates;
+    timing_result schedule_updates;
+};
+
+FC_REFLECT((benchmark_result),
+    (witnesses)(proxy_chains)(proxy_depth)(setup_time_ms)(vote_updates)(schedule_updates))
+
+namespace {
+
+    const share_type account_vesting = 1000000;
+
+    account_name_type witness_name(uint32_t index) {
+        return "bench-w" + std::to_string(index);
+    }
+
+    account_name_type chain_account_name(uint32_t chain, uint32_t depth) {
+        return "bench-c" + std::to_string(chain) + "-" + std::to_string(depth);
+    }
+
+    void create_witnesses(database &db, const benchmark_options &options) {
+        public_key_type signing_key = fc::ecc::private_key::regenerate(
+            fc::sha256::hash(std::string("witness_schedule_benchmark"))).get_public_key();
+
+        for (uint32_t i = 0; i < options.witnesses; ++i) {
+            db.create<witness_object>([&](witness_object &w) {
+                w.owner = witness_name(i);
+                w.signing_key = signing_key;
+                w.created = db.head_block_time();
+            });
+        }
+    }
+
+    void create_proxy_chains(database &db, const benchmark_options &options) {
+        const auto &gpo = db.get_dynamic_global_properties();
+        db.modify(gpo, [&](dynamic_global_property_object &p) {
+            p.total_vesting_shares += asset(
+                account_vesting * options.proxy_chains * (options.proxy_depth + 1), VESTS_SYMBOL);
+        });
+
+        const uint32_t votes = std::min<uint32_t>(STEEMIT_MAX_ACCOUNT_WITNESS_VOTES, options.witnesses);
+
+        for (uint32_t chain = 0; chain < options.proxy_chains; ++chain) {
+            for (uint32_t depth = 0; depth <= options.proxy_depth; ++depth) {
+                db.create<account_object>([&](account_object &a) {
+                    a.name = chain_account_name(chain, depth);
+                    a.vesting_shares = asset(account_vesting, VESTS_SYMBOL);
+                    if (depth < options.proxy_depth) {
+                        a.proxy = chain_account_name(chain, depth + 1);
+                    } else {
+                        a.witnesses_voted_for = votes;
+                    }
+                });
+            }
+
+            const auto &voter = db.get_account(chain_account_name(chain, options.proxy_depth));
+            for (uint32_t i = 0; i < votes; ++i) {
+                const auto &witness = db.get_witness(witness_name((chain * votes + i) % options.witnesses));
+                db.create<witness_vote_object>([&](witness_vote_object &v) {
+                    v.witness = witness.id;
+                    v.account = voter.id;
+                });
+            }
+
+            for (uint32_t depth = 0; depth <= options.proxy_depth; ++depth) {
+                db.adjust_proxied_witness_votes(db.get_account(chain_account_name(chain, depth)), account_vesting);
+            }
+        }
+    }
+
+    // Changes vesting shares of the first account of the chain, the change reaches the voted witnesses
+    void update_chain_votes(database &db, uint32_t chain, share_type delta) {
+        const auto &account = db.get_account(chain_account_name(chain, 0));
+        db.modify(account, [&](account_object &a) {
+            a.vesting_shares.amount += delta;
+        });
+        db.modify(db.get_dynamic_global_properties(), [&](dynamic_global_property_object &p) {
+            p.total_vesting_shares.amount += delta;
+        });
+        db.adjust_proxied_witness_votes(account, delta);
+    }
+
+    benchmark_result run_benchmark(const benchmark_options &options, const fc::path &data_dir) {
+        FC_ASSERT(options.witnesses > 0, "At least one witness is required");
+        FC_ASSERT(options.proxy_chains > 0, "At least one proxy chain is required");
+        FC_ASSERT(options.proxy_depth <= STEEMIT_MAX_PROXY_RECURSION_DEPTH,
+                  "Proxy depth can't be greater than ${max}", ("max", STEEMIT_MAX_PROXY_RECURSION_DEPTH));
+
+        benchmark_result result;
+        result.witnesses = options.witnesses;
+        result.proxy_chains = options.proxy_chains;
+        result.proxy_depth = options.proxy_depth;
+
+        database db;
+        fc::create_directories(data_dir);
+        db.open(data_dir / "blockchain", data_dir / "blockchain", STEEMIT_INIT_SUPPLY,
+                uint64_t(options.shared_file_size) * 1024 * 1024, chainbase::database::read_write);
+
+        db.with_strong_write_lock([&]() {
+            auto setup_start = fc::time_point::now();
+            db.set_hardfork(STEEMIT_NUM_HARDFORKS);
+            create_witnesses(db, options);
+            create_proxy_chains(db, options);
+            result.setup_time_ms = (fc::time_point::now() - setup_start).count() / 1000;
+
+            timer vote_timer;
+            timer schedule_timer;
+            uint32_t update = 0;
+            for (uint32_t round = 0; round < options.rounds; ++round) {
+                for (uint32_t i = 0; i < options.updates_per_round; ++i, ++update) {
+                    uint32_t chain = update % options.proxy_chains;
+                    // votes grow on the odd passes over chains and return back on the even ones
+                    share_type delta = (update / options.proxy_chains) % 2 ? -account_vesting : account_vesting;
+                    vote_timer.measure([&]() {
+                        update_chain_votes(db, chain, delta);
+                    });
+                }
+
+                // the schedule is rebuilt only when the head block is the first one of a round
+                schedule_timer.measure([&]() {
+                    db.update_witness_schedule();
+                });
+            }
+
+            result.vote_updates = vote_timer.get_result();
+            result.schedule_updates = schedule_timer.get_result();
+        });
+
+        db.close();
+        return result;
+    }
+
+} // anonymous namespace
+
+int main(int argc, char **argv) {
+    benchmark_options options;
+
+    bpo::options_description desc("Measures maintenance of the witness schedule with many witnesses and proxies");
+    desc.add_options()
+        ("witnesses", bpo::value<uint32_t>(&options.witnesses)->default_value(options.witnesses),
+            "Number of registered witnesses")
+        ("proxy-chains", bpo::value<uint32_t>(&options.proxy_chains)->default_value(options.proxy_chains),
+            "Number of proxy chains, the last account of each chain votes for the maximum number of witnesses")
+        ("proxy-depth", bpo::value<uint32_t>(&options.proxy_depth)->default_value(options.proxy_depth),
+            "Number of proxies in each chain")
+        ("rounds", bpo::value<uint32_t>(&options.rounds)->default_value(options.rounds),
+            "Number of schedule updates")
+        ("updates-per-round", bpo::value<uint32_t>(&options.updates_per_round)->default_value(options.updates_per_round),
+            "Number of vote changes before each schedule update")
+        ("shared-file-size", bpo::value<uint32_t>(&options.shared_file_size)->default_value(options.shared_file_size),
+            "Size of the shared memory file in megabytes");
+
+    return golos::utilities::benchmark_main(argc, argv, desc, [&](const fc::path &data_dir, fc::variant &result) {
+        result = fc::variant(run_benchmark(options, data_dir));
+        return true;
+    });
+}
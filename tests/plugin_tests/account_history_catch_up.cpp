@@ -0,0 +1,212 @@
+#ifdef STEEMIT_BUILD_TESTNET
+
+#include <boost/test/unit_test.hpp>
+
+#include <golos/plugins/account_history/history_object.hpp>
+#include <golos/plugins/operation_history/history_object.hpp>
+
+#include "database_fixture.hpp"
+
+#include <fc/io/json.hpp>
+
+using namespace golos::chain;
+using namespace golos::protocol;
+using namespace golos::plugins::account_history;
+
+using golos::plugins::operation_history::operation_index;
+using golos::plugins::operation_history::operation_id_type;
+
+namespace {
+
+    using history_snapshot = std::map<std::string, std::string>;
+
+    struct account_history_catch_up_fixture : public clean_database_fixture {
+        const std::vector<std::string> accounts = {STEEMIT_INIT_MINER_NAME, "alice", "bob", "carol", "dave"};
+
+        std::string history_of(const std::string &account) {
+            golos::plugins::json_rpc::msg_pack msg;
+            msg.args = std::vector<fc::variant>({
+                fc::variant(account), fc::variant(uint64_t(uint32_t(-1))), fc::variant(1000)});
+            return fc::json::to_string(ah_plugin->get_account_history(msg));
+        }
+
+        history_snapshot history() {
+            history_snapshot result;
+            for (auto &account : accounts) {
+                result[account] = history_of(account);
+            }
+            return result;
+        }
+
+        operation_id_type next_stored_operation() {
+            const auto &idx = db->get_index<operation_index>().indices();
+            BOOST_REQUIRE(!idx.empty());
+            return operation_id_type(idx.rbegin()->id._id + 1);
+        }
+
+        const account_history_progress_object *progress() {
+            return db->find<account_history_progress_object>();
+        }
+
+        // Drops the indexed history starting from the operation, like the plugin was disabled since it
+        void remove_history(operation_id_type from_operation) {
+            const auto &idx = db->get_index<account_history_index>().indices().get<by_id>();
+            for (auto itr = idx.begin(); itr != idx.end();) {
+                const auto &history = *itr;
+                ++itr;
+                if (!(history.op < from_operation)) {
+                    db->remove(history);
+                }
+            }
+        }
+
+        void remove_progress() {
+            if (progress() != nullptr) {
+                db->remove(*progress());
+            }
+        }
+
+        void set_progress(operation_id_type next_operation) {
+            BOOST_REQUIRE(progress() != nullptr);
+            db->modify(*progress(), [&](account_history_progress_object &p) {
+                p.next_operation = next_operation;
+            });
+        }
+
+        void catch_up() {
+            ah_plugin->plugin_startup();
+            BOOST_REQUIRE(progress() != nullptr);
+            BOOST_CHECK(progress()->next_operation == next_stored_operation());
+        }
+
+        std::vector<operation_id_type> operations_of(const std::string &account) {
+            std::vector<operation_id_type> result;
+            const auto &idx = db->get_index<account_history_index>().indices().get<by_account>();
+            for (auto itr = idx.lower_bound(std::make_tuple(account)); itr != idx.end() && itr->account == account; ++itr) {
+                result.push_back(itr->op);
+            }
+            std::sort(result.begin(), result.end());
+            return result;
+        }
+
+        // Creates the operations, all of them are indexed live, returns the first operation of the second half
+        operation_id_type build_history() {
+            ACTORS((alice)(bob)(carol)(dave));
+            generate_block();
+
+            transfer(STEEMIT_INIT_MINER_NAME, "alice", 1000);
+            transfer(STEEMIT_INIT_MINER_NAME, "carol", 1000);
+            generate_block();
+
+            auto middle_operation = next_stored_operation();
+
+            transfer("alice", "bob", 100);
+            transfer("bob", "alice", 10);
+            generate_block();
+            transfer("alice", "bob", 200);
+            generate_blocks(2);
+
+            // direct modifications of the state aren't undone with the pending transactions
+            db->clear_pending();
+
+            // like the restart of the node, operations indexed above don't cut off the next catch up
+            catch_up();
+            return middle_operation;
+        }
+    };
+
+} // anonymous namespace
+
+BOOST_FIXTURE_TEST_SUITE(account_history_catch_up, account_history_catch_up_fixture)
+
+    BOOST_AUTO_TEST_CASE(empty_history_without_progress) {
+        try {
+            build_history();
+            auto reference = history();
+
+            BOOST_TEST_MESSAGE("The whole history is indexed when the plugin is enabled on a node without it");
+
+            remove_history(operation_id_type());
+            remove_progress();
+            BOOST_REQUIRE(operations_of("alice").empty());
+
+            catch_up();
+            BOOST_CHECK(history() == reference);
+        }
+        FC_LOG_AND_RETHROW()
+    }
+
+    BOOST_AUTO_TEST_CASE(history_without_progress) {
+        try {
+            auto middle_operation = build_history();
+
+            BOOST_TEST_MESSAGE("The history built before the progress was tracked is kept as is");
+
+            remove_history(middle_operation);
+            remove_progress();
+            auto reference = history();
+
+            catch_up();
+            BOOST_CHECK(history() == reference);
+        }
+        FC_LOG_AND_RETHROW()
+    }
+
+    BOOST_AUTO_TEST_CASE(stale_progress) {
+        try {
+            auto middle_operation = build_history();
+            auto reference = history();
+
+            BOOST_TEST_MESSAGE("Operations after the stale mark are indexed with the sequences of the live indexing");
+
+            remove_history(middle_operation);
+            set_progress(middle_operation);
+            BOOST_REQUIRE(history_of("bob") != reference["bob"]);
+
+            catch_up();
+            BOOST_CHECK(history() == reference);
+
+            BOOST_TEST_MESSAGE("The next catch up has nothing to index");
+
+            catch_up();
+            BOOST_CHECK(history() == reference);
+        }
+        FC_LOG_AND_RETHROW()
+    }
+
+    BOOST_AUTO_TEST_CASE(live_operations_are_not_caught_up) {
+        try {
+            build_history();
+            auto reference = history();
+            auto carol_operations = operations_of("carol");
+            auto dave_operations = operations_of("dave");
+
+            remove_history(operation_id_type());
+            remove_progress();
+
+            BOOST_TEST_MESSAGE("The block applied before the startup is indexed live");
+
+            auto live_operation = next_stored_operation();
+            transfer("carol", "dave", 100);
+            generate_block();
+            db->clear_pending();
+            BOOST_REQUIRE(progress() == nullptr);
+
+            catch_up();
+
+            BOOST_TEST_MESSAGE("Operations before the first live one are caught up, the live one isn't indexed twice");
+
+            for (auto &account : {STEEMIT_INIT_MINER_NAME, "alice", "bob"}) {
+                BOOST_CHECK_EQUAL(history_of(account), reference[account]);
+            }
+
+            carol_operations.push_back(live_operation);
+            dave_operations.push_back(live_operation);
+            BOOST_CHECK(operations_of("carol") == carol_operations);
+            BOOST_CHECK(operations_of("dave") == dave_operations);
+        }
+        FC_LOG_AND_RETHROW()
+    }
+
+BOOST_AUTO_TEST_SUITE_END()
+#endif
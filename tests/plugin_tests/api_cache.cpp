@@ -0,0 +1,179 @@
+#include <boost/test/unit_test.hpp>
+
+#include <golos/plugins/json_rpc/api_cache.hpp>
+
+#include <fc/crypto/ripemd160.hpp>
+#include <fc/variant_object.hpp>
+
+using golos::plugins::json_rpc::api_cache;
+using golos::plugins::json_rpc::api_cache_scope;
+using golos::plugins::json_rpc::msg_pack;
+
+namespace {
+
+    fc::ripemd160 block_id(uint32_t num) {
+        return fc::ripemd160::hash(std::to_string(num));
+    }
+
+    api_cache::ticket make_ticket(
+        const api_cache &cache, const std::string &method, std::vector<fc::variant> args,
+        api_cache_scope scope = api_cache_scope::head_block
+    ) {
+        msg_pack msg;
+        msg.plugin = "database_api";
+        msg.method = method;
+        msg.args = std::move(args);
+        return cache.make_ticket(msg, scope);
+    }
+
+    api_cache::ticket make_ticket(const api_cache &cache, const std::string &method) {
+        return make_ticket(cache, method, {});
+    }
+
+} // anonymous namespace
+
+BOOST_AUTO_TEST_SUITE(api_cache_tests)
+
+    BOOST_AUTO_TEST_CASE(store_and_find) {
+        api_cache cache;
+        BOOST_CHECK(!cache.enabled());
+
+        cache.configure(10, 1024 * 1024);
+        BOOST_CHECK(cache.enabled());
+        cache.set_head(block_id(1), 0);
+
+        auto t = make_ticket(cache, "get_config");
+        BOOST_CHECK(!cache.find(t).valid());
+
+        cache.store(t, "{\"a\":1}");
+        auto result = cache.find(t);
+        BOOST_REQUIRE(result.valid());
+        BOOST_CHECK_EQUAL(*result, "{\"a\":1}");
+
+        auto stats = cache.statistics();
+        BOOST_CHECK_EQUAL(stats.hits, 1);
+        BOOST_CHECK_EQUAL(stats.misses, 1);
+        BOOST_CHECK_EQUAL(stats.entries, 1);
+    }
+
+    BOOST_AUTO_TEST_CASE(canonical_key) {
+        api_cache cache;
+        cache.configure(10, 1024 * 1024);
+
+        fc::mutable_variant_object ab;
+        ab("a", 1)("b", 2);
+        fc::mutable_variant_object ba;
+        ba("b", 2)("a", 1);
+
+        auto t1 = make_ticket(cache, "get_accounts", {fc::variant(ab)});
+        auto t2 = make_ticket(cache, "get_accounts", {fc::variant(ba)});
+        BOOST_CHECK_EQUAL(t1.key, t2.key);
+
+        auto t3 = make_ticket(cache, "get_accounts", {fc::variant(1)});
+        BOOST_CHECK_NE(t1.key, t3.key);
+    }
+
+    BOOST_AUTO_TEST_CASE(lru_eviction_by_entries) {
+        api_cache cache;
+        cache.configure(2, 1024 * 1024);
+        cache.set_head(block_id(1), 0);
+
+        auto a = make_ticket(cache, "a");
+        auto b = make_ticket(cache, "b");
+        auto c = make_ticket(cache, "c");
+
+        cache.store(a, "1");
+        cache.store(b, "2");
+
+        // a becomes the most recently used, so b is evicted
+        BOOST_CHECK(cache.find(a).valid());
+        cache.store(c, "3");
+
+        BOOST_CHECK(cache.find(a).valid());
+        BOOST_CHECK(!cache.find(b).valid());
+        BOOST_CHECK(cache.find(c).valid());
+
+        auto stats = cache.statistics();
+        BOOST_CHECK_EQUAL(stats.entries, 2);
+        BOOST_CHECK_EQUAL(stats.evictions, 1);
+    }
+
+    BOOST_AUTO_TEST_CASE(eviction_by_size) {
+        const std::string result(1000, 'x');
+
+        api_cache cache;
+        // fits two results with keys and bookkeeping, but not three
+        cache.configure(100, 2 * result.size() + 500);
+        cache.set_head(block_id(1), 0);
+
+        auto a = make_ticket(cache, "a");
+        auto b = make_ticket(cache, "b");
+        auto c = make_ticket(cache, "c");
+
+        cache.store(a, result);
+        cache.store(b, result);
+        BOOST_CHECK(cache.find(a).valid());
+        BOOST_CHECK(cache.find(b).valid());
+
+        cache.store(c, result);
+        BOOST_CHECK(!cache.find(a).valid());
+        BOOST_CHECK(cache.find(b).valid());
+        BOOST_CHECK(cache.find(c).valid());
+
+        auto stats = cache.statistics();
+        BOOST_CHECK_LE(stats.size, 2 * result.size() + 500);
+
+        // a result bigger than the whole cache isn't stored and doesn't evict others
+        auto d = make_ticket(cache, "d");
+        cache.store(d, std::string(3 * result.size(), 'x'));
+        BOOST_CHECK(!cache.find(d).valid());
+        BOOST_CHECK(cache.find(b).valid());
+        BOOST_CHECK(cache.find(c).valid());
+    }
+
+    BOOST_AUTO_TEST_CASE(head_change_ticket) {
+        api_cache cache;
+        cache.configure(10, 1024 * 1024);
+        cache.set_head(block_id(1), 0);
+
+        // the head block changes while the method is executed
+        auto stale = make_ticket(cache, "get_dynamic_global_properties");
+        cache.set_head(block_id(2), 1);
+        cache.store(stale, "{}");
+        BOOST_CHECK(!cache.find(make_ticket(cache, "get_dynamic_global_properties")).valid());
+
+        auto fresh = make_ticket(cache, "get_dynamic_global_properties");
+        cache.store(fresh, "{}");
+        BOOST_CHECK(cache.find(fresh).valid());
+
+        // the next head block drops responses of the previous one
+        cache.set_head(block_id(3), 2);
+        BOOST_CHECK(!cache.find(make_ticket(cache, "get_dynamic_global_properties")).valid());
+        BOOST_CHECK_EQUAL(cache.statistics().entries, 0);
+    }
+
+    BOOST_AUTO_TEST_CASE(irreversible_responses_survive_head_change) {
+        api_cache cache;
+        cache.configure(10, 1024 * 1024);
+        cache.set_head(block_id(10), 5);
+
+        auto irreversible = make_ticket(cache, "get_block", {fc::variant(5)}, api_cache_scope::irreversible_block);
+        auto reversible = make_ticket(cache, "get_block", {fc::variant(6)}, api_cache_scope::irreversible_block);
+        BOOST_CHECK(irreversible.permanent);
+        BOOST_CHECK(!reversible.permanent);
+
+        cache.store(irreversible, "{\"block\":5}");
+        cache.store(reversible, "{\"block\":6}");
+
+        cache.set_head(block_id(11), 6);
+        BOOST_CHECK(cache.find(irreversible).valid());
+        BOOST_CHECK(!cache.find(reversible).valid());
+
+        // a permanent result is stored even if the head was changed during the call
+        auto late = make_ticket(cache, "get_block", {fc::variant(4)}, api_cache_scope::irreversible_block);
+        cache.set_head(block_id(12), 7);
+        cache.store(late, "{\"block\":4}");
+        BOOST_CHECK(cache.find(late).valid());
+    }
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,239 @@
+#ifdef STEEMIT_BUILD_TESTNET
+
+#include <boost/test/unit_test.hpp>
+
+#include <golos/chain/database_exceptions.hpp>
+#include <golos/plugins/chain/async_observer.hpp>
+
+#include "database_fixture.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <thread>
+
+using namespace golos::chain;
+using namespace golos::protocol;
+
+namespace {
+
+    struct operation_snapshot {
+        uint32_t block = 0;
+        int64_t op_tag = -1;
+        bool is_applied = false;
+    };
+
+    using test_observer = golos::plugins::chain::async_observer<operation_snapshot>;
+
+    // Records the delivered blocks, it's read on the test thread after the observer is stopped
+    struct delivered_blocks {
+        std::vector<test_observer::block_notification> blocks;
+        std::atomic<uint32_t> count{0};
+        std::chrono::milliseconds delay{0};
+
+        std::unique_ptr<test_observer> observe(database &db, uint32_t max_queue_blocks = 1000) {
+            return std::unique_ptr<test_observer>(new test_observer(
+                db, "test",
+                [](const operation_notification &note, operation_snapshot &snapshot) {
+                    snapshot.block = note.block;
+                    snapshot.op_tag = note.op.which();
+                },
+                [](const operation_notification &, operation_snapshot &snapshot) {
+                    snapshot.is_applied = true;
+                },
+                [this](const test_observer::block_notification &notification) {
+                    if (delay.count() > 0) {
+                        std::this_thread::sleep_for(delay);
+                    }
+                    blocks.push_back(notification);
+                    ++count;
+                },
+                max_queue_blocks));
+        }
+
+        const test_observer::block_notification &get(uint32_t block_num) const {
+            auto itr = std::find_if(blocks.begin(), blocks.end(), [&](const test_observer::block_notification &n) {
+                return n.block.block_num() == block_num;
+            });
+            BOOST_REQUIRE(itr != blocks.end());
+            return *itr;
+        }
+
+        bool has_transfer(uint32_t block_num) const {
+            for (auto &snapshot : get(block_num).snapshots) {
+                if (snapshot.op_tag == operation::tag<transfer_operation>::value) {
+                    return true;
+                }
+            }
+            return false;
+        }
+    };
+
+} // anonymous namespace
+
+BOOST_FIXTURE_TEST_SUITE(async_observer, clean_database_fixture)
+
+    BOOST_AUTO_TEST_CASE(irreversible_blocks_in_order) {
+        try {
+            delivered_blocks delivered;
+            auto observer = delivered.observe(*db);
+            auto first_block_num = db->head_block_num() + 1;
+
+            ACTORS((alice));
+            generate_block();
+
+            transfer(STEEMIT_INIT_MINER_NAME, "alice", 1000);
+            generate_block();
+            auto transfer_block_num = db->head_block_num();
+
+            generate_blocks(30);
+            auto last_irreversible_block_num = db->last_non_undoable_block_num();
+            BOOST_REQUIRE(last_irreversible_block_num >= transfer_block_num);
+
+            observer->stop();
+
+            BOOST_TEST_MESSAGE("Each irreversible block is delivered once, in order of blocks");
+
+            BOOST_REQUIRE_EQUAL(delivered.blocks.size(), last_irreversible_block_num - first_block_num + 1);
+            for (std::size_t i = 0; i < delivered.blocks.size(); ++i) {
+                auto &notification = delivered.blocks[i];
+                BOOST_CHECK_EQUAL(notification.block.block_num(), first_block_num + i);
+                BOOST_CHECK(notification.block.id() == db->get_block_id_for_num(first_block_num + i));
+                for (auto &snapshot : notification.snapshots) {
+                    BOOST_CHECK_EQUAL(snapshot.block, notification.block.block_num());
+                    BOOST_CHECK(snapshot.is_applied);
+                }
+            }
+
+            BOOST_TEST_MESSAGE("Operations of pending transactions are delivered with their block only");
+
+            BOOST_CHECK(delivered.has_transfer(transfer_block_num));
+            for (auto &notification : delivered.blocks) {
+                if (notification.block.block_num() != transfer_block_num) {
+                    BOOST_CHECK(!delivered.has_transfer(notification.block.block_num()));
+                }
+            }
+        }
+        FC_LOG_AND_RETHROW()
+    }
+
+    BOOST_AUTO_TEST_CASE(popped_block_is_replaced) {
+        try {
+            ACTORS((alice));
+            generate_block();
+
+            delivered_blocks delivered;
+            auto observer = delivered.observe(*db);
+
+            transfer(STEEMIT_INIT_MINER_NAME, "alice", 1000);
+            generate_block();
+            auto block_num = db->head_block_num();
+            auto popped_id = db->head_block_id();
+
+            BOOST_TEST_MESSAGE("The block with the transfer is replaced by the empty one on the fork switch");
+
+            db->pop_block();
+            auto replacement = db->generate_block(
+                db->get_slot_time(1), db->get_scheduled_witness(1), init_account_priv_key, default_skip);
+            BOOST_REQUIRE_EQUAL(replacement.block_num(), block_num);
+            BOOST_REQUIRE(replacement.transactions.empty());
+
+            // the popped transaction is pending again and goes to the next block
+            generate_block();
+            generate_blocks(30);
+            BOOST_REQUIRE(db->last_non_undoable_block_num() > block_num);
+
+            observer->stop();
+
+            auto &replaced = delivered.get(block_num);
+            BOOST_CHECK(replaced.block.id() == replacement.id());
+            BOOST_CHECK(replaced.block.id() != popped_id);
+            BOOST_CHECK(!delivered.has_transfer(block_num));
+            BOOST_CHECK(delivered.has_transfer(block_num + 1));
+
+            for (auto &notification : delivered.blocks) {
+                BOOST_CHECK(notification.block.id() != popped_id);
+            }
+        }
+        FC_LOG_AND_RETHROW()
+    }
+
+    BOOST_AUTO_TEST_CASE(failed_block_is_dropped) {
+        try {
+            ACTORS((alice));
+            generate_block();
+
+            delivered_blocks delivered;
+            auto observer = delivered.observe(*db);
+
+            transfer(STEEMIT_INIT_MINER_NAME, "alice", 1000);
+            generate_block();
+            auto block = *db->fetch_block_by_id(db->head_block_id());
+            auto block_num = block.block_num();
+            db->pop_block();
+
+            BOOST_TEST_MESSAGE("The block fails after the observer has taken the snapshot of the transfer");
+
+            // connected after the observer, so the observer sees the whole operation
+            bool fail = true;
+            auto connection = db->post_apply_operation.connect([&](const operation_notification &note) {
+                if (fail && note.op.which() == operation::tag<transfer_operation>::value) {
+                    FC_THROW_EXCEPTION(golos::chain::plugin_exception, "Test failure of the block");
+                }
+            });
+
+            STEEMIT_REQUIRE_THROW(db->push_block(block, default_skip), fc::exception);
+            BOOST_REQUIRE_EQUAL(db->head_block_num(), block_num - 1);
+
+            fail = false;
+            connection.disconnect();
+
+            BOOST_TEST_MESSAGE("The next block with the same number doesn't get snapshots of the failed one");
+
+            db->clear_pending();
+            auto replacement = db->generate_block(
+                db->get_slot_time(1), db->get_scheduled_witness(1), init_account_priv_key, default_skip);
+            BOOST_REQUIRE_EQUAL(replacement.block_num(), block_num);
+            BOOST_REQUIRE(replacement.transactions.empty());
+
+            generate_blocks(30);
+            BOOST_REQUIRE(db->last_non_undoable_block_num() > block_num);
+
+            observer->stop();
+
+            BOOST_CHECK(delivered.get(block_num).block.id() == replacement.id());
+            for (auto &notification : delivered.blocks) {
+                BOOST_CHECK(!delivered.has_transfer(notification.block.block_num()));
+            }
+        }
+        FC_LOG_AND_RETHROW()
+    }
+
+    BOOST_AUTO_TEST_CASE(slow_observer_holds_block_application) {
+        try {
+            delivered_blocks delivered;
+            delivered.delay = std::chrono::milliseconds(10);
+            auto observer = delivered.observe(*db, 1);
+            auto first_block_num = db->head_block_num() + 1;
+
+            generate_blocks(40);
+
+            // blocks aren't dropped, so the application waits when one block is queued and one is in work
+            auto last_irreversible_block_num = db->last_non_undoable_block_num();
+            BOOST_REQUIRE(last_irreversible_block_num >= first_block_num);
+            uint32_t enqueued = last_irreversible_block_num - first_block_num + 1;
+            BOOST_CHECK(delivered.count + 2 >= enqueued);
+
+            observer->stop();
+
+            BOOST_REQUIRE_EQUAL(delivered.blocks.size(), enqueued);
+            for (std::size_t i = 0; i < delivered.blocks.size(); ++i) {
+                BOOST_CHECK_EQUAL(delivered.blocks[i].block.block_num(), first_block_num + i);
+            }
+        }
+        FC_LOG_AND_RETHROW()
+    }
+
+BOOST_AUTO_TEST_SUITE_END()
+#endif
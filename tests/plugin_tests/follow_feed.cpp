@@ -0,0 +1,192 @@
+#ifdef STEEMIT_BUILD_TESTNET
+
+#include <boost/test/unit_test.hpp>
+
+#include <golos/chain/account_object.hpp>
+#include <golos/chain/comment_object.hpp>
+#include <golos/protocol/steem_operations.hpp>
+
+#include <golos/plugins/follow/plugin.hpp>
+#include <golos/plugins/follow/follow_operations.hpp>
+#include <golos/plugins/follow/follow_api_object.hpp>
+
+#include "database_fixture.hpp"
+
+#include <set>
+
+using namespace golos::chain;
+using namespace golos::protocol;
+using namespace golos::plugins::follow;
+
+namespace {
+
+    struct follow_feed_fixture : public database_fixture {
+        golos::plugins::follow::plugin *follow_plugin = nullptr;
+
+        follow_feed_fixture() {
+            initialize();
+
+            appbase::app().register_plugin<golos::plugins::json_rpc::plugin>();
+            follow_plugin = &appbase::app().register_plugin<golos::plugins::follow::plugin>();
+            // the default write mode stores both feeds and blogs, so both modes can be compared on the same data
+            boost::program_options::variables_map options;
+            follow_plugin->plugin_initialize(options);
+
+            open_database();
+
+            startup();
+            follow_plugin->plugin_startup();
+        }
+
+        void push_follow_operation(
+            const follow_plugin_operation &op, const account_name_type &account, const fc::ecc::private_key &key
+        ) {
+            custom_json_operation custom;
+            custom.id = follow_plugin->name();
+            custom.required_posting_auths.insert(account);
+            custom.json = fc::json::to_string(op);
+
+            signed_transaction tx;
+            push_tx_with_ops(tx, key, custom);
+            generate_block();
+        }
+
+        void follow(const account_name_type &follower, const account_name_type &following,
+            const fc::ecc::private_key &key
+        ) {
+            follow_operation op;
+            op.follower = follower;
+            op.following = following;
+            op.what.insert("blog");
+            push_follow_operation(op, follower, key);
+        }
+
+        void reblog(const account_name_type &account, const account_name_type &author, const std::string &permlink,
+            const fc::ecc::private_key &key
+        ) {
+            reblog_operation op;
+            op.account = account;
+            op.author = author;
+            op.permlink = permlink;
+            push_follow_operation(op, account, key);
+        }
+
+        void post(const account_name_type &author, const std::string &permlink, const fc::ecc::private_key &key) {
+            comment_operation op;
+            op.author = author;
+            op.permlink = permlink;
+            op.parent_permlink = "test";
+            op.title = permlink;
+            op.body = "body of " + permlink;
+
+            signed_transaction tx;
+            push_tx_with_ops(tx, key, op);
+            generate_block();
+        }
+
+        std::vector<feed_entry> get_feed_entries(const account_name_type &account, uint32_t start, uint32_t limit) {
+            golos::plugins::json_rpc::msg_pack msg;
+            msg.args = std::vector<fc::variant>({fc::variant(account), fc::variant(start), fc::variant(limit)});
+            return follow_plugin->get_feed_entries(msg);
+        }
+
+        std::string permlink_of(const account_feed_item &item) {
+            return to_string(db->get(item.comment).permlink);
+        }
+    };
+
+} // anonymous namespace
+
+BOOST_FIXTURE_TEST_SUITE(follow_feed, follow_feed_fixture)
+
+    // Plugin indexes are added once per process, so the modes and the paging are checked in one case
+    BOOST_AUTO_TEST_CASE(read_mode_feed_matches_write_mode) {
+        try {
+            ACTORS((alice)(bob)(carol)(dave)(eve));
+            generate_block();
+
+            follow("alice", "bob", alice_post_key);
+            follow("alice", "carol", alice_post_key);
+            follow("alice", "dave", alice_post_key);
+
+            post("bob", "bob-post", bob_post_key);
+            post("eve", "eve-post", eve_post_key);
+            post("carol", "carol-post", carol_post_key);
+            reblog("carol", "bob", "bob-post", carol_post_key);
+            reblog("dave", "eve", "eve-post", dave_post_key);
+            reblog("dave", "bob", "bob-post", dave_post_key);
+
+            // write mode: entries stay at the first occurrence of a post in the feed
+            auto written = get_feed_entries("alice", 0, 100);
+            BOOST_REQUIRE_EQUAL(written.size(), 3);
+            BOOST_CHECK_EQUAL(written[0].permlink, "eve-post");
+            BOOST_CHECK_EQUAL(written[1].permlink, "carol-post");
+            BOOST_CHECK_EQUAL(written[2].permlink, "bob-post");
+
+            // read mode: blogs are merged newest first, a post is shown at its latest occurrence
+            auto merged = collect_account_feed(*db, "alice", 0, 100);
+            BOOST_REQUIRE_EQUAL(merged.size(), 3);
+            BOOST_CHECK_EQUAL(permlink_of(merged[0]), "bob-post");
+            BOOST_CHECK_EQUAL(permlink_of(merged[1]), "eve-post");
+            BOOST_CHECK_EQUAL(permlink_of(merged[2]), "carol-post");
+            BOOST_CHECK(merged[0].entry_id > merged[1].entry_id);
+            BOOST_CHECK(merged[1].entry_id > merged[2].entry_id);
+
+            // both modes show the same posts
+            std::set<std::string> written_posts, merged_posts;
+            for (auto &entry : written) {
+                written_posts.insert(entry.permlink);
+            }
+            for (auto &item : merged) {
+                merged_posts.insert(permlink_of(item));
+            }
+            BOOST_CHECK(written_posts == merged_posts);
+
+            // a post first received by a reblog has the same rebloggers in both modes
+            BOOST_CHECK(written[0].reblog_by == std::vector<std::string>({"dave"}));
+            BOOST_CHECK(merged[1].reblogged_by == std::vector<account_name_type>({account_name_type("dave")}));
+            BOOST_CHECK(written[0].reblog_on == merged[1].reblogged_on);
+
+            // read mode lists the followed rebloggers of a post of a followed author too, the author isn't listed
+            BOOST_CHECK(merged[0].reblogged_by ==
+                std::vector<account_name_type>({account_name_type("carol"), account_name_type("dave")}));
+            BOOST_CHECK(merged[0].reblogged_on < merged[1].reblogged_on);
+
+            BOOST_CHECK(merged[2].reblogged_by.empty());
+
+            // an account following nobody has an empty feed
+            auto carol_feed = collect_account_feed(*db, "carol", 0, 100);
+            BOOST_CHECK(carol_feed.empty());
+
+            // pages of one entry continue from the entry id before the last one,
+            // earlier occurrences of an already shown post are skipped on the next pages
+            std::vector<account_feed_item> paged;
+            uint32_t start = 0;
+            while (true) {
+                auto page = collect_account_feed(*db, "alice", start, 1);
+                if (page.empty()) {
+                    break;
+                }
+                BOOST_REQUIRE_EQUAL(page.size(), 1);
+                paged.push_back(page[0]);
+                BOOST_REQUIRE(page[0].entry_id > 0);
+                start = page[0].entry_id - 1;
+            }
+
+            BOOST_REQUIRE_EQUAL(paged.size(), merged.size());
+            for (std::size_t i = 0; i < merged.size(); ++i) {
+                BOOST_CHECK(paged[i].comment == merged[i].comment);
+                BOOST_CHECK_EQUAL(paged[i].entry_id, merged[i].entry_id);
+                BOOST_CHECK(paged[i].reblogged_by == merged[i].reblogged_by);
+            }
+
+            // the page starts at the given entry
+            auto from_second = collect_account_feed(*db, "alice", merged[1].entry_id, 100);
+            BOOST_REQUIRE_EQUAL(from_second.size(), 2);
+            BOOST_CHECK(from_second[0].comment == merged[1].comment);
+            BOOST_CHECK(from_second[1].comment == merged[2].comment);
+        } FC_LOG_AND_RETHROW()
+    }
+
+BOOST_AUTO_TEST_SUITE_END()
+#endif
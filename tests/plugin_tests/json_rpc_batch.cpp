@@ -0,0 +1,231 @@
+#include <boost/test/unit_test.hpp>
+
+#include <golos/plugins/json_rpc/plugin.hpp>
+
+#include <fc/io/json.hpp>
+
+#include <boost/program_options.hpp>
+
+#include <memory>
+#include <string>
+#include <vector>
+
+using golos::plugins::json_rpc::msg_pack;
+using golos::plugins::json_rpc::msg_pack_transfer;
+
+namespace bpo = boost::program_options;
+
+namespace {
+
+    struct json_rpc_fixture {
+        golos::plugins::json_rpc::plugin rpc;
+        std::vector<msg_pack_transfer::ptr> delayed;
+
+        json_rpc_fixture() {
+            initialize({});
+        }
+
+        void initialize(std::vector<std::string> args) {
+            bpo::options_description cli, cfg;
+            rpc.set_program_options(cli, cfg);
+
+            std::vector<const char *> argv = {"plugin_test"};
+            for (const auto &arg: args) {
+                argv.push_back(arg.c_str());
+            }
+
+            bpo::variables_map options;
+            bpo::store(bpo::parse_command_line(int(argv.size()), argv.data(), cfg), options);
+            bpo::notify(options);
+            rpc.plugin_initialize(options);
+
+            rpc.add_api_method("test_api", "echo", [](msg_pack &msg) {
+                FC_ASSERT(msg.args.valid() && msg.args->size() == 1);
+                return msg.args->front();
+            });
+            rpc.add_api_method("test_api", "fail", [](msg_pack &) -> fc::variant {
+                FC_THROW_EXCEPTION(fc::assert_exception, "failed by request");
+            });
+            // the response is passed later, as delegated calls do
+            rpc.add_api_method("test_api", "delayed", [this](msg_pack &msg) {
+                msg_pack_transfer transfer(msg);
+                delayed.push_back(transfer.msg());
+                transfer.complete();
+                return fc::variant();
+            });
+        }
+
+        std::string call(const std::string &body) {
+            std::string result;
+            rpc.call(body, [&](const std::string &response) {
+                result = response;
+            });
+            return result;
+        }
+
+        static std::string request(int id, const std::string &method, const std::string &arg = "") {
+            return "{\"jsonrpc\":\"2.0\",\"id\":" + std::to_string(id) +
+                   ",\"method\":\"call\",\"params\":[\"test_api\",\"" + method + "\",[" + arg + "]]}";
+        }
+
+        static std::string batch(const std::vector<std::string> &requests) {
+            std::string body = "[";
+            for (const auto &r: requests) {
+                if (body.size() > 1) {
+                    body.push_back(',');
+                }
+                body.append(r);
+            }
+            body.push_back(']');
+            return body;
+        }
+    };
+
+} // anonymous namespace
+
+BOOST_FIXTURE_TEST_SUITE(json_rpc_batch, json_rpc_fixture)
+
+    BOOST_AUTO_TEST_CASE(responses_keep_order_and_errors) {
+        auto response = call(batch({
+            request(1, "echo", "\"first\""),
+            request(2, "fail"),
+            "{\"jsonrpc\":\"2.0\",\"id\":3,\"method\":\"call\",\"params\":[\"test_api\",\"unknown\",[]]}",
+            "{\"jsonrpc\":\"1.0\",\"id\":4,\"method\":\"call\",\"params\":[]}",
+            request(5, "echo", "5")
+        }));
+
+        auto responses = fc::json::from_string(response).get_array();
+        BOOST_REQUIRE_EQUAL(responses.size(), 5);
+
+        for (std::size_t i = 0; i < responses.size(); ++i) {
+            BOOST_CHECK_EQUAL(responses[i]["id"].as_int64(), int64_t(i + 1));
+        }
+
+        BOOST_CHECK_EQUAL(responses[0]["result"].as_string(), "first");
+        BOOST_CHECK_EQUAL(responses[1]["error"]["code"].as_int64(), JSON_RPC_ERROR_DURING_CALL);
+        BOOST_CHECK_EQUAL(responses[2]["error"]["code"].as_int64(), JSON_RPC_PARSE_PARAMS_ERROR);
+        BOOST_CHECK_EQUAL(responses[3]["error"]["code"].as_int64(), JSON_RPC_INVALID_REQUEST);
+        BOOST_CHECK_EQUAL(responses[4]["result"].as_int64(), 5);
+    }
+
+    BOOST_AUTO_TEST_CASE(delayed_responses_keep_order) {
+        initialize({"--json-rpc-batch-concurrency=2"});
+
+        std::string response;
+        rpc.call(batch({
+            request(1, "delayed"),
+            request(2, "delayed"),
+            request(3, "echo", "3"),
+            request(4, "delayed")
+        }), [&](const std::string &data) {
+            response = data;
+        });
+
+        // only two elements are executed in parallel
+        BOOST_REQUIRE_EQUAL(delayed.size(), 2);
+        BOOST_CHECK(response.empty());
+
+        // the second element completes first, so the third and the fourth start
+        delayed[1]->unsafe_result(fc::variant("second"));
+        BOOST_REQUIRE_EQUAL(delayed.size(), 3);
+        BOOST_CHECK(response.empty());
+
+        delayed[2]->unsafe_result(fc::variant("fourth"));
+        BOOST_CHECK(response.empty());
+        delayed[0]->unsafe_result(fc::variant("first"));
+        BOOST_REQUIRE(!response.empty());
+
+        auto responses = fc::json::from_string(response).get_array();
+        BOOST_REQUIRE_EQUAL(responses.size(), 4);
+        BOOST_CHECK_EQUAL(responses[0]["result"].as_string(), "first");
+        BOOST_CHECK_EQUAL(responses[1]["result"].as_string(), "second");
+        BOOST_CHECK_EQUAL(responses[2]["result"].as_int64(), 3);
+        BOOST_CHECK_EQUAL(responses[3]["result"].as_string(), "fourth");
+    }
+
+    BOOST_AUTO_TEST_CASE(large_batch_with_inline_executor) {
+        const int count = 100000;
+        initialize({"--json-rpc-batch-size-limit=" + std::to_string(count), "--json-rpc-batch-concurrency=1"});
+
+        std::vector<std::string> requests;
+        requests.reserve(count);
+        for (int i = 0; i < count; ++i) {
+            requests.push_back(request(i, "echo", std::to_string(i)));
+        }
+
+        // each element completes synchronously, it shouldn't grow the stack
+        auto responses = fc::json::from_string(call(batch(requests))).get_array();
+        BOOST_REQUIRE_EQUAL(responses.size(), std::size_t(count));
+        BOOST_CHECK_EQUAL(responses.back()["result"].as_int64(), count - 1);
+    }
+
+    BOOST_AUTO_TEST_CASE(rejected_elements) {
+        initialize({"--json-rpc-batch-concurrency=1"});
+
+        // the executor accepts only the first task
+        int accepted = 0;
+        rpc.set_executor([&](std::function<void()> task) {
+            if (accepted++ > 0) {
+                return false;
+            }
+            task();
+            return true;
+        });
+
+        auto responses = fc::json::from_string(call(batch({
+            request(1, "echo", "1"),
+            request(2, "echo", "2"),
+            request(3, "echo", "3")
+        }))).get_array();
+
+        BOOST_REQUIRE_EQUAL(responses.size(), 3);
+        // the accepted worker continues with the next elements by itself
+        BOOST_CHECK_EQUAL(responses[0]["result"].as_int64(), 1);
+        BOOST_CHECK_EQUAL(responses[1]["result"].as_int64(), 2);
+        BOOST_CHECK_EQUAL(responses[2]["result"].as_int64(), 3);
+
+        // elements started after an asynchronous completion are rejected and keep their ids
+        accepted = 0;
+        std::string response;
+        rpc.call(batch({request(1, "delayed"), request(2, "echo", "2"), request(3, "echo", "3")}),
+            [&](const std::string &data) {
+                response = data;
+            });
+        BOOST_REQUIRE_EQUAL(delayed.size(), 1);
+        delayed[0]->unsafe_result(fc::variant("first"));
+
+        responses = fc::json::from_string(response).get_array();
+        BOOST_REQUIRE_EQUAL(responses.size(), 3);
+        BOOST_CHECK_EQUAL(responses[0]["result"].as_string(), "first");
+        BOOST_CHECK_EQUAL(responses[1]["error"]["code"].as_int64(), JSON_RPC_SERVER_ERROR);
+        BOOST_CHECK_EQUAL(responses[1]["id"].as_int64(), 2);
+        BOOST_CHECK_EQUAL(responses[2]["error"]["code"].as_int64(), JSON_RPC_SERVER_ERROR);
+        BOOST_CHECK_EQUAL(responses[2]["id"].as_int64(), 3);
+    }
+
+    BOOST_AUTO_TEST_CASE(members_should_be_strings) {
+        auto response = fc::json::from_string(call(
+            "{\"jsonrpc\":2.0,\"id\":1,\"method\":\"call\",\"params\":[\"test_api\",\"echo\",[1]]}"));
+        BOOST_CHECK_EQUAL(response["error"]["code"].as_int64(), JSON_RPC_INVALID_REQUEST);
+        BOOST_CHECK_EQUAL(response["id"].as_int64(), 1);
+
+        response = fc::json::from_string(call("{\"jsonrpc\":\"2.0\",\"id\":2,\"method\":[\"call\"],\"params\":[]}"));
+        BOOST_CHECK_EQUAL(response["error"]["code"].as_int64(), JSON_RPC_INVALID_REQUEST);
+
+        // arguments are parsed only for a found method
+        response = fc::json::from_string(call(
+            "{\"jsonrpc\":\"2.0\",\"id\":3,\"method\":\"call\",\"params\":[\"test_api\",\"echo\",[{\"a\":[1,2]}]]}"));
+        BOOST_CHECK_EQUAL(response["result"]["a"].get_array().size(), 2);
+    }
+
+    BOOST_AUTO_TEST_CASE(batch_size_limit) {
+        initialize({"--json-rpc-batch-size-limit=2"});
+
+        auto response = fc::json::from_string(call(batch({
+            request(1, "echo", "1"), request(2, "echo", "2"), request(3, "echo", "3")
+        })));
+        BOOST_REQUIRE(response.is_object());
+        BOOST_CHECK_EQUAL(response["error"]["code"].as_int64(), JSON_RPC_SERVER_ERROR);
+    }
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,164 @@
+#include <boost/test/unit_test.hpp>
+
+#include <golos/plugins/json_rpc/json_writer.hpp>
+#include <golos/api/discussion.hpp>
+#include <golos/api/account_api_object.hpp>
+
+#include <fc/io/json.hpp>
+
+#include <limits>
+
+namespace golos { namespace api {
+    JSON_RPC_STREAMABLE(discussion)
+    JSON_RPC_STREAMABLE(vote_state)
+    JSON_RPC_STREAMABLE(account_api_object)
+} } // golos::api
+
+namespace json_writer_tests {
+    struct leaf_values {
+        std::string plain;
+        std::string escaped;
+        std::string control;
+        std::string unicode;
+        bool flag = false;
+        int8_t i8 = 0;
+        uint8_t u8 = 0;
+        int16_t i16 = 0;
+        uint16_t u16 = 0;
+        int32_t i32 = 0;
+        uint32_t u32 = 0;
+        int64_t i64 = 0;
+        uint64_t u64 = 0;
+        golos::protocol::share_type share;
+        fc::time_point_sec time;
+        golos::protocol::account_name_type name;
+        golos::protocol::asset amount;
+        fc::optional<int64_t> absent;
+        fc::optional<std::string> present;
+        std::vector<std::string> strings;
+        double ratio = 0;
+    };
+
+    JSON_RPC_STREAMABLE(leaf_values)
+} // json_writer_tests
+
+FC_REFLECT((json_writer_tests::leaf_values),
+    (plain)(escaped)(control)(unicode)(flag)(i8)(u8)(i16)(u16)(i32)(u32)(i64)(u64)
+    (share)(time)(name)(amount)(absent)(present)(strings)(ratio))
+
+using golos::plugins::json_rpc::json_writer;
+using json_writer_tests::leaf_values;
+
+namespace {
+
+    template<typename T>
+    std::string streamed(const T &value) {
+        std::string result;
+        json_writer(result).write(value);
+        return result;
+    }
+
+    template<typename T>
+    void check_same_json(const T &value) {
+        BOOST_CHECK_EQUAL(streamed(value), fc::json::to_string(fc::variant(value)));
+    }
+
+    leaf_values make_leaf_values(int64_t i64, uint64_t u64) {
+        leaf_values v;
+        v.plain = "plain text";
+        v.escaped = "quote \" backslash \\ slash /";
+        v.control = std::string("tab\tnew line\ncarriage\rnull") + '\0' + "bell\x07" + "del\x7f";
+        v.unicode = "\xd0\x93\xd0\xbe\xd0\xbb\xd0\xbe\xd1\x81 \xe2\x82\xbd";
+        v.flag = true;
+        v.i8 = -8;
+        v.u8 = 200;
+        v.i16 = -16000;
+        v.u16 = 65000;
+        v.i32 = std::numeric_limits<int32_t>::min();
+        v.u32 = std::numeric_limits<uint32_t>::max();
+        v.i64 = i64;
+        v.u64 = u64;
+        v.share = i64;
+        v.time = fc::time_point_sec(1500000000);
+        v.name = "golos.io";
+        v.amount = golos::protocol::asset(12345, STEEM_SYMBOL);
+        v.present = std::string("here");
+        v.strings = {"a", "", "b\"c"};
+        v.ratio = 0.25;
+        return v;
+    }
+
+    golos::api::discussion make_discussion(uint32_t i) {
+        golos::api::discussion d;
+        std::string author = "author" + std::to_string(i);
+        d.id = golos::chain::comment_object::id_type(i);
+        d.author = author;
+        d.permlink = "permlink-" + std::to_string(i);
+        d.parent_permlink = "golos";
+        d.category = "golos";
+        d.title = "Title \"" + std::to_string(i) + "\"";
+        d.body = std::string(1000, 'x') + "\nend";
+        d.json_metadata = "{\"tags\":[\"golos\"]}";
+        d.created = fc::time_point_sec(1500000000 + i);
+        d.children_rshares2 = fc::uint128_t(i) << 70;
+        d.net_rshares = int64_t(i) << 40;
+        d.total_vote_weight = uint64_t(i) << 33;
+        d.max_accepted_payout = golos::protocol::asset(1000000000, SBD_SYMBOL);
+        d.url = "/golos/@" + author + "/" + d.permlink;
+        d.author_reputation = golos::protocol::share_type(-100);
+        d.reblogged_by = {"alice", "bob"};
+        d.first_reblogged_by = golos::protocol::account_name_type("alice");
+        for (uint32_t v = 0; v < 10; ++v) {
+            golos::api::vote_state vote;
+            vote.voter = "voter" + std::to_string(v);
+            vote.weight = uint64_t(v) << 35;
+            vote.rshares = -int64_t(v) << 34;
+            vote.percent = -10000;
+            vote.time = d.created;
+            d.active_votes.push_back(vote);
+        }
+        d.replies = {"reply/1", "reply/2"};
+        return d;
+    }
+
+} // anonymous namespace
+
+BOOST_AUTO_TEST_SUITE(json_writer_tests)
+
+    BOOST_AUTO_TEST_CASE(leaf_values_are_the_same) {
+        check_same_json(leaf_values());
+        check_same_json(make_leaf_values(42, 42));
+        // the bounds of quoting of large integers
+        check_same_json(make_leaf_values(0xffffffffll, 0xffffffffull));
+        check_same_json(make_leaf_values(0x100000000ll, 0x100000000ull));
+        check_same_json(make_leaf_values(-0x100000000ll, 0));
+        check_same_json(make_leaf_values(
+            std::numeric_limits<int64_t>::max(), std::numeric_limits<uint64_t>::max()));
+        check_same_json(make_leaf_values(std::numeric_limits<int64_t>::min(), 0));
+    }
+
+    BOOST_AUTO_TEST_CASE(optionals_and_vectors_are_the_same) {
+        check_same_json(fc::optional<leaf_values>());
+        check_same_json(fc::optional<leaf_values>(make_leaf_values(1, 2)));
+        check_same_json(std::vector<leaf_values>());
+        check_same_json(std::vector<leaf_values>({make_leaf_values(1, 2), leaf_values()}));
+    }
+
+    BOOST_AUTO_TEST_CASE(api_objects_are_the_same) {
+        check_same_json(golos::api::discussion());
+        check_same_json(make_discussion(1));
+        check_same_json(std::vector<golos::api::discussion>({make_discussion(2), make_discussion(3)}));
+
+        golos::api::account_api_object account;
+        account.name = "alice";
+        account.json_metadata = "{\"profile\":{\"name\":\"Alice \\\"A\\\"\"}}";
+        account.balance = golos::protocol::asset(1000, STEEM_SYMBOL);
+        account.sbd_seconds = fc::uint128_t(1) << 100;
+        account.proxied_vsf_votes = {
+            golos::protocol::share_type(1), golos::protocol::share_type(int64_t(1) << 40)};
+        account.witness_votes = {"witness1", "witness2"};
+        account.reputation = golos::protocol::share_type(int64_t(1) << 50);
+        check_same_json(account);
+    }
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -5,11 +5,15 @@
 #include <golos/chain/account_object.hpp>
 #include <golos/chain/comment_object.hpp>
 #include <golos/protocol/steem_operations.hpp>
+#include <golos/chain/database_exceptions.hpp>
 
 #include <golos/plugins/market_history/market_history_plugin.hpp>
 
 #include "database_fixture.hpp"
 
+#include <fc/filesystem.hpp>
+#include <fc/io/json.hpp>
+
 using namespace golos::chain;
 using namespace golos::protocol;
 
@@ -17,7 +21,7 @@ BOOST_FIXTURE_TEST_SUITE(market_history, database_fixture)
 
     BOOST_AUTO_TEST_CASE(mh_test) {
         using namespace golos::plugins::market_history;
-        using by_id = golos::plugins::market_history::by_id;
+        using golos::plugins::json_rpc::msg_pack;
 
         try {
             initialize();
@@ -43,11 +47,27 @@ BOOST_FIXTURE_TEST_SUITE(market_history, database_fixture)
 
             signed_transaction tx;
 
-            const auto &bucket_idx = db->get_index<bucket_index>().indices().get<by_bucket>();
-            const auto &order_hist_idx = db->get_index<order_history_index>().indices().get<by_id>();
-
-            BOOST_REQUIRE(bucket_idx.begin() == bucket_idx.end());
-            BOOST_REQUIRE(order_hist_idx.begin() == order_hist_idx.end());
+            auto get_buckets = [&]() {
+                std::vector<bucket_object> result;
+                for (auto seconds : mh_plugin.get_tracked_buckets()) {
+                    msg_pack msg;
+                    msg.args = std::vector<fc::variant>({
+                        fc::variant(seconds), fc::variant(fc::time_point_sec()), fc::variant(fc::time_point_sec::maximum())});
+                    auto buckets = mh_plugin.get_market_history(msg);
+                    result.insert(result.end(), buckets.begin(), buckets.end());
+                }
+                return result;
+            };
+
+            auto get_trades = [&]() {
+                msg_pack msg;
+                msg.args = std::vector<fc::variant>({
+                    fc::variant(fc::time_point_sec()), fc::variant(fc::time_point_sec::maximum()), fc::variant(1000)});
+                return mh_plugin.get_trade_history(msg);
+            };
+
+            BOOST_REQUIRE(get_buckets().empty());
+            BOOST_REQUIRE(get_trades().empty());
             validate_database();
 
             auto fill_order_a_time = db->head_block_time();
@@ -118,7 +138,8 @@ BOOST_FIXTURE_TEST_SUITE(market_history, database_fixture)
             db->push_transaction(tx, 0);
             validate_database();
 
-            auto bucket = bucket_idx.begin();
+            auto buckets = get_buckets();
+            auto bucket = buckets.begin();
 
             BOOST_REQUIRE(bucket->seconds == 15);
             BOOST_REQUIRE(bucket->open == time_a);
@@ -277,47 +298,68 @@ BOOST_FIXTURE_TEST_SUITE(market_history, database_fixture)
             BOOST_REQUIRE(bucket->sbd_volume == ASSET("1.500 GBG").amount);
             bucket++;
 
-            BOOST_REQUIRE(bucket == bucket_idx.end());
+            BOOST_REQUIRE(bucket == buckets.end());
 
-            auto order = order_hist_idx.begin();
+            auto trades = get_trades();
+            auto order = trades.begin();
 
-            BOOST_REQUIRE(order->time == fill_order_a_time);
-            BOOST_REQUIRE(order->op.current_owner == "bob");
-            BOOST_REQUIRE(order->op.current_orderid == 0);
-            BOOST_REQUIRE(order->op.current_pays == ASSET("1.500 GOLOS"));
-            BOOST_REQUIRE(order->op.open_owner == "alice");
-            BOOST_REQUIRE(order->op.open_orderid == 0);
-            BOOST_REQUIRE(order->op.open_pays == ASSET("0.750 GBG"));
+            BOOST_REQUIRE(order->date == fill_order_a_time);
+            BOOST_REQUIRE(order->current_pays == ASSET("1.500 GOLOS"));
+            BOOST_REQUIRE(order->open_pays == ASSET("0.750 GBG"));
             order++;
 
-            BOOST_REQUIRE(order->time == fill_order_b_time);
-            BOOST_REQUIRE(order->op.current_owner == "sam");
-            BOOST_REQUIRE(order->op.current_orderid == 0);
-            BOOST_REQUIRE(order->op.current_pays == ASSET("0.500 GOLOS"));
-            BOOST_REQUIRE(order->op.open_owner == "alice");
-            BOOST_REQUIRE(order->op.open_orderid == 0);
-            BOOST_REQUIRE(order->op.open_pays == ASSET("0.250 GBG"));
+            BOOST_REQUIRE(order->date == fill_order_b_time);
+            BOOST_REQUIRE(order->current_pays == ASSET("0.500 GOLOS"));
+            BOOST_REQUIRE(order->open_pays == ASSET("0.250 GBG"));
             order++;
 
-            BOOST_REQUIRE(order->time == fill_order_c_time);
-            BOOST_REQUIRE(order->op.current_owner == "alice");
-            BOOST_REQUIRE(order->op.current_orderid == 0);
-            BOOST_REQUIRE(order->op.current_pays == ASSET("0.250 GBG"));
-            BOOST_REQUIRE(order->op.open_owner == "sam");
-            BOOST_REQUIRE(order->op.open_orderid == 0);
-            BOOST_REQUIRE(order->op.open_pays == ASSET("0.500 GOLOS"));
+            BOOST_REQUIRE(order->date == fill_order_c_time);
+            BOOST_REQUIRE(order->current_pays == ASSET("0.250 GBG"));
+            BOOST_REQUIRE(order->open_pays == ASSET("0.500 GOLOS"));
             order++;
 
-            BOOST_REQUIRE(order->time == fill_order_c_time);
-            BOOST_REQUIRE(order->op.current_owner == "bob");
-            BOOST_REQUIRE(order->op.current_orderid == 0);
-            BOOST_REQUIRE(order->op.current_pays == ASSET("0.450 GOLOS"));
-            BOOST_REQUIRE(order->op.open_owner == "alice");
-            BOOST_REQUIRE(order->op.open_orderid == 0);
-            BOOST_REQUIRE(order->op.open_pays == ASSET("0.250 GBG"));
+            BOOST_REQUIRE(order->date == fill_order_c_time);
+            BOOST_REQUIRE(order->current_pays == ASSET("0.450 GOLOS"));
+            BOOST_REQUIRE(order->open_pays == ASSET("0.250 GBG"));
             order++;
 
-            BOOST_REQUIRE(order == order_hist_idx.end());
+            BOOST_REQUIRE(order == trades.end());
+
+            // History of irreversible blocks is saved on shutdown and loaded after reopening of the database
+            generate_block();
+            auto trades_block_num = db->head_block_num();
+            for (int i = 0; i < 100 && db->last_non_undoable_block_num() < trades_block_num; ++i) {
+                generate_block();
+            }
+            BOOST_REQUIRE(db->last_non_undoable_block_num() >= trades_block_num);
+            generate_block();
+
+            auto saved_buckets = fc::json::to_string(get_buckets());
+            auto saved_trades = fc::json::to_string(get_trades());
+
+            fc::create_directories(appbase::app().data_dir());
+            mh_plugin.plugin_shutdown();
+            BOOST_REQUIRE(fc::exists(appbase::app().data_dir() / "market_history.bin"));
+            BOOST_CHECK(get_buckets().empty());
+
+            // the database is reverted to the last irreversible block, which the saved history is keyed on
+            db->close();
+            db->open(data_dir->path(), data_dir->path(), INITIAL_TEST_SUPPLY, 1024 * 1024 * 8,
+                chainbase::database::read_write);
+            mh_plugin.plugin_startup();
+
+            BOOST_CHECK_EQUAL(fc::json::to_string(get_buckets()), saved_buckets);
+            BOOST_CHECK_EQUAL(fc::json::to_string(get_trades()), saved_trades);
+
+            generate_block();
+            BOOST_CHECK_EQUAL(fc::json::to_string(get_trades()), saved_trades);
+
+            // the saved history doesn't match a database, which continues from another block
+            mh_plugin.plugin_shutdown();
+            BOOST_REQUIRE(db->head_block_num() > db->last_non_undoable_block_num());
+            BOOST_CHECK_THROW(mh_plugin.plugin_startup(), golos::chain::plugin_exception);
+
+            fc::remove(appbase::app().data_dir() / "market_history.bin");
         }
         FC_LOG_AND_RETHROW()
     }
@@ -0,0 +1,116 @@
+#ifdef MONGODB_PLUGIN_BUILT
+
+#include <boost/test/unit_test.hpp>
+
+#include <golos/plugins/mongo_db/mongo_db_batch.hpp>
+
+#include <bsoncxx/builder/stream/document.hpp>
+
+using namespace golos::plugins::mongo_db;
+using bsoncxx::builder::stream::open_document;
+using bsoncxx::builder::stream::close_document;
+
+namespace {
+
+    // Captures the writes instead of sending them to MongoDB
+    struct mock_sink final: public write_sink {
+        struct written {
+            std::string collection_name;
+            std::string keyval;
+            bool is_removal;
+            int value;
+        };
+
+        std::vector<written> writes;
+
+        void write(const std::string& collection_name, const std::vector<const write_request*>& requests) override {
+            for (auto request : requests) {
+                auto value = request->doc.view()["$set"]["value"];
+                writes.push_back({collection_name, request->keyval, request->is_removal,
+                    value ? value.get_int32().value : -1});
+            }
+        }
+    };
+
+    write_request upsert(const std::string& collection_name, const std::string& keyval, int value) {
+        named_document doc;
+        doc.collection_name = collection_name;
+        doc.key = "_id";
+        doc.keyval = keyval;
+        doc.is_removal = false;
+        doc.doc << "$set" << open_document << "value" << value << close_document;
+        return write_request(doc);
+    }
+
+    write_request removal(const std::string& collection_name, const std::string& keyval) {
+        named_document doc;
+        doc.collection_name = collection_name;
+        doc.key = "_id";
+        doc.keyval = keyval;
+        doc.is_removal = true;
+        return write_request(doc);
+    }
+
+    write_request insert(const std::string& collection_name, int value) {
+        bsoncxx::builder::stream::document doc;
+        doc << "$set" << open_document << "value" << value << close_document;
+        return write_request(collection_name, doc.extract());
+    }
+
+    write_batch make_batch(std::vector<write_request> requests) {
+        write_batch batch;
+        batch.block_count = 1;
+        for (auto& request : requests) {
+            batch.requests.push_back(std::move(request));
+        }
+        return batch;
+    }
+
+} // anonymous namespace
+
+BOOST_AUTO_TEST_SUITE(mongo_db_batch)
+
+    BOOST_AUTO_TEST_CASE(latest_request_of_object_is_written) {
+        std::vector<write_batch> batches;
+        batches.push_back(make_batch({upsert("votes", "a", 1), upsert("votes", "b", 1), insert("blocks", 1)}));
+        batches.push_back(make_batch({removal("votes", "a"), upsert("votes", "c", 1), insert("blocks", 2)}));
+        batches.push_back(make_batch({upsert("votes", "b", 2), upsert("accounts", "a", 1)}));
+
+        mock_sink sink;
+        write_batches(batches, sink);
+
+        BOOST_REQUIRE_EQUAL(sink.writes.size(), 6);
+
+        // collections are written in order of their names
+        BOOST_CHECK_EQUAL(sink.writes[0].collection_name, "accounts");
+        BOOST_CHECK_EQUAL(sink.writes[0].keyval, "a");
+
+        // inserts aren't merged
+        BOOST_CHECK_EQUAL(sink.writes[1].collection_name, "blocks");
+        BOOST_CHECK_EQUAL(sink.writes[1].value, 1);
+        BOOST_CHECK_EQUAL(sink.writes[2].value, 2);
+
+        // the removal replaces the upsert of the same object, each one takes its latest position
+        BOOST_CHECK_EQUAL(sink.writes[3].keyval, "a");
+        BOOST_CHECK(sink.writes[3].is_removal);
+        BOOST_CHECK_EQUAL(sink.writes[4].keyval, "c");
+        BOOST_CHECK_EQUAL(sink.writes[5].keyval, "b");
+        BOOST_CHECK_EQUAL(sink.writes[5].value, 2);
+    }
+
+    BOOST_AUTO_TEST_CASE(upsert_after_removal) {
+        std::vector<write_batch> batches;
+        batches.push_back(make_batch({removal("votes", "a")}));
+        batches.push_back(make_batch({upsert("votes", "a", 3)}));
+
+        mock_sink sink;
+        write_batches(batches, sink);
+
+        BOOST_REQUIRE_EQUAL(sink.writes.size(), 1);
+        BOOST_CHECK(!sink.writes[0].is_removal);
+        BOOST_CHECK_EQUAL(sink.writes[0].value, 3);
+    }
+
+BOOST_AUTO_TEST_SUITE_END()
+
+#endif
@@ -0,0 +1,188 @@
+#include <boost/test/unit_test.hpp>
+
+#include <golos/plugins/json_rpc/request_parser.hpp>
+
+#include <fc/exception/exception.hpp>
+
+using golos::plugins::json_rpc::json_span;
+using golos::plugins::json_rpc::parsed_request;
+using golos::plugins::json_rpc::request_parser;
+
+namespace {
+
+    json_span make_span(const std::string &value) {
+        json_span span;
+        span.begin = value.data();
+        span.end = value.data() + value.size();
+        return span;
+    }
+
+    parsed_request parse(const std::string &request) {
+        return request_parser::parse(make_span(request));
+    }
+
+    std::vector<std::string> split_array(const std::string &value) {
+        std::vector<std::string> result;
+        for (const auto &span: request_parser::split_array(make_span(value))) {
+            result.push_back(span.str());
+        }
+        return result;
+    }
+
+} // anonymous namespace
+
+BOOST_AUTO_TEST_SUITE(request_parser_tests)
+
+    BOOST_AUTO_TEST_CASE(members) {
+        const std::string body =
+            " { \"id\" : 7 , \"jsonrpc\":\"2.0\", \"unknown\": {\"x\": [1, 2]},"
+            " \"method\":\"call\", \"params\": [\"database_api\", \"get_block\", [1]] } ";
+        auto request = parse(body);
+
+        BOOST_REQUIRE(request.jsonrpc.valid());
+        BOOST_CHECK_EQUAL(*request.jsonrpc, "2.0");
+        BOOST_REQUIRE(request.method.valid());
+        BOOST_CHECK_EQUAL(*request.method, "call");
+        BOOST_REQUIRE(request.id.valid());
+        BOOST_CHECK_EQUAL(request.id->str(), "7");
+        BOOST_REQUIRE(request.params.valid());
+        BOOST_CHECK_EQUAL(request.params->str(), "[\"database_api\", \"get_block\", [1]]");
+
+        auto empty = parse("{}");
+        BOOST_CHECK(!empty.jsonrpc.valid());
+        BOOST_CHECK(!empty.method.valid());
+        BOOST_CHECK(!empty.id.valid());
+        BOOST_CHECK(!empty.params.valid());
+    }
+
+    BOOST_AUTO_TEST_CASE(members_of_wrong_types) {
+        auto request = parse("{\"jsonrpc\":2.0,\"method\":[\"call\"],\"id\":1}");
+        BOOST_CHECK(!request.jsonrpc.valid());
+        BOOST_CHECK(!request.method.valid());
+
+        request = parse("{\"jsonrpc\":null,\"method\":{\"name\":\"call\"}}");
+        BOOST_CHECK(!request.jsonrpc.valid());
+        BOOST_CHECK(!request.method.valid());
+
+        request = parse("{\"jsonrpc\":\"2.0\",\"method\":true}");
+        BOOST_REQUIRE(request.jsonrpc.valid());
+        BOOST_CHECK(!request.method.valid());
+    }
+
+    BOOST_AUTO_TEST_CASE(escapes) {
+        // escaped quotes and brackets inside strings don't end values
+        auto request = parse(
+            "{\"jsonrpc\":\"2.0\",\"method\":\"a\\\"b\\\\c\\/d\","
+            "\"id\":\"x\\\"}]\",\"params\":[\"]\\\"[\", {\"}\":\"\\\\\"}]}");
+
+        BOOST_REQUIRE(request.jsonrpc.valid());
+        BOOST_CHECK_EQUAL(*request.jsonrpc, "2.0");
+        BOOST_REQUIRE(request.method.valid());
+        BOOST_CHECK_EQUAL(*request.method, "a\"b\\c/d");
+        BOOST_REQUIRE(request.id.valid());
+        BOOST_CHECK_EQUAL(request.id->str(), "\"x\\\"}]\"");
+        BOOST_REQUIRE(request.params.valid());
+
+        auto params = request_parser::parse_array(*request.params);
+        BOOST_REQUIRE_EQUAL(params.size(), 2);
+        BOOST_CHECK_EQUAL(params[0].as_string(), "]\"[");
+        BOOST_CHECK_EQUAL(params[1]["}"].as_string(), "\\");
+    }
+
+    BOOST_AUTO_TEST_CASE(nesting) {
+        auto request = parse("{\"params\":[[[[{\"a\":[{\"b\":[]}]}]]], {}, [], \"[\"],\"method\":\"m\"}");
+        BOOST_REQUIRE(request.method.valid());
+        BOOST_CHECK_EQUAL(*request.method, "m");
+
+        auto elements = split_array(request.params->str());
+        BOOST_REQUIRE_EQUAL(elements.size(), 4);
+        BOOST_CHECK_EQUAL(elements[0], "[[[{\"a\":[{\"b\":[]}]}]]]");
+        BOOST_CHECK_EQUAL(elements[1], "{}");
+        BOOST_CHECK_EQUAL(elements[2], "[]");
+        BOOST_CHECK_EQUAL(elements[3], "\"[\"");
+
+        const std::string deep = std::string(10000, '[') + std::string(10000, ']');
+        BOOST_CHECK_EQUAL(parse("{\"params\":" + deep + "}").params->str(), deep);
+    }
+
+    BOOST_AUTO_TEST_CASE(split_arrays) {
+        BOOST_CHECK(split_array("[]").empty());
+        BOOST_CHECK(split_array(" [ ] ").empty());
+
+        auto elements = split_array(" [ \"api\" , \"method\",[1, \"2\"], -1.5e3, true, null ] ");
+        BOOST_REQUIRE_EQUAL(elements.size(), 6);
+        BOOST_CHECK_EQUAL(elements[0], "\"api\"");
+        BOOST_CHECK_EQUAL(elements[1], "\"method\"");
+        BOOST_CHECK_EQUAL(elements[2], "[1, \"2\"]");
+        BOOST_CHECK_EQUAL(elements[3], "-1.5e3");
+        BOOST_CHECK_EQUAL(elements[4], "true");
+        BOOST_CHECK_EQUAL(elements[5], "null");
+
+        // the rest of the array isn't scanned after the limit
+        const std::string params = "[\"api\", \"method\", [malformed";
+        auto names = request_parser::split_array(make_span(params), 2);
+        BOOST_REQUIRE_EQUAL(names.size(), 2);
+        BOOST_CHECK_EQUAL(names[1].str(), "\"method\"");
+        BOOST_CHECK_EQUAL(request_parser::split_array(make_span("[1]"), 2).size(), 1);
+
+        const std::string batch = "[{\"id\":1},{\"id\":2}]";
+        auto requests = request_parser::split_batch(batch);
+        BOOST_REQUIRE_EQUAL(requests.size(), 2);
+        BOOST_CHECK_EQUAL(requests[1].str(), "{\"id\":2}");
+
+        BOOST_CHECK(request_parser::is_batch(" [1]"));
+        BOOST_CHECK(!request_parser::is_batch(" {}"));
+        BOOST_CHECK(!request_parser::is_batch(""));
+    }
+
+    BOOST_AUTO_TEST_CASE(strings) {
+        BOOST_CHECK_EQUAL(request_parser::parse_string(make_span("\"plain\"")), "plain");
+        BOOST_CHECK_EQUAL(request_parser::parse_string(make_span("\"tab\\tquote\\\"\"")), "tab\tquote\"");
+        BOOST_CHECK_EQUAL(request_parser::parse_string(make_span("\"\"")), "");
+        // scalars are converted as fc::variant::as_string() does
+        BOOST_CHECK_EQUAL(request_parser::parse_string(make_span("12")), "12");
+    }
+
+    BOOST_AUTO_TEST_CASE(malformed) {
+        BOOST_CHECK_THROW(parse(""), fc::parse_error_exception);
+        BOOST_CHECK_THROW(parse("[]"), fc::parse_error_exception);
+        BOOST_CHECK_THROW(parse("\"request\""), fc::parse_error_exception);
+        BOOST_CHECK_THROW(parse("{method:\"call\"}"), fc::parse_error_exception);
+        BOOST_CHECK_THROW(parse("{\"method\" \"call\"}"), fc::parse_error_exception);
+        BOOST_CHECK_THROW(parse("{\"method\":}"), fc::parse_error_exception);
+        BOOST_CHECK_THROW(parse("{\"method\":\"call\" \"id\":1}"), fc::parse_error_exception);
+        BOOST_CHECK_THROW(parse("{\"method\":\"call\",}"), fc::parse_error_exception);
+        BOOST_CHECK_THROW(parse("{\"method\":\"call\"} {}"), fc::parse_error_exception);
+
+        BOOST_CHECK_THROW(split_array("[1 2]"), fc::parse_error_exception);
+        BOOST_CHECK_THROW(split_array("[1,]"), fc::parse_error_exception);
+        BOOST_CHECK_THROW(split_array("[1] 2"), fc::parse_error_exception);
+        BOOST_CHECK_THROW(split_array("{}"), fc::assert_exception);
+
+        // the scanner doesn't validate nested values, they are validated on parsing
+        auto request = parse("{\"params\":[{]]}");
+        BOOST_CHECK_THROW(request_parser::parse_array(*request.params), fc::parse_error_exception);
+        BOOST_CHECK_THROW(request_parser::parse_array(make_span("{}")), fc::parse_error_exception);
+    }
+
+    BOOST_AUTO_TEST_CASE(truncated) {
+        const std::string body =
+            "{\"jsonrpc\":\"2.0\",\"id\":\"a\\\"b\",\"method\":\"call\",\"params\":[\"api\",\"method\",[{\"a\":[1]}]]}";
+
+        BOOST_CHECK_NO_THROW(parse(body));
+        // the request can't be valid when it is cut at any position
+        for (std::size_t size = 0; size < body.size(); ++size) {
+            BOOST_CHECK_THROW(parse(body.substr(0, size)), fc::parse_error_exception);
+        }
+
+        const std::string batch = "[" + body + "," + body + "]";
+        BOOST_CHECK_EQUAL(request_parser::split_batch(batch).size(), 2);
+        for (std::size_t size = 1; size < batch.size(); ++size) {
+            BOOST_CHECK_THROW(request_parser::split_batch(batch.substr(0, size)), fc::parse_error_exception);
+        }
+
+        BOOST_CHECK_THROW(parse("{\"method\":\"call\\"), fc::parse_error_exception);
+        BOOST_CHECK_THROW(parse("{\"method\":\"call\\\""), fc::parse_error_exception);
+    }
+
+BOOST_AUTO_TEST_SUITE_END()
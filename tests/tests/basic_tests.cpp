@@ -26,6 +26,8 @@
 #include <boost/test/unit_test_monitor.hpp>
 
 #include <golos/chain/database.hpp>
+#include <golos/chain/comment_object.hpp>
+#include <golos/chain/index_statistics.hpp>
 
 #include <fc/crypto/digest.hpp>
 #include "database_fixture.hpp"
@@ -313,4 +315,49 @@ BOOST_FIXTURE_TEST_SUITE(basic_tests, clean_database_fixture)
         BOOST_CHECK(block.calculate_merkle_root() == c(dO));
     }
 
+    BOOST_AUTO_TEST_CASE(index_statistics_payload) {
+        try {
+            ACTORS((alice)(bob)(carol));
+            generate_block();
+
+            auto post = [&](const std::string &author, const fc::ecc::private_key &key, const std::string &body) {
+                comment_operation op;
+                op.author = author;
+                op.permlink = "lorem";
+                op.parent_permlink = "ipsum";
+                op.title = "Lorem Ipsum";
+                op.body = body;
+                op.json_metadata = "{\"foo\":\"bar\"}";
+
+                signed_transaction tx;
+                tx.operations.push_back(op);
+                tx.set_expiration(db->head_block_time() + STEEMIT_MAX_TIME_UNTIL_EXPIRATION);
+                tx.sign(key, db->get_chain_id());
+                db->push_transaction(tx, 0);
+            };
+
+            post("alice", alice_private_key, "Lorem ipsum dolor sit amet");
+            post("bob", bob_private_key, std::string(1000, 'b'));
+            post("carol", carol_private_key, std::string(5000, 'c'));
+            generate_block();
+
+            auto stats = get_index_statistics<comment_content_index>(*db);
+            const auto &indices = db->get_index<comment_content_index>().indices();
+
+            BOOST_CHECK_EQUAL(stats.object_count, indices.size());
+            BOOST_CHECK(stats.node_size > 0);
+            BOOST_CHECK(stats.dynamic_size > 0);
+            BOOST_CHECK_EQUAL(stats.total_size, stats.node_size + stats.dynamic_size);
+
+            // the sample covers the whole small index, so the payload is exact
+            uint64_t payload = 0;
+            for (const auto &content : indices) {
+                payload += dynamic_memory_usage(content);
+            }
+            BOOST_CHECK_EQUAL(stats.dynamic_size, payload);
+            BOOST_CHECK(stats.dynamic_size >= 6000);
+        }
+        FC_LOG_AND_RETHROW()
+    }
+
 BOOST_AUTO_TEST_SUITE_END()
@@ -29,6 +29,7 @@
 
 #include <golos/chain/database.hpp>
 #include <golos/chain/steem_objects.hpp>
+#include <golos/chain/operation_notification.hpp>
 
 #include <golos/plugins/account_history/history_object.hpp>
 #include <golos/plugins/account_history/plugin.hpp>
@@ -104,6 +105,47 @@ BOOST_AUTO_TEST_SUITE(block_tests)
         }
     }
 
+    BOOST_AUTO_TEST_CASE(stale_state_layout) {
+        try {
+            fc::temp_directory data_dir(golos::utilities::temp_directory_path());
+            auto init_account_priv_key = STEEMIT_INIT_PRIVATE_KEY;
+            {
+                database db;
+                db._log_hardforks = false;
+                db.open(data_dir.path(), data_dir.path(), INITIAL_TEST_SUPPLY, TEST_SHARED_MEM_SIZE, chainbase::database::read_write);
+                db.generate_block(db.get_slot_time(1), db.get_scheduled_witness(1), init_account_priv_key, database::skip_nothing);
+                db.close();
+            }
+            {
+                BOOST_TEST_MESSAGE("The file of the same build is opened");
+
+                database db;
+                db._log_hardforks = false;
+                db.open(data_dir.path(), data_dir.path(), INITIAL_TEST_SUPPLY, TEST_SHARED_MEM_SIZE, chainbase::database::read_write);
+
+                auto version = db.get_segment_manager()->find<uint32_t>("golos_state_layout_version").first;
+                BOOST_REQUIRE(version != nullptr);
+                BOOST_CHECK_EQUAL(*version, state_layout_version);
+
+                // as if the file was written by a build with another layout of objects
+                *version = state_layout_version + 1;
+                db.close();
+            }
+            {
+                BOOST_TEST_MESSAGE("The file of another layout is rejected");
+
+                database db;
+                db._log_hardforks = false;
+                STEEMIT_REQUIRE_THROW(
+                    db.open(data_dir.path(), data_dir.path(), INITIAL_TEST_SUPPLY, TEST_SHARED_MEM_SIZE, chainbase::database::read_write),
+                    fc::exception);
+            }
+        } catch (fc::exception &e) {
+            edump((e.to_detail_string()));
+            throw;
+        }
+    }
+
     BOOST_AUTO_TEST_CASE(undo_block) {
         try {
             fc::temp_directory data_dir(golos::utilities::temp_directory_path());
@@ -537,6 +579,112 @@ BOOST_AUTO_TEST_SUITE(block_tests)
         }
     }
 
+    BOOST_FIXTURE_TEST_CASE(generate_block_from_pending, clean_database_fixture) {
+        try {
+            ACTORS((alice)(bob));
+            generate_block();
+
+            BOOST_TEST_MESSAGE("Dependent pending transactions are included in order of arrival");
+
+            signed_transaction tx1;
+            transfer_operation op;
+            op.from = STEEMIT_INIT_MINER_NAME;
+            op.to = "alice";
+            op.amount = asset(1000, STEEM_SYMBOL);
+            tx1.operations.push_back(op);
+            tx1.set_expiration(db->head_block_time() + STEEMIT_MAX_TIME_UNTIL_EXPIRATION);
+            tx1.sign(init_account_priv_key, db->get_chain_id());
+            PUSH_TX(*db, tx1);
+
+            signed_transaction tx2;
+            op.from = "alice";
+            op.to = "bob";
+            op.amount = asset(500, STEEM_SYMBOL);
+            tx2.operations.push_back(op);
+            tx2.set_expiration(db->head_block_time() + STEEMIT_MAX_TIME_UNTIL_EXPIRATION);
+            tx2.sign(alice_private_key, db->get_chain_id());
+            PUSH_TX(*db, tx2);
+
+            generate_block();
+
+            auto block = db->fetch_block_by_number(db->head_block_num());
+            BOOST_REQUIRE(block.valid());
+            BOOST_REQUIRE(block->transactions.size() == 2);
+            BOOST_REQUIRE(block->transactions[0].id() == tx1.id());
+            BOOST_REQUIRE(block->transactions[1].id() == tx2.id());
+            BOOST_REQUIRE(db->get_account("bob").balance == asset(500, STEEM_SYMBOL));
+
+            BOOST_TEST_MESSAGE("Transaction expiring before the block time isn't included");
+
+            signed_transaction tx3;
+            op.amount = asset(100, STEEM_SYMBOL);
+            tx3.operations.push_back(op);
+            tx3.set_expiration(db->head_block_time() + 1);
+            tx3.sign(alice_private_key, db->get_chain_id());
+            PUSH_TX(*db, tx3);
+
+            generate_block();
+
+            block = db->fetch_block_by_number(db->head_block_num());
+            BOOST_REQUIRE(block.valid());
+            BOOST_REQUIRE(block->transactions.empty());
+            BOOST_REQUIRE(db->get_account("bob").balance == asset(500, STEEM_SYMBOL));
+        }
+        FC_LOG_AND_RETHROW()
+    }
+
+    BOOST_FIXTURE_TEST_CASE(incremental_invariants, clean_database_fixture) {
+        try {
+            ACTORS((alice)(bob));
+            generate_block();
+
+            db->set_validate_invariants(true);
+
+            BOOST_TEST_MESSAGE("Blocks with transfers keep invariants");
+
+            transfer(STEEMIT_INIT_MINER_NAME, "alice", 10000);
+            generate_block();
+            vest("alice", 1000);
+            generate_block();
+            generate_blocks(10);
+
+            BOOST_TEST_MESSAGE("Balance changed without change of the supply is detected");
+
+            bool corrupt = true;
+            auto connection = db->post_apply_operation.connect([&](const operation_notification &) {
+                if (corrupt) {
+                    corrupt = false;
+                    db->modify(db->get_account("bob"), [&](account_object &a) {
+                        a.balance += asset(1, STEEM_SYMBOL);
+                    });
+                }
+            });
+
+            signed_transaction tx;
+            transfer_operation op;
+            op.from = "alice";
+            op.to = "bob";
+            op.amount = asset(100, STEEM_SYMBOL);
+            tx.operations.push_back(op);
+            tx.set_expiration(db->head_block_time() + STEEMIT_MAX_TIME_UNTIL_EXPIRATION);
+            tx.sign(alice_private_key, db->get_chain_id());
+            PUSH_TX(*db, tx);
+
+            corrupt = true;
+            STEEMIT_REQUIRE_THROW(generate_block(), fc::exception);
+
+            connection.disconnect();
+
+            BOOST_TEST_MESSAGE("Tracking is reset after the failed block, so the next block is checked from scratch");
+
+            generate_block();
+            vest("alice", 100);
+            generate_block();
+            db->set_validate_invariants(false);
+        }
+        FC_LOG_AND_RETHROW()
+    }
+
     BOOST_FIXTURE_TEST_CASE(rsf_missed_blocks, clean_database_fixture) {
         try {
             generate_block();
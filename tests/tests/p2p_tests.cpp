@@ -0,0 +1,128 @@
+#include <boost/test/unit_test.hpp>
+
+#include <golos/network/partial_compact_blocks.hpp>
+#include <golos/protocol/steem_operations.hpp>
+
+#include <map>
+
+using namespace golos::network;
+using golos::protocol::transfer_operation;
+using golos::protocol::asset;
+
+namespace {
+
+    signed_block make_block(uint32_t transactions) {
+        signed_block block;
+        block.timestamp = fc::time_point_sec(1500000000);
+        block.witness = "witness";
+        for (uint32_t i = 0; i < transactions; ++i) {
+            transfer_operation op;
+            op.from = "alice";
+            op.to = "bob";
+            op.amount = asset(i + 1, STEEM_SYMBOL);
+            op.memo = "memo " + std::to_string(i);
+
+            signed_transaction trx;
+            trx.ref_block_num = i;
+            trx.operations.push_back(op);
+            block.transactions.push_back(trx);
+        }
+        block.transaction_merkle_root = block.calculate_merkle_root();
+        return block;
+    }
+
+    compact_block_message make_compact_block(const signed_block &block) {
+        block_message full(block);
+        return compact_block_message(full, message(full).id());
+    }
+
+    // Message cache with the given transactions of the block
+    find_transaction_type make_cache(const signed_block &block, const std::vector<uint32_t> &known) {
+        std::map<message_hash_type, signed_transaction> cache;
+        for (auto i: known) {
+            const auto &trx = block.transactions[i];
+            cache[message(trx_message(trx)).id()] = trx;
+        }
+        return [cache](const message_hash_type &hash) -> fc::optional<signed_transaction> {
+            auto itr = cache.find(hash);
+            if (itr == cache.end()) {
+                return fc::optional<signed_transaction>();
+            }
+            return itr->second;
+        };
+    }
+
+    partial_compact_block make_partial_block(uint32_t transactions) {
+        auto block = make_block(transactions);
+        return rebuild_compact_block(make_compact_block(block), make_cache(block, {}));
+    }
+
+} // anonymous namespace
+
+BOOST_AUTO_TEST_SUITE(p2p_tests)
+
+    BOOST_AUTO_TEST_CASE(rebuild_compact_block_from_cache) {
+        auto block = make_block(3);
+        auto compact_block = make_compact_block(block);
+
+        auto partial_block = rebuild_compact_block(compact_block, make_cache(block, {0, 1, 2}));
+        BOOST_CHECK(partial_block.missing_transactions.empty());
+        BOOST_CHECK(partial_block.block.id() == block.id());
+        // the node checks the rebuilt block by the hash of the requested message
+        BOOST_CHECK(message(block_message(partial_block.block)).id() == compact_block.block_message_hash);
+        BOOST_CHECK(partial_block.message_hash == compact_block.block_message_hash);
+    }
+
+    BOOST_AUTO_TEST_CASE(complete_missing_transactions) {
+        auto block = make_block(3);
+        auto compact_block = make_compact_block(block);
+
+        auto partial_block = rebuild_compact_block(compact_block, make_cache(block, {1}));
+        BOOST_CHECK(partial_block.missing_transactions == std::vector<uint32_t>({0, 2}));
+
+        // the wrong number of transactions isn't accepted
+        BOOST_CHECK(!partial_block.complete({block.transactions[0]}));
+        BOOST_CHECK_EQUAL(partial_block.missing_transactions.size(), 2);
+
+        BOOST_CHECK(partial_block.complete({block.transactions[0], block.transactions[2]}));
+        BOOST_CHECK(partial_block.missing_transactions.empty());
+        BOOST_CHECK(message(block_message(partial_block.block)).id() == compact_block.block_message_hash);
+
+        // wrong transactions change the hash of the block message
+        auto wrong_block = rebuild_compact_block(compact_block, make_cache(block, {1}));
+        BOOST_CHECK(wrong_block.complete({block.transactions[2], block.transactions[0]}));
+        BOOST_CHECK(message(block_message(wrong_block.block)).id() != compact_block.block_message_hash);
+    }
+
+    BOOST_AUTO_TEST_CASE(partial_blocks_are_limited) {
+        partial_compact_blocks blocks(2);
+        BOOST_CHECK(blocks.empty());
+
+        auto first = make_partial_block(1);
+        auto second = make_partial_block(2);
+        auto third = make_partial_block(3);
+
+        BOOST_CHECK(blocks.insert(first.block.id(), first));
+        // the same block isn't replaced
+        BOOST_CHECK(!blocks.insert(first.block.id(), second));
+        BOOST_CHECK(blocks.insert(second.block.id(), second));
+        BOOST_CHECK_EQUAL(blocks.size(), 2);
+
+        // the limit is reached
+        BOOST_CHECK(!blocks.insert(third.block.id(), third));
+        BOOST_CHECK(!blocks.contains(third.block.id()));
+
+        auto taken = blocks.take(first.block.id());
+        BOOST_REQUIRE(taken.valid());
+        BOOST_CHECK_EQUAL(taken->block.transactions.size(), 1);
+        BOOST_CHECK(!blocks.contains(first.block.id()));
+        BOOST_CHECK(!blocks.take(first.block.id()).valid());
+
+        BOOST_CHECK(blocks.insert(third.block.id(), third));
+        BOOST_CHECK(blocks.contains(third.block.id()));
+
+        blocks.clear();
+        BOOST_CHECK(blocks.empty());
+    }
+
+BOOST_AUTO_TEST_SUITE_END()